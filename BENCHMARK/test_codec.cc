@@ -0,0 +1,103 @@
+#include "codec.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template <typename F>
+void measure_elapsed(const char* label, F&& callback)
+{
+  const auto start    = std::chrono::steady_clock::now();
+
+  callback();
+
+  const auto end      = std::chrono::steady_clock::now();
+  const auto duration =
+    std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+  std::cout << label << ": " << duration.count() << " ms\n";
+}
+
+static volatile std::uint64_t g_sink = 0;
+
+// Samples from a synthetic steady-state profile: a deep common prefix with
+// a few hot leaves below it, so most samples only swap the innermost frames.
+static std::vector<std::vector<std::uint32_t>> make_samples(const std::size_t n)
+{
+  std::mt19937_64 rng(7UL);
+  std::uniform_int_distribution<std::uint32_t> leaf(0U, 63U);
+  std::uniform_int_distribution<std::size_t>   tail(1UL, 4UL);
+
+  std::vector<std::uint32_t> trunk;
+
+  for (std::uint32_t i = 0U; i < 40U; i++)
+  {
+    trunk.push_back(1000U + i);
+  }
+
+  std::vector<std::vector<std::uint32_t>> samples;
+  samples.reserve(n);
+
+  for (std::size_t i = 0UL; i < n; i++)
+  {
+    std::vector<std::uint32_t> stack = trunk;
+    const std::size_t extra = tail(rng);
+
+    for (std::size_t d = 0UL; d < extra; d++)
+    {
+      stack.push_back(leaf(rng) + static_cast<std::uint32_t>(d) * 64U);
+    }
+
+    samples.push_back(std::move(stack));
+  }
+
+  return samples;
+}
+
+int main(void)
+{
+  const auto samples = make_samples(1000000UL);
+
+  std::uint64_t raw_bytes = 0UL;
+
+  for (const auto& s : samples)
+  {
+    raw_bytes += s.size() * sizeof(std::uint32_t);
+  }
+
+  std::vector<std::uint8_t> buffer(samples.size() * codec::StackEncoder::max_bytes(64UL));
+
+  codec::StackEncoder encoder;
+  std::uint8_t* out = buffer.data();
+
+  measure_elapsed("encode 1M samples", [&]
+  {
+    for (std::size_t i = 0UL; i < samples.size(); i++)
+    {
+      out = encoder.encode(out, i * 1000000UL, 1UL, samples[i].data(), samples[i].size());
+    }
+  });
+
+  measure_elapsed("decode 1M samples", [&]
+  {
+    codec::StackDecoder decoder;
+    const std::uint8_t* p = buffer.data();
+    std::uint64_t timestamp = 0UL;
+    std::uint64_t count     = 0UL;
+
+    while (p != nullptr && p < out)
+    {
+      p = decoder.decode(p, out, timestamp, count);
+      g_sink = g_sink + decoder.stack().size();
+    }
+  });
+
+  const std::uint64_t encoded = static_cast<std::uint64_t>(out - buffer.data());
+
+  std::cout << "raw stacks: " << raw_bytes << " bytes, encoded: " << encoded << " bytes ("
+            << (static_cast<double>(raw_bytes) / static_cast<double>(encoded)) << "x)\n";
+
+  return 0;
+}
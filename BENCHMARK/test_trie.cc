@@ -1,6 +1,8 @@
+#include "concurrent_trie.hpp"
 #include "trie.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
@@ -119,12 +121,13 @@ static void stress_insert(HATTrie<>& trie, const std::vector<std::string>& keys)
 static void stress_contains(HATTrie<>& trie,
                             const std::vector<std::string>& keys,
                             std::size_t queries,
-                            std::uint64_t seed = 0xBADC0DEULL)
+                            std::uint64_t seed = 0xBADC0DEULL,
+                            const char* label = "contains mixed")
 {
   std::mt19937_64 rng(seed);
   std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
 
-  measure_elapsed("contains mixed", [&]
+  measure_elapsed(label, [&]
   {
     std::uint64_t hits = 0;
 
@@ -141,7 +144,7 @@ static void stress_contains(HATTrie<>& trie,
       }
     }
 
-    g_sink ^= hits;
+    g_sink = g_sink ^ hits;
   });
 }
 
@@ -165,7 +168,7 @@ static void stress_prefix(HATTrie<>& trie,
       hits += trie.has_prefix(std::string_view(base.data(), n)) ? 1u : 0u;
     }
 
-    g_sink ^= (hits << 1);
+    g_sink = g_sink ^ (hits << 1);
   });
 }
 
@@ -196,7 +199,56 @@ static void stress_reads_multithread(HATTrie<>& trie,
           local_hits += trie.contains(keys[pick(rng)]) ? 1u : 0u;
         }
 
-        g_sink ^= (local_hits + t);
+        g_sink = g_sink ^ (local_hits + t);
+      });
+    }
+
+    for (auto& th : threads) th.join();
+  });
+}
+
+static void stress_mixed_multithread(ConcurrentHATTrie<>& trie,
+                                     const std::vector<std::string>& keys,
+                                     const std::vector<std::string>& updates,
+                                     std::size_t total_queries,
+                                     unsigned num_threads)
+{
+  if (num_threads < 2) num_threads = 2;
+
+  measure_elapsed("contains + insert (mt, 1 writer)", [&]
+  {
+    std::atomic<bool> writing{true};
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+
+    const std::size_t per_thread = total_queries / (num_threads - 1);
+
+    threads.emplace_back([&]
+    {
+      for (const auto& k : updates)
+      {
+        trie.insert(k);
+      }
+
+      writing.store(false, std::memory_order_release);
+    });
+
+    for (unsigned t = 1; t < num_threads; t++)
+    {
+      threads.emplace_back([&, t]
+      {
+        std::mt19937_64 rng(0xDEF000ULL + t);
+        std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
+
+        // Readers keep going until the writer is done, so every insert
+        // runs against concurrent lookups.
+        std::uint64_t local_hits = 0;
+        for (std::size_t i = 0; i < per_thread || writing.load(std::memory_order_acquire); i++)
+        {
+          local_hits += trie.contains(keys[pick(rng)]) ? 1u : 0u;
+        }
+
+        g_sink = g_sink ^ (local_hits + t);
       });
     }
 
@@ -217,11 +269,39 @@ int main(void)
 
   stress_insert(trie, keys);
 
+  auto sorted = keys;
+  std::sort(sorted.begin(), sorted.end());
+
+  HATTrie<> bulk;
+
+  measure_elapsed("build bulk (sorted)", [&]
+  {
+    bulk.build(sorted);
+  });
+
+  stress_contains(bulk, keys, num_queries, 0xBADC0DEULL, "contains mixed (bulk)");
+
   stress_contains(trie, keys, num_queries);
   stress_prefix(trie, keys, num_queries);
 
   stress_reads_multithread(trie, keys, num_queries, std::thread::hardware_concurrency());
 
+  std::cout << "Concurrent (RCU) trie...\n";
+
+  ConcurrentHATTrie<> ctrie;
+
+  measure_elapsed("insert bulk (concurrent)", [&]
+  {
+    for (const auto& k : keys)
+    {
+      ctrie.insert(k);
+    }
+  });
+
+  const auto updates = generate_keys(num_keys / 10, prefix_heavy, 0xFEEDULL);
+
+  stress_mixed_multithread(ctrie, keys, updates, num_queries, std::thread::hardware_concurrency());
+
   std::cout << "sink=" << g_sink << "\n";
   return 0;
 }
@@ -2,25 +2,118 @@
 
 g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
   -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/main src/main.cc^
-  src/clock.cc src/context.cc src/event.cc src/frame.cc src/map.cc src/profiler.cc src/scan.cc src/trie.cc -ldbghelp -limagehlp
+  src/chrome_trace.cc src/clock.cc src/context.cc src/deflate.cc src/event.cc src/file_sink.cc src/flamegraph.cc src/folded.cc src/frame.cc src/governor.cc src/interner.cc src/line_histogram.cc src/map.cc src/pacer.cc src/pprof.cc src/profiler.cc src/sample_log.cc src/sample_profile.cc src/scan.cc src/segment.cc src/stack_table.cc src/trie.cc src/writer.cc -ldbghelp -limagehlp -lwinmm
+
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -O2 -march=native -Wall -Wextra -Werror^
+  -o bin/analyze src/analyze.cc src/analysis.cc src/deflate.cc src/file_sink.cc src/flamegraph.cc src/interner.cc src/map.cc^
+  src/pprof.cc src/sample_log.cc src/segment.cc src/stack_table.cc src/writer.cc
 
 
 g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra^
   -Werror -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_map^
   src/map.cc test/test_map.cc
 
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_analysis^
+  src/analysis.cc src/interner.cc src/map.cc src/sample_log.cc src/segment.cc src/stack_table.cc src/writer.cc test/test_analysis.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_bqueue^
+  test/test_bqueue.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_chrome_trace^
+  src/chrome_trace.cc src/writer.cc test/test_chrome_trace.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_chunked_log^
+  test/test_chunked_log.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_clock^
+  src/clock.cc test/test_clock.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_codec^
+  test/test_codec.cc
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_flamegraph^
+  src/file_sink.cc src/flamegraph.cc src/map.cc src/stack_table.cc src/writer.cc test/test_flamegraph.cc
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_folded^
+  src/file_sink.cc src/folded.cc src/map.cc src/stack_table.cc src/writer.cc test/test_folded.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_deflate^
+  src/deflate.cc test/test_deflate.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_governor^
+  src/governor.cc test/test_governor.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_histogram^
+  test/test_histogram.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_interner^
+  src/interner.cc test/test_interner.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_line_histogram^
+  src/line_histogram.cc src/writer.cc test/test_line_histogram.cc
+
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_pacer^
+  src/pacer.cc test/test_pacer.cc -lwinmm
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_pprof^
+  src/deflate.cc src/file_sink.cc src/map.cc src/pprof.cc src/stack_table.cc src/writer.cc test/test_pprof.cc
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_profiler^
+  src/chrome_trace.cc src/clock.cc src/event.cc src/file_sink.cc src/frame.cc src/interner.cc src/map.cc src/profiler.cc src/sample_profile.cc src/stack_table.cc src/writer.cc test/test_profiler.cc
+
 g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra^
   -Werror -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_queue^
   test/test_queue.cc
 
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_sample_log^
+  src/sample_log.cc src/segment.cc test/test_sample_log.cc
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_sample_profile^
+  src/file_sink.cc src/map.cc src/sample_profile.cc src/stack_table.cc src/writer.cc test/test_sample_profile.cc
+
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_scan^
+  src/clock.cc src/frame.cc src/line_histogram.cc src/map.cc src/scan.cc src/writer.cc test/test_scan.cc -ldbghelp -limagehlp
+
 g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
   -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_stack^
   test/test_stack.cc
 
+g++ -Iinclude -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_threads^
+  test/test_threads.cc
+
 g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
   -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_trie^
   src/map.cc src/trie.cc test/test_trie.cc
 
+g++ -Iinclude -Ilib/xxHash -std=c++20 -ggdb3 -O0 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/test_concurrent_trie^
+  src/map.cc test/test_concurrent_trie.cc
+
+
+g++ -Iinclude -std=c++20 -s -O3 -march=native -Wall -Wextra -Werror^
+  -fno-omit-frame-pointer -fno-optimize-sibling-calls -o bin/BENCHMARK/test_codec^
+  BENCHMARK/test_codec.cc
 
 g++ -Iinclude -Ilib/xxHash -std=c++20 -s -O3 -march=native -Wall -Wextra^
   -Werror -fno-omit-frame-pointer -fno-optimize-sibling-calls^
@@ -0,0 +1,179 @@
+/*
+ * Responsibility - Offline aggregation of recorded profiles into flat, hot-path and caller/callee views.
+ */
+#pragma once
+
+#include "interner.hpp"
+#include "stack_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct FunctionCost final
+{
+  std::uint32_t id{0U};
+  std::uint64_t self{0UL};   // samples with the function as the leaf
+  std::uint64_t total{0UL};  // samples with the function anywhere on the stack
+};
+
+struct HotPath final
+{
+  std::vector<std::uint32_t> stack;  // outermost first
+  std::uint64_t              count{0UL};
+};
+
+struct CallEdge final
+{
+  std::uint32_t caller{0U};
+  std::uint32_t callee{0U};
+  std::uint64_t count{0UL};  // samples whose stack contains the call
+};
+
+/**
+ * @brief Change of one function between two profiles.
+ *
+ * Shares are fractions of each profile's samples, which normalizes runs of
+ * different length or rate; seconds scale a share by its run's duration. z
+ * is the two-proportion z statistic of the share change: |z| above ~2 is
+ * unlikely to be sampling noise, and the sign says which way it moved.
+ */
+struct FunctionDelta final
+{
+  std::uint32_t id{0U};  // ProfileDiff name id
+  double        base_self{0.0};
+  double        base_total{0.0};
+  double        cand_self{0.0};
+  double        cand_total{0.0};
+  double        self_seconds{0.0};   // candidate minus baseline
+  double        total_seconds{0.0};
+  double        self_z{0.0};
+  double        total_z{0.0};
+};
+
+struct PathDelta final
+{
+  std::vector<std::uint32_t> stack;  // ProfileDiff name ids, outermost first
+  std::uint64_t              base{0UL};
+  std::uint64_t              cand{0UL};
+  double                     delta{0.0};  // share change
+  double                     z{0.0};
+};
+
+/**
+ * @brief A sample log reduced to its distinct stacks, plus the views built on them.
+ *
+ * load() splits the log's segments round-robin across worker threads; each
+ * decodes its share into a private StackTable and the tables are merged at
+ * the end, so the only shared state is touched once per distinct stack
+ * rather than once per sample. A sample the log marks as identical to the
+ * one before it is counted without a lookup. The views are computed from the merged table
+ * on demand. A function that appears several times on one stack (recursion)
+ * is counted once per sample in total and in every call edge.
+ */
+class Profile final
+{
+  StackTable               m_stacks;
+  std::vector<std::string> m_names;
+  std::uint64_t            m_first_ns{0UL};
+  std::uint64_t            m_last_ns{0UL};
+  std::uint32_t            m_segments{0U};
+  bool                     m_corrupt{false};
+
+public:
+  static constexpr int kOk      =   0 ;
+  static constexpr int kMissing = (-1);
+  static constexpr int kCorrupt = (-2);
+  static constexpr int kIoError = (-3);
+
+  static constexpr std::uint32_t kNotFound = 0xFFFFFFFFU;
+
+  Profile() noexcept = default;
+
+  /**
+   * @param path    Sample log base path (as given to SampleLogWriter).
+   * @param threads Worker threads; 0 picks one per hardware thread.
+   *
+   * @return kOk, kMissing if the log has no readable segment, or kCorrupt if
+   *         decoding stopped early (whatever was read before is kept).
+   */
+  [[nodiscard]] int load(const std::string& path, unsigned threads = 0U) noexcept;
+
+  // Per-function costs, most self samples first.
+  std::vector<FunctionCost> flat(void) const noexcept;
+
+  // The n stacks with the most samples, most first.
+  std::vector<HotPath> hot_paths(const std::size_t n) const noexcept;
+
+  // Writes one "a;b;c count" line per distinct stack (see FoldedWriter).
+  [[nodiscard]] int write_folded(const std::string& path) const noexcept;
+
+  // Calls into id / made by id, most samples first.
+  std::vector<CallEdge> callers(const std::uint32_t id) const noexcept;
+  std::vector<CallEdge> callees(const std::uint32_t id) const noexcept;
+
+  std::string_view name(const std::uint32_t id) const noexcept;
+
+  // Id of the function called name, or kNotFound.
+  std::uint32_t find(std::string_view name) const noexcept;
+
+  const StackTable&               get_stacks(void)      const noexcept;
+  const std::vector<std::string>& get_names(void)       const noexcept;
+  std::uint64_t                   get_samples(void)     const noexcept;
+  std::uint64_t                   get_duration_ns(void) const noexcept;
+  std::uint32_t                   get_segments(void)    const noexcept;
+  bool                            is_corrupt(void)      const noexcept;
+};
+
+/**
+ * @brief Baseline-versus-candidate comparison of two loaded profiles.
+ *
+ * Function ids are local to a recording, so both profiles' names are
+ * interned into one Interner and their stacks rewritten onto the shared ids;
+ * matching a function across runs is then a hash lookup, and matching a
+ * stack is a StackTable lookup, so the cost stays linear in the number of
+ * distinct stacks. Rankings put the largest share increase (the biggest
+ * regression) first.
+ */
+class ProfileDiff final
+{
+  Interner      m_names;
+  StackTable    m_base;
+  StackTable    m_cand;
+  double        m_base_seconds{0.0};
+  double        m_cand_seconds{0.0};
+
+  void m_import(const Profile& profile, StackTable& out) noexcept;
+
+public:
+  enum class Rank : std::uint8_t { SELF, TOTAL };
+
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  ProfileDiff(const Profile& baseline, const Profile& candidate) noexcept;
+
+  ProfileDiff(const ProfileDiff&)            = delete;
+  ProfileDiff& operator=(const ProfileDiff&) = delete;
+
+  // Every function seen in either profile, most increased first.
+  std::vector<FunctionDelta> functions(const Rank rank = Rank::SELF) const noexcept;
+
+  // The n stacks with the largest share increase, and the n with the largest decrease.
+  std::vector<PathDelta> regressions(const std::size_t n)  const noexcept;
+  std::vector<PathDelta> improvements(const std::size_t n) const noexcept;
+
+  /**
+   * @brief Writes "frame;frame;frame <baseline> <candidate>" per distinct
+   *        stack: the two-column folded format differential flame graph
+   *        tools read.
+   */
+  [[nodiscard]] int write_folded(const std::string& path) const noexcept;
+
+  std::string_view name(const std::uint32_t id) const noexcept;
+
+  std::uint64_t get_base_samples(void) const noexcept;
+  std::uint64_t get_cand_samples(void) const noexcept;
+};
@@ -0,0 +1,131 @@
+/*
+ * Responsibility - Bump-pointer allocation from fixed-size chunks under a chunk budget.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Region allocator for data that lives as long as a profiling run.
+ *
+ * Memory is requested from the system one chunk at a time and handed out by
+ * bumping an offset; nothing is freed individually, and pointers stay valid
+ * until reset() or destruction. Once max_chunks chunks exist every further
+ * allocation fails (nullptr) instead of growing, which bounds the footprint.
+ */
+class Arena final
+{
+  static constexpr std::size_t kAlignment = alignof(std::max_align_t);
+
+  struct Free final
+  {
+    void operator()(std::byte* p) const noexcept
+    {
+      ::operator delete[](p, std::align_val_t(kAlignment));
+    }
+  };
+
+  using Chunk = std::unique_ptr<std::byte[], Free>;
+
+  std::size_t        m_chunk_size;
+  std::size_t        m_max_chunks;
+  std::vector<Chunk> m_chunks;
+  std::size_t        m_offset;
+
+  [[nodiscard]] bool m_grow(void) noexcept
+  {
+    if (m_chunks.size() >= m_max_chunks)
+    {
+      return false;
+    }
+
+    std::byte* raw = static_cast<std::byte*>(::operator new[](m_chunk_size,
+                                                              std::align_val_t(kAlignment),
+                                                              std::nothrow));
+    if (raw == nullptr)
+    {
+      return false;
+    }
+
+    m_chunks.emplace_back(raw);
+    m_offset = 0UL;
+
+    return true;
+  }
+
+public:
+  static constexpr std::size_t kDefaultChunkSize = (64UL * 1024UL);
+
+  explicit Arena(const std::size_t chunk_size = kDefaultChunkSize,
+                 const std::size_t max_chunks = std::numeric_limits<std::size_t>::max()) noexcept
+    : m_chunk_size(chunk_size),
+      m_max_chunks(max_chunks),
+      m_chunks(),
+      m_offset(chunk_size)
+  {
+  }
+
+  Arena(const Arena&)            = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @return size bytes aligned to align, or nullptr if the request is larger
+   *         than a chunk or the chunk budget is spent.
+   */
+  [[nodiscard]] void* allocate(const std::size_t size,
+                               const std::size_t align = kAlignment) noexcept
+  {
+    if (size > m_chunk_size || align > kAlignment)
+    {
+      return nullptr;
+    }
+
+    std::size_t offset = (m_offset + (align - 1UL)) & ~(align - 1UL);
+
+    if (offset + size > m_chunk_size)
+    {
+      if (!m_grow())
+      {
+        return nullptr;
+      }
+
+      offset = 0UL;
+    }
+
+    m_offset = offset + size;
+
+    return m_chunks.back().get() + offset;
+  }
+
+  // Releases every chunk; all pointers handed out become invalid.
+  void reset(void) noexcept
+  {
+    m_chunks.clear();
+    m_offset = m_chunk_size;
+  }
+
+  void set_max_chunks(const std::size_t max_chunks) noexcept
+  {
+    m_max_chunks = max_chunks;
+  }
+
+  [[nodiscard]] std::size_t get_chunk_size(void) const noexcept
+  {
+    return m_chunk_size;
+  }
+
+  [[nodiscard]] std::size_t get_chunks(void) const noexcept
+  {
+    return m_chunks.size();
+  }
+
+  [[nodiscard]] std::size_t get_max_chunks(void) const noexcept
+  {
+    return m_max_chunks;
+  }
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "overflow.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Bounded multi-producer/multi-consumer queue linking pipeline stages.
+ *
+ * By default push() blocks while the queue is full (backpressure); another
+ * OverflowPolicy trades that for bounded waiting or counted loss. pop()
+ * blocks while the queue is empty. close() wakes every waiter; once closed,
+ * push() fails and pop() keeps returning queued elements until drained.
+ */
+template <typename T, std::size_t N>
+class BlockingQueue
+{
+  static std::size_t constexpr kMask = (N - 1UL);
+
+  static_assert((N & kMask) == 0UL, "BlockingQueue capacity must be a power of two");
+
+protected:
+  mutable std::mutex      m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+
+  std::size_t      m_size;
+
+  std::uint64_t    m_head;
+  std::uint64_t    m_tail;
+
+  bool             m_closed;
+
+  OverflowPolicy            m_policy;
+  std::chrono::milliseconds m_timeout;
+  std::uint64_t             m_dropped;
+
+  std::array<T, N> m_data;
+
+  // Called with the lock held and the queue full; true if there is room now.
+  [[nodiscard]] bool m_make_room(std::unique_lock<std::mutex>& lock) noexcept
+  {
+    switch (m_policy)
+    {
+      case OverflowPolicy::BLOCK:
+        if (m_timeout.count() == 0)
+        {
+          m_not_full.wait(lock, [this] { return (m_size < N) || m_closed; });
+          return true;
+        }
+
+        if (m_not_full.wait_for(lock, m_timeout, [this] { return (m_size < N) || m_closed; }))
+        {
+          return true;
+        }
+
+        ++m_dropped;
+        return false;
+
+      case OverflowPolicy::DROP_OLDEST:
+        ++m_head;
+        --m_size;
+        ++m_dropped;
+        return true;
+
+      case OverflowPolicy::DROP_NEWEST:
+        ++m_dropped;
+        return false;
+
+      case OverflowPolicy::REJECT:
+      default:
+        return false;
+    }
+  }
+
+public:
+  static constexpr int kFull   = (-1);
+  static constexpr int kEmpty  = (-2);
+  static constexpr int kClosed = (-3);
+  static constexpr int kOk     =   0 ;
+
+  /**
+   * @param policy  What push() does when the queue is full.
+   * @param timeout BLOCK only: how long push() waits before dropping the
+   *                element; zero waits indefinitely.
+   */
+  explicit BlockingQueue(const OverflowPolicy            policy  = OverflowPolicy::BLOCK,
+                         const std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) noexcept
+    : m_size(0UL),
+      m_head(0UL),
+      m_tail(0UL),
+      m_closed(false),
+      m_policy(policy),
+      m_timeout(timeout),
+      m_dropped(0UL),
+      m_data()
+  {
+  }
+
+  /**
+   * @return kOk if stored or dropped under the policy, kFull if full under
+   *         REJECT, kClosed once closed.
+   */
+  [[nodiscard]] int push(T element) noexcept
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_closed)
+    {
+      return kClosed;
+    }
+
+    if (m_size >= N && !m_make_room(lock))
+    {
+      return (m_policy == OverflowPolicy::REJECT) ? kFull : kOk;
+    }
+
+    if (m_closed)
+    {
+      return kClosed;
+    }
+
+    m_data[m_tail & kMask] = std::move(element);
+
+    ++m_tail;
+    ++m_size;
+
+    lock.unlock();
+    m_not_empty.notify_one();
+
+    return kOk;
+  }
+
+  [[nodiscard]] int try_push(T element) noexcept
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_closed)
+    {
+      return kClosed;
+    }
+
+    if (m_size >= N)
+    {
+      return kFull;
+    }
+
+    m_data[m_tail & kMask] = std::move(element);
+
+    ++m_tail;
+    ++m_size;
+
+    lock.unlock();
+    m_not_empty.notify_one();
+
+    return kOk;
+  }
+
+  [[nodiscard]] int pop(T& out) noexcept
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_not_empty.wait(lock, [this] { return (m_size > 0UL) || m_closed; });
+
+    if (m_size == 0UL)
+    {
+      return kClosed;
+    }
+
+    out = std::move(m_data[m_head & kMask]);
+
+    ++m_head;
+    --m_size;
+
+    lock.unlock();
+    m_not_full.notify_one();
+
+    return kOk;
+  }
+
+  [[nodiscard]] int try_pop(T& out) noexcept
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_size == 0UL)
+    {
+      return m_closed ? kClosed : kEmpty;
+    }
+
+    out = std::move(m_data[m_head & kMask]);
+
+    ++m_head;
+    --m_size;
+
+    lock.unlock();
+    m_not_full.notify_one();
+
+    return kOk;
+  }
+
+  void close(void) noexcept
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+
+    m_not_empty.notify_all();
+    m_not_full.notify_all();
+  }
+
+  [[nodiscard]] int size(std::size_t& out) const noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out = m_size;
+    return kOk;
+  }
+
+  [[nodiscard]] int dropped(std::uint64_t& out) const noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out = m_dropped;
+    return kOk;
+  }
+};
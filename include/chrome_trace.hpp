@@ -0,0 +1,74 @@
+/*
+ * Responsibility - Streaming Chrome Trace Event (JSON) export of the START/END timeline.
+ */
+#pragma once
+
+#include "writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Writes duration events ("ph":"B" / "ph":"E") as they happen.
+ *
+ * The output is the Trace Event Format's JSON array form, which the Chrome
+ * trace viewer and Perfetto load directly. Each event is formatted straight
+ * into the Writer's buffer: nothing is built up in memory, so a timeline of
+ * any length costs the buffer plus one pre-escaped name per id. The array
+ * form also tolerates a missing closing bracket, so the file of a run that
+ * died before close() still opens.
+ *
+ * Timestamps are nanoseconds since the session started; the format's unit
+ * is microseconds, written with three decimals so nothing is rounded.
+ * Single-threaded: call from the thread that produces the events.
+ */
+class ChromeTraceWriter final
+{
+  Writer                   m_out;
+  std::vector<std::string> m_names;   // "name":"..." fragments, escaped once
+  std::uint64_t            m_events{0UL};
+  bool                     m_closed{false};
+
+  void m_event(const char phase, const std::uint32_t tid, const std::uint32_t id, const std::uint64_t timestamp_ns) noexcept;
+
+  void m_separator(void) noexcept;
+
+public:
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  static constexpr std::uint32_t kPid = 1U;
+
+  explicit ChromeTraceWriter(const std::string& path, const std::size_t buffer_bytes = Writer::kDefaultBufferBytes) noexcept;
+
+  // Closes the trace if close() was not called; any error is lost.
+  ~ChromeTraceWriter() noexcept;
+
+  ChromeTraceWriter(const ChromeTraceWriter&)            = delete;
+  ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+  [[nodiscard]] bool is_open(void) const noexcept;
+
+  // Names id for later begin()/end() calls; an id never defined shows as "?".
+  void define(const std::uint32_t id, std::string_view name) noexcept;
+
+  // A "thread_name" metadata event, labelling tid's track in the viewer.
+  void thread_name(const std::uint32_t tid, std::string_view name) noexcept;
+
+  void begin(const std::uint32_t tid, const std::uint32_t id, const std::uint64_t timestamp_ns) noexcept;
+
+  void end(const std::uint32_t tid, const std::uint32_t id, const std::uint64_t timestamp_ns) noexcept;
+
+  /**
+   * @brief Terminates the array and closes the file; later events are ignored.
+   *
+   * @return kOk if everything was written, kIoError otherwise.
+   */
+  [[nodiscard]] int close(void) noexcept;
+
+  std::uint64_t get_events(void) const noexcept;
+  std::uint64_t get_bytes(void)  const noexcept;
+};
@@ -0,0 +1,286 @@
+/*
+ * Responsibility - Append-only FIFO log of trivially copyable records stored in arena chunks.
+ */
+#pragma once
+
+#include "arena.hpp"
+#include "overflow.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Unbounded-looking, budget-bounded replacement for a ring buffer.
+ *
+ * Records are appended into fixed-size chunks taken from an Arena: an append
+ * is a bump store and never allocates per record. pop() consumes in order;
+ * fully consumed chunks go to a free list and are reused before the arena is
+ * asked for more, so a log that is drained as it fills stays at a couple of
+ * chunks. When the chunk budget is spent the OverflowPolicy decides
+ * (DROP_OLDEST evicts the oldest whole chunk; BLOCK behaves as DROP_NEWEST).
+ *
+ * Single-threaded, like Queue.
+ */
+template <typename T>
+class ChunkedLog
+{
+  static_assert(std::is_trivially_copyable_v<T>, "ChunkedLog records must be trivially copyable");
+
+  struct Chunk final
+  {
+    Chunk*      next;
+    std::size_t size;
+  };
+
+  static constexpr std::size_t kHeader = ((sizeof(Chunk) + alignof(T) - 1UL) / alignof(T)) * alignof(T);
+
+protected:
+  Arena          m_arena;
+  std::size_t    m_per_chunk;
+
+  Chunk*         m_head;   // oldest chunk with unread records
+  Chunk*         m_tail;   // chunk being appended to
+  Chunk*         m_free;   // consumed chunks ready for reuse
+  std::size_t    m_read;   // next unread record in m_head
+
+  std::size_t    m_size;
+  std::uint64_t  m_dropped;
+  OverflowPolicy m_policy;
+
+  [[nodiscard]] static inline T* m_records(Chunk* chunk) noexcept
+  {
+    return std::launder(reinterpret_cast<T*>(reinterpret_cast<std::byte*>(chunk) + kHeader));
+  }
+
+  [[nodiscard]] Chunk* m_acquire(void) noexcept
+  {
+    Chunk* chunk = m_free;
+
+    if (chunk != nullptr)
+    {
+      m_free = chunk->next;
+    }
+    else
+    {
+      chunk = static_cast<Chunk*>(m_arena.allocate(m_arena.get_chunk_size()));
+    }
+
+    if (chunk == nullptr && m_policy == OverflowPolicy::DROP_OLDEST && m_head != m_tail)
+    {
+      // Evict the oldest chunk wholesale and recycle it.
+      chunk      = m_head;
+      m_head     = chunk->next;
+      m_dropped += (chunk->size - m_read);
+      m_size    -= (chunk->size - m_read);
+      m_read     = 0UL;
+    }
+
+    if (chunk != nullptr)
+    {
+      chunk->next = nullptr;
+      chunk->size = 0UL;
+    }
+
+    return chunk;
+  }
+
+  // Pointer to the slot for the next record, or nullptr if it cannot be stored.
+  [[nodiscard]] T* m_reserve(void) noexcept
+  {
+    if (m_tail == nullptr || m_tail->size == m_per_chunk)
+    {
+      Chunk* chunk = m_acquire();
+
+      if (chunk == nullptr)
+      {
+        return nullptr;
+      }
+
+      if (m_tail == nullptr)
+      {
+        m_head = chunk;
+        m_read = 0UL;
+      }
+      else
+      {
+        m_tail->next = chunk;
+      }
+
+      m_tail = chunk;
+    }
+
+    return m_records(m_tail) + m_tail->size;
+  }
+
+  [[nodiscard]] int m_overflow(void) noexcept
+  {
+    if (m_policy == OverflowPolicy::REJECT)
+    {
+      return kFull;
+    }
+
+    ++m_dropped;
+    return kOk;
+  }
+
+public:
+  static constexpr int kFull  = (-1);
+  static constexpr int kEmpty = (-2);
+  static constexpr int kOk    =   0 ;
+
+  /**
+   * @param max_chunks Chunk budget; at most max_chunks * chunk_size bytes.
+   * @param policy     What push() does once the budget is spent.
+   * @param chunk_size Bytes per chunk (header included).
+   */
+  explicit ChunkedLog(const std::size_t    max_chunks = std::numeric_limits<std::size_t>::max(),
+                      const OverflowPolicy policy     = OverflowPolicy::REJECT,
+                      const std::size_t    chunk_size = Arena::kDefaultChunkSize) noexcept
+    : m_arena(chunk_size, max_chunks),
+      m_per_chunk((chunk_size > kHeader) ? ((chunk_size - kHeader) / sizeof(T)) : 0UL),
+      m_head(nullptr),
+      m_tail(nullptr),
+      m_free(nullptr),
+      m_read(0UL),
+      m_size(0UL),
+      m_dropped(0UL),
+      m_policy(policy)
+  {
+  }
+
+  ChunkedLog(const ChunkedLog&)            = delete;
+  ChunkedLog& operator=(const ChunkedLog&) = delete;
+
+  /**
+   * @return kOk if stored or dropped under a DROP_* policy, kFull if the
+   *         budget is spent under REJECT.
+   */
+  [[nodiscard]] int push(const T& record) noexcept
+  {
+    T* slot = m_reserve();
+
+    if (slot == nullptr)
+    {
+      return m_overflow();
+    }
+
+    ::new (static_cast<void*>(slot)) T(record);
+
+    ++m_tail->size;
+    ++m_size;
+
+    return kOk;
+  }
+
+  template <typename... Args>
+  [[nodiscard]] int emplace(Args&&... args) noexcept
+  {
+    T* slot = m_reserve();
+
+    if (slot == nullptr)
+    {
+      return m_overflow();
+    }
+
+    ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+
+    ++m_tail->size;
+    ++m_size;
+
+    return kOk;
+  }
+
+  [[nodiscard]] int pop(T& out) noexcept
+  {
+    if (m_size == 0UL)
+    {
+      return kEmpty;
+    }
+
+    if (m_read == m_head->size)
+    {
+      // m_size > 0, so a later chunk holds the next record.
+      Chunk* done = m_head;
+
+      m_head     = done->next;
+      m_read     = 0UL;
+      done->next = m_free;
+      m_free     = done;
+    }
+
+    out = m_records(m_head)[m_read++];
+    --m_size;
+
+    if (m_size == 0UL)
+    {
+      // Rewind the last chunk so a drained log reuses it from the start.
+      m_head->size = 0UL;
+      m_read       = 0UL;
+    }
+
+    return kOk;
+  }
+
+  /**
+   * @brief Visits every unread record in order, chunk by chunk, without consuming.
+   */
+  template <typename F>
+  void for_each(F&& visit) const noexcept
+  {
+    std::size_t begin = m_read;
+
+    for (Chunk* chunk = m_head; chunk != nullptr; chunk = chunk->next)
+    {
+      const T* records = m_records(chunk);
+
+      for (std::size_t i = begin; i < chunk->size; i++)
+      {
+        visit(records[i]);
+      }
+
+      begin = 0UL;
+    }
+  }
+
+  [[nodiscard]] int empty(bool& out) const noexcept
+  {
+    out = (0UL == m_size);
+    return kOk;
+  }
+
+  [[nodiscard]] int size(std::size_t& out) const noexcept
+  {
+    out = m_size;
+    return kOk;
+  }
+
+  [[nodiscard]] int dropped(std::uint64_t& out) const noexcept
+  {
+    out = m_dropped;
+    return kOk;
+  }
+
+  [[nodiscard]] std::size_t get_chunks(void) const noexcept
+  {
+    return m_arena.get_chunks();
+  }
+
+  [[nodiscard]] std::size_t get_records_per_chunk(void) const noexcept
+  {
+    return m_per_chunk;
+  }
+
+  void set_policy(const OverflowPolicy policy) noexcept
+  {
+    m_policy = policy;
+  }
+
+  void set_max_chunks(const std::size_t max_chunks) noexcept
+  {
+    m_arena.set_max_chunks(max_chunks);
+  }
+};
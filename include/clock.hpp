@@ -4,14 +4,34 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #include <x86intrin.h>
+  #define PACE_CLOCK_HAS_TSC 1
+#endif
+
+/**
+ * @brief Run clock in 64-bit ticks.
+ *
+ * Ticks come from the invariant TSC when the CPU has one (calibrated
+ * against CLOCK_MONOTONIC the first time start() runs) and are plain
+ * monotonic nanoseconds otherwise. Timestamps stay integers everywhere and
+ * are turned into seconds only for output, so precision does not decay
+ * with run length.
+ */
 class Clock
 {
-  std::chrono::time_point<std::chrono::steady_clock> m_start;
-  std::chrono::time_point<std::chrono::steady_clock> m_stop;
+  std::uint64_t m_start{0UL};
+  std::uint64_t m_stop{0UL};
+  double        m_ns_per_tick{1.0};
+  bool          m_use_tsc{false};
+  bool          m_calibrated{false};
 
   Clock() noexcept = default;
 
+  void m_calibrate(void) noexcept;
+
 public:
   static Clock& get_instance(void) noexcept
   {
@@ -27,6 +47,37 @@ public:
   void start(void) noexcept;
   void  stop(void) noexcept;
 
-  std::chrono::time_point<std::chrono::steady_clock> get_start(void) const noexcept;
-  std::chrono::time_point<std::chrono::steady_clock> get_stop(void)  const noexcept;
+  // Current time in ticks.
+  inline std::uint64_t now(void) const noexcept
+  {
+  #if defined(PACE_CLOCK_HAS_TSC)
+    if (m_use_tsc)
+    {
+      return static_cast<std::uint64_t>(__rdtsc());
+    }
+  #endif
+
+    return now_ns();
+  }
+
+  // Ticks since start(); what Frame and Event timestamps hold.
+  inline std::uint64_t elapsed(void) const noexcept
+  {
+    return now() - m_start;
+  }
+
+  std::uint64_t get_start(void) const noexcept;
+  std::uint64_t get_stop(void)  const noexcept;
+
+  double        to_seconds(const std::uint64_t ticks) const noexcept;
+  std::uint64_t to_ns(const std::uint64_t ticks)      const noexcept;
+
+  bool is_tsc(void) const noexcept;
+
+  // Monotonic nanoseconds; cheap enough to bracket every sample.
+  static inline std::uint64_t now_ns(void) noexcept
+  {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+  }
 };
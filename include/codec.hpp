@@ -0,0 +1,206 @@
+/*
+ * Responsibility - Compact delta encoding of sample stacks for the wire and on-disk formats.
+ */
+#pragma once
+
+#include "varint.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * One encoded sample:
+ *
+ *   varint(timestamp delta ns) varint(count) varint(pop) varint(push) varint(id)*push
+ *
+ * pop frames come off the previous sample's stack and push ids go on, so a
+ * sample that only changed its leaf costs a handful of bytes whatever the
+ * depth. Ids refer to a dictionary (name records) kept by the container
+ * format. Encoder and decoder must see the same sample sequence.
+ */
+namespace codec
+{
+  /**
+   * @brief LEB128 store tuned for small values: ids and deltas are mostly
+   *        one or two bytes, which take no loop.
+   */
+  static inline std::uint8_t* put(std::uint8_t* out, const std::uint64_t v) noexcept
+  {
+    if (v < 0x80UL)
+    {
+      *out = static_cast<std::uint8_t>(v);
+      return out + 1;
+    }
+
+    if (v < 0x4000UL)
+    {
+      out[0] = static_cast<std::uint8_t>(v | 0x80UL);
+      out[1] = static_cast<std::uint8_t>(v >> 7);
+      return out + 2;
+    }
+
+    return out + varint::encode(v, out);
+  }
+
+  /**
+   * @brief LEB128 load; returns nullptr on a truncated or overlong value.
+   */
+  static inline const std::uint8_t* get(const std::uint8_t* p,
+                                        const std::uint8_t* end,
+                                        std::uint64_t&      v) noexcept
+  {
+    if (p < end && *p < 0x80U)
+    {
+      v = *p;
+      return p + 1;
+    }
+
+    if ((end - p) >= 2 && p[1] < 0x80U)
+    {
+      v = (static_cast<std::uint64_t>(p[0] & 0x7FU) | (static_cast<std::uint64_t>(p[1]) << 7));
+      return p + 2;
+    }
+
+    return varint::decode(p, end, v);
+  }
+
+  class StackEncoder final
+  {
+    std::vector<std::uint32_t> m_previous;
+    std::uint64_t              m_last_ns{0UL};
+
+  public:
+    StackEncoder() noexcept
+    {
+      m_previous.reserve(128UL);
+    }
+
+    // Upper bound of encode()'s output for a stack of depth frames.
+    [[nodiscard]] static constexpr std::size_t max_bytes(const std::size_t depth) noexcept
+    {
+      return (4UL * varint::kMaxBytes) + (depth * 5UL);
+    }
+
+    /**
+     * @brief Writes one sample at out (at least max_bytes(depth) of room).
+     *
+     * @return One past the last byte written.
+     */
+    std::uint8_t* encode(std::uint8_t*        out,
+                         const std::uint64_t  timestamp_ns,
+                         const std::uint64_t  count,
+                         const std::uint32_t* stack,
+                         const std::size_t    depth) noexcept
+    {
+      const std::size_t shared = std::min(m_previous.size(), depth);
+      std::size_t lcp = 0UL;
+
+      while (lcp < shared && m_previous[lcp] == stack[lcp])
+      {
+        ++lcp;
+      }
+
+      out = put(out, timestamp_ns - m_last_ns);
+      out = put(out, count);
+      out = put(out, m_previous.size() - lcp);
+      out = put(out, depth - lcp);
+
+      for (std::size_t i = lcp; i < depth; i++)
+      {
+        out = put(out, stack[i]);
+      }
+
+      m_previous.assign(stack, stack + depth);
+      m_last_ns = timestamp_ns;
+
+      return out;
+    }
+
+    void reset(void) noexcept
+    {
+      m_previous.clear();
+      m_last_ns = 0UL;
+    }
+  };
+
+  class StackDecoder final
+  {
+    std::vector<std::uint32_t> m_stack;
+    std::uint64_t              m_last_ns{0UL};
+    std::size_t                m_kept{0UL};
+
+  public:
+    StackDecoder() noexcept
+    {
+      m_stack.reserve(128UL);
+    }
+
+    /**
+     * @brief Reads one sample from [p, end) and applies it to the current stack.
+     *
+     * @return One past the sample, or nullptr if it is malformed (the state
+     *         is then unspecified).
+     */
+    const std::uint8_t* decode(const std::uint8_t* p,
+                               const std::uint8_t* end,
+                               std::uint64_t&      timestamp_ns,
+                               std::uint64_t&      count) noexcept
+    {
+      std::uint64_t delta = 0UL;
+      std::uint64_t pop   = 0UL;
+      std::uint64_t push  = 0UL;
+
+      p = get(p, end, delta);
+      p = (p != nullptr) ? get(p, end, count) : nullptr;
+      p = (p != nullptr) ? get(p, end, pop)   : nullptr;
+      p = (p != nullptr) ? get(p, end, push)  : nullptr;
+
+      // Every pushed id takes at least one byte.
+      if (p == nullptr || pop > m_stack.size() || push > static_cast<std::uint64_t>(end - p))
+      {
+        return nullptr;
+      }
+
+      m_stack.resize(m_stack.size() - static_cast<std::size_t>(pop));
+      m_kept = m_stack.size();
+
+      for (std::uint64_t i = 0UL; i < push; i++)
+      {
+        std::uint64_t id = 0UL;
+
+        if ((p = get(p, end, id)) == nullptr)
+        {
+          return nullptr;
+        }
+
+        m_stack.push_back(static_cast<std::uint32_t>(id));
+      }
+
+      m_last_ns   += delta;
+      timestamp_ns = m_last_ns;
+
+      return p;
+    }
+
+    // Stack after the last decode(), outermost first.
+    [[nodiscard]] const std::vector<std::uint32_t>& stack(void) const noexcept
+    {
+      return m_stack;
+    }
+
+    // Leading frames of stack() unchanged by the last decode().
+    [[nodiscard]] std::size_t kept(void) const noexcept
+    {
+      return m_kept;
+    }
+
+    void reset(void) noexcept
+    {
+      m_stack.clear();
+      m_last_ns = 0UL;
+      m_kept    = 0UL;
+    }
+  };
+} // namespace codec
@@ -0,0 +1,441 @@
+/*
+ * Responsibility - HAT-trie variant with lock-free readers and a single copy-on-write writer.
+ */
+#pragma once
+
+#include "epoch.hpp"
+#include "map.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Readers (contains, has_prefix, matches_prefix, matches_substring) take no
+ * locks: they pin an epoch and follow atomically published pointers.
+ *
+ * Writers are serialized by a mutex and never mutate anything a reader can
+ * reach. A bucket is copied, modified and swapped in; a full bucket node is
+ * replaced by a freshly built internal node. Whatever was swapped out is
+ * retired to the epoch domain and freed after a grace period.
+ */
+template <std::size_t BucketCapacity = 64UL>
+class ConcurrentHATTrie
+{
+protected:
+  static constexpr std::size_t kAlphabet = 256UL;
+
+  using Domain = Epoch<>;
+
+  struct BucketMap final : public Map<std::string, std::uint8_t, BucketCapacity>
+  {
+    using Base = Map<std::string, std::uint8_t, BucketCapacity>;
+
+    using Base::m_slots;
+
+    BucketMap() noexcept : Base() {}
+
+    [[nodiscard]] bool contains(std::string_view key) noexcept
+    {
+      std::uint8_t out = 0U;
+      return (this->get(out, std::string(key)) == 0);
+    }
+
+    [[nodiscard]] bool is_occupied(std::uint64_t i) const noexcept
+    {
+      return (static_cast<std::uint8_t>(m_slots[i].state) == 1U);
+    }
+
+    [[nodiscard]] const std::string& key_at(std::uint64_t i) const noexcept
+    {
+      return m_slots[i].key;
+    }
+  };
+
+  // A node is either a bucket node (bucket != nullptr, no children) or an
+  // internal node (bucket == nullptr) for its whole published lifetime.
+  struct Node final
+  {
+    std::atomic<bool>                           is_end{false};
+    std::atomic<BucketMap*>                     bucket{nullptr};
+    std::array<std::atomic<Node*>, kAlphabet>   children{};
+
+    Node() noexcept = default;
+
+    ~Node() noexcept
+    {
+      delete bucket.load(std::memory_order_relaxed);
+    }
+  };
+
+  std::atomic<Node*> m_root;
+  std::mutex         m_writer;
+
+  [[nodiscard]] static inline std::size_t idx(unsigned char c) noexcept
+  {
+    return static_cast<std::size_t>(c);
+  }
+
+  static void m_delete_bucket(void* p) noexcept
+  {
+    delete static_cast<BucketMap*>(p);
+  }
+
+  static void m_delete_node(void* p) noexcept
+  {
+    delete static_cast<Node*>(p);
+  }
+
+  static void m_delete_tree(void* p) noexcept
+  {
+    Node* node = static_cast<Node*>(p);
+
+    for (auto& child : node->children)
+    {
+      Node* c = child.load(std::memory_order_relaxed);
+
+      if (c != nullptr)
+      {
+        m_delete_tree(c);
+      }
+    }
+
+    delete node;
+  }
+
+  static Node* m_make_bucket_node(void) noexcept
+  {
+    Node* node = new Node();
+    node->bucket.store(new BucketMap(), std::memory_order_relaxed);
+    return node;
+  }
+
+  // Builds an unpublished subtree holding keys (all sharing the first depth bytes).
+  static Node* m_make_subtree(std::vector<std::string>& keys, std::size_t depth) noexcept
+  {
+    if (keys.size() <= BucketCapacity)
+    {
+      Node* node = m_make_bucket_node();
+      BucketMap* bucket = node->bucket.load(std::memory_order_relaxed);
+
+      for (const auto& key : keys)
+      {
+        (void)bucket->set(key, 1U);
+      }
+
+      return node;
+    }
+
+    Node* node = new Node();
+    std::array<std::vector<std::string>, kAlphabet> groups{};
+
+    for (auto& key : keys)
+    {
+      if (depth >= key.size())
+      {
+        node->is_end.store(true, std::memory_order_relaxed);
+        continue;
+      }
+
+      groups[idx(static_cast<unsigned char>(key[depth]))].push_back(std::move(key));
+    }
+
+    for (std::size_t i = 0UL; i < kAlphabet; i++)
+    {
+      if (!groups[i].empty())
+      {
+        node->children[i].store(m_make_subtree(groups[i], depth + 1UL), std::memory_order_relaxed);
+      }
+    }
+
+    return node;
+  }
+
+  static bool m_bucket_matches_prefix(const BucketMap* bucket, std::string_view s) noexcept
+  {
+    for (std::uint64_t i = 0UL; i < BucketCapacity; i++)
+    {
+      if (!bucket->is_occupied(i))
+      {
+        continue;
+      }
+
+      const std::string& k = bucket->key_at(i);
+
+      if (k.size() == 0UL || k.size() > s.size())
+      {
+        continue;
+      }
+
+      if (std::memcmp(s.data(), k.data(), k.size()) == 0)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  static bool m_bucket_has_prefix(const BucketMap* bucket, std::string_view prefix) noexcept
+  {
+    for (std::uint64_t i = 0UL; i < BucketCapacity; i++)
+    {
+      if (!bucket->is_occupied(i))
+      {
+        continue;
+      }
+
+      const std::string& k = bucket->key_at(i);
+
+      if (k.size() < prefix.size())
+      {
+        continue;
+      }
+
+      if (std::memcmp(k.data(), prefix.data(), prefix.size()) == 0)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool m_matches_prefix(std::string_view s) const noexcept
+  {
+    const Node* node = m_root.load(std::memory_order_acquire);
+    std::size_t depth = 0UL;
+
+    for (;;)
+    {
+      if (node == nullptr)
+      {
+        return false;
+      }
+
+      const BucketMap* bucket = node->bucket.load(std::memory_order_acquire);
+
+      if (bucket != nullptr)
+      {
+        return m_bucket_matches_prefix(bucket, s);
+      }
+
+      if (node->is_end.load(std::memory_order_acquire))
+      {
+        return true;
+      }
+
+      if (depth >= s.size())
+      {
+        return false;
+      }
+
+      const unsigned char uc = static_cast<unsigned char>(s[depth]);
+      node = node->children[idx(uc)].load(std::memory_order_acquire);
+      ++depth;
+    }
+  }
+
+public:
+  ConcurrentHATTrie() noexcept : m_root(m_make_bucket_node()), m_writer() {}
+
+  ~ConcurrentHATTrie() noexcept
+  {
+    m_delete_tree(m_root.load(std::memory_order_relaxed));
+  }
+
+  ConcurrentHATTrie(const ConcurrentHATTrie&)            = delete;
+  ConcurrentHATTrie& operator=(const ConcurrentHATTrie&) = delete;
+
+  void clear(void) noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_writer);
+
+    Node* old = m_root.exchange(m_make_bucket_node(), std::memory_order_acq_rel);
+
+    Domain& domain = Domain::get_instance();
+    domain.retire(old, m_delete_tree);
+    (void)domain.collect();
+  }
+
+  void insert(std::string_view key) noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_writer);
+
+    Domain& domain = Domain::get_instance();
+    std::atomic<Node*>* slot = &m_root;
+    std::size_t depth = 0UL;
+
+    for (;;)
+    {
+      Node* node = slot->load(std::memory_order_relaxed);
+
+      if (node == nullptr)
+      {
+        Node* fresh = m_make_bucket_node();
+        (void)fresh->bucket.load(std::memory_order_relaxed)->set(std::string(key), 1U);
+        slot->store(fresh, std::memory_order_release);
+        return;
+      }
+
+      BucketMap* bucket = node->bucket.load(std::memory_order_relaxed);
+
+      if (bucket != nullptr)
+      {
+        if (bucket->contains(key))
+        {
+          return;
+        }
+
+        // Copy-on-write: readers keep seeing the old bucket until the swap.
+        BucketMap* copy = new BucketMap(*bucket);
+
+        if (copy->set(std::string(key), 1U) == 0)
+        {
+          node->bucket.store(copy, std::memory_order_release);
+          domain.retire(bucket, m_delete_bucket);
+          (void)domain.collect();
+          return;
+        }
+
+        delete copy;
+
+        // Bucket full: build the promoted subtree off to the side and swap it in.
+        std::vector<std::string> keys;
+        keys.reserve(BucketCapacity + 1UL);
+
+        for (std::uint64_t i = 0UL; i < BucketCapacity; i++)
+        {
+          if (bucket->is_occupied(i))
+          {
+            keys.push_back(bucket->key_at(i));
+          }
+        }
+
+        keys.emplace_back(key);
+
+        Node* promoted = m_make_subtree(keys, depth);
+
+        slot->store(promoted, std::memory_order_release);
+        domain.retire(node, m_delete_node);
+        (void)domain.collect();
+        return;
+      }
+
+      if (depth >= key.size())
+      {
+        node->is_end.store(true, std::memory_order_release);
+        return;
+      }
+
+      const unsigned char uc = static_cast<unsigned char>(key[depth]);
+      slot = &node->children[idx(uc)];
+      ++depth;
+    }
+  }
+
+  [[nodiscard]] bool contains(std::string_view key) const noexcept
+  {
+    const auto guard = Domain::get_instance().pin();
+
+    const Node* node = m_root.load(std::memory_order_acquire);
+    std::size_t depth = 0UL;
+
+    for (;;)
+    {
+      if (node == nullptr)
+      {
+        return false;
+      }
+
+      BucketMap* bucket = node->bucket.load(std::memory_order_acquire);
+
+      if (bucket != nullptr)
+      {
+        return bucket->contains(key);
+      }
+
+      if (depth >= key.size())
+      {
+        return node->is_end.load(std::memory_order_acquire);
+      }
+
+      const unsigned char uc = static_cast<unsigned char>(key[depth]);
+      node = node->children[idx(uc)].load(std::memory_order_acquire);
+      ++depth;
+    }
+  }
+
+  [[nodiscard]] bool has_prefix(std::string_view prefix) const noexcept
+  {
+    const auto guard = Domain::get_instance().pin();
+
+    const Node* node = m_root.load(std::memory_order_acquire);
+    std::size_t depth = 0UL;
+
+    for (;;)
+    {
+      if (node == nullptr)
+      {
+        return false;
+      }
+
+      const BucketMap* bucket = node->bucket.load(std::memory_order_acquire);
+
+      if (bucket != nullptr)
+      {
+        return m_bucket_has_prefix(bucket, prefix);
+      }
+
+      if (depth >= prefix.size())
+      {
+        if (node->is_end.load(std::memory_order_acquire))
+        {
+          return true;
+        }
+
+        for (std::uint64_t i = 0UL; i < kAlphabet; i++)
+        {
+          if (node->children[i].load(std::memory_order_acquire) != nullptr)
+          {
+            return true;
+          }
+        }
+
+        return false;
+      }
+
+      const unsigned char uc = static_cast<unsigned char>(prefix[depth]);
+      node = node->children[idx(uc)].load(std::memory_order_acquire);
+      ++depth;
+    }
+  }
+
+  [[nodiscard]] bool matches_prefix(std::string_view s) const noexcept
+  {
+    const auto guard = Domain::get_instance().pin();
+    return m_matches_prefix(s);
+  }
+
+  [[nodiscard]] bool matches_substring(std::string_view s) const noexcept
+  {
+    const auto guard = Domain::get_instance().pin();
+
+    for (std::size_t i = 0UL; i < s.size(); i++)
+    {
+      if (m_matches_prefix(s.substr(i)))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+};
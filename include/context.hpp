@@ -3,15 +3,27 @@
  */
 #pragma once
 
+#include "chrome_trace.hpp"
 #include "clock.hpp"
+#include "flamegraph.hpp"
+#include "folded.hpp"
+#include "governor.hpp"
 #include "icontext.hpp"
+#include "line_histogram.hpp"
+#include "metrics.hpp"
+#include "options.hpp"
+#include "pacer.hpp"
+#include "pprof.hpp"
 #include "profiler.hpp"
+#include "sample_log.hpp"
+#include "sample_profile.hpp"
 #include "scan.hpp"
 
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #if defined(_WIN32) || defined(__CYGWIN__)
   #include <windows.h>
@@ -72,13 +84,27 @@ namespace pace
       static inline std::shared_ptr<IState> create(Context* ctx);
     };
 
-    Profiler                m_profiler;
-    Scanner                 m_scanner;
-    StateType               m_state_type{StateType::SCAN};
-    std::shared_ptr<IState> m_state{nullptr};
+    Options                                m_options;
+    Metrics                                m_metrics;
+    Profiler                               m_profiler;
+    Scanner                                m_scanner;
+    Pacer                                  m_pacer;
+    Governor                               m_governor;
+    std::shared_ptr<SampleLogWriter>       m_sample_log{nullptr};
+    std::vector<std::shared_ptr<FileSink>> m_files;  // written and reported at exit
+    std::shared_ptr<ChromeTraceWriter>     m_chrome_trace{nullptr};
+    std::shared_ptr<LineHistogram>         m_line_histogram{nullptr};
+    StateType                              m_state_type{StateType::SCAN};
+    std::shared_ptr<IState>                m_state{nullptr};
 
     bool m_next(void) noexcept;
 
+    void m_run(void) noexcept;
+
+    void m_run_sequential(void) noexcept;
+
+    void m_run_pipelined(void) noexcept;
+
     inline bool m_next_state(void) noexcept;
 
     inline void m_change_state(const StateType type) noexcept;
@@ -87,31 +113,97 @@ namespace pace
 
   public:
     template <class T>
-    inline Context(T&& target) noexcept : m_profiler(),
-                                          m_scanner(target),
-                                          m_state(StateScan::create(this))
+    inline Context(T&& target, const Options& options = {}) noexcept
+      : m_options(options),
+        m_metrics(),
+        m_profiler(),
+        m_scanner(target),
+        m_pacer(options.rate_hz),
+        m_governor(options.overhead_budget, options.rate_hz),
+        m_state(StateScan::create(this))
     {
       m_scanner.set_context(this);
+      m_scanner.set_metrics(&m_metrics);
+      m_scanner.set_all_threads(options.all_threads, options.thread_roots);
+      m_scanner.set_sample_mode(options.sample_mode);
+      m_scanner.set_stack_copy(options.stack_copy_bytes);
 
       auto frame_buffer = m_scanner.get_frame_buffer();
+      frame_buffer->set_policy(options.overflow);
 
       m_profiler.set_context(this);
       m_profiler.set_frame_buffer(frame_buffer);
+      m_profiler.set_metrics(&m_metrics);
+      m_profiler.set_overflow_policy(options.overflow);
+      m_profiler.set_event_budget(options.event_log_chunks);
+
+      if (options.sample_log != nullptr)
+      {
+        m_sample_log = std::make_shared<SampleLogWriter>(options.sample_log, options.sample_log_segment_bytes);
+
+        if (!m_sample_log->is_open())
+        {
+          std::cerr << "[sample_log] failed to create " << options.sample_log << "\n";
+          m_sample_log = nullptr;
+        }
+
+        m_profiler.add_sink(m_sample_log.get());
+      }
+
+      if (options.folded != nullptr)
+      {
+        auto folded = std::make_shared<FoldedWriter>(options.folded);
+        m_profiler.add_sink(folded.get());
+        m_files.push_back(folded);
+      }
+
+      if (options.flamegraph != nullptr)
+      {
+        auto flamegraph = std::make_shared<FlameGraphWriter>(options.flamegraph, options.flamegraph_layout);
+        m_profiler.add_sink(flamegraph.get());
+        m_files.push_back(flamegraph);
+      }
 
-      Clock& clock = Clock::get_instance();
-      clock.start();
+      if (options.pprof != nullptr)
+      {
+        const double period_ns = (options.rate_hz > 0.0) ? (1e9 / options.rate_hz) : 0.0;
 
-      for (;;)
+        auto pprof = std::make_shared<PprofWriter>(options.pprof, static_cast<std::uint64_t>(period_ns), options.pprof_compress);
+        m_profiler.add_sink(pprof.get());
+        m_files.push_back(pprof);
+      }
+
+      if (options.chrome_trace != nullptr)
       {
-        if (m_next())
+        m_chrome_trace = std::make_shared<ChromeTraceWriter>(options.chrome_trace);
+
+        if (!m_chrome_trace->is_open())
+        {
+          std::cerr << "[chrome_trace] failed to create " << options.chrome_trace << "\n";
+          m_chrome_trace = nullptr;
+        }
+        else
         {
-          break;
+          m_profiler.set_trace(m_chrome_trace.get());
         }
       }
 
-      clock.stop();
+      if (options.sample_profile != nullptr)
+      {
+        auto sample_profile = std::make_shared<SampleProfileWriter>(options.sample_profile);
+        m_scanner.set_line_offsets(true);
+        m_scanner.set_linkage_names(true);
+        m_profiler.set_sample_profile(sample_profile.get());
+        m_files.push_back(sample_profile);
+      }
 
-      m_profiler.finalize();
+      if (options.line_profile != nullptr)
+      {
+        m_line_histogram = std::make_shared<LineHistogram>();
+        m_scanner.set_line_histogram(m_line_histogram.get());
+      }
+
+      m_run();
     }
 
     ~Context() noexcept;
@@ -121,6 +213,8 @@ namespace pace
     void profile_ERB(void) noexcept;
 
     bool scan(void) noexcept;
+
+    void throttle(void) noexcept;
   };
 
   inline std::shared_ptr<Context::IState> Context::StateScan::create(Context* ctx)
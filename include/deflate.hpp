@@ -0,0 +1,34 @@
+/*
+ * Responsibility - Bundled DEFLATE (RFC 1951) compressor with gzip (RFC 1952) framing.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace deflate
+{
+  enum class Level : std::uint8_t
+  {
+    STORE,  // Stored blocks: valid gzip, no compression, no CPU.
+    FAST,   // Greedy LZ77 over a 32 KiB window with the fixed Huffman code.
+  };
+
+  // CRC-32 (IEEE 802.3), continuing from crc (0 to start).
+  [[nodiscard]] std::uint32_t crc32(const std::uint8_t* data, const std::size_t size, const std::uint32_t crc = 0U) noexcept;
+
+  /**
+   * @brief Appends a raw DEFLATE stream of [data, data + size) to out.
+   *
+   * FAST finds matches through a hash of the next three bytes and a short
+   * chain of earlier positions with the same hash, and codes them with the
+   * fixed Huffman tables, so there is no per-block tree to build or send.
+   * Export payloads are dominated by repeated ids and names, which that
+   * already shrinks several times over.
+   */
+  void compress(const std::uint8_t* data, const std::size_t size, std::vector<std::uint8_t>& out, const Level level = Level::FAST) noexcept;
+
+  // compress() wrapped in a gzip member: header, stream, CRC-32 and size.
+  void gzip(const std::uint8_t* data, const std::size_t size, std::vector<std::uint8_t>& out, const Level level = Level::FAST) noexcept;
+} // namespace deflate
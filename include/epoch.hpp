@@ -0,0 +1,237 @@
+/*
+ * Responsibility - Epoch-based reclamation for lock-free readers of shared structures.
+ */
+#pragma once
+
+#include "common.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Process-wide epoch domain.
+ *
+ * Readers pin the current epoch for the duration of a critical section and
+ * never block. Writers unlink an object, hand it to retire(), and collect()
+ * frees it once every reader that could still observe it has unpinned.
+ *
+ * A thread holds a reader slot only while it is pinned, so any number of
+ * threads may read; past MaxReaders concurrent critical sections, pin()
+ * waits for one to end.
+ *
+ * @tparam MaxReaders Number of reader slots (threads pinned at the same time).
+ */
+template <std::size_t MaxReaders = 128UL>
+class Epoch
+{
+  static constexpr std::uint64_t kIdle = std::numeric_limits<std::uint64_t>::max();
+
+  struct alignas(64) Slot final
+  {
+    std::atomic<std::uint64_t> epoch{kIdle};
+    std::atomic<bool>          owned{false};
+  };
+
+  struct Retired final
+  {
+    void*         ptr;
+    void        (*deleter)(void*);
+    std::uint64_t epoch;
+  };
+
+  // The calling thread's slot while it is pinned, and the one it last held.
+  struct Registration final
+  {
+    Slot*       slot{nullptr};
+    Slot*       last{nullptr};
+    std::size_t depth{0UL};
+  };
+
+  alignas(64) std::atomic<std::uint64_t> m_global{0UL};
+  std::array<Slot, MaxReaders>           m_slots{};
+  std::mutex                             m_limbo_mutex;
+  std::vector<Retired>                   m_limbo;
+
+  Epoch() noexcept = default;
+
+  static Registration& m_registration(void) noexcept
+  {
+    static thread_local Registration registration;
+    return registration;
+  }
+
+  static bool m_claim(Slot& slot) noexcept
+  {
+    bool expected = false;
+    return slot.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel);
+  }
+
+  // Claims a free slot, trying the one this thread held last first so that
+  // a thread that pins repeatedly keeps touching the same cache line.
+  Slot* m_acquire(Slot* last) noexcept
+  {
+    if (last != nullptr && m_claim(*last))
+    {
+      return last;
+    }
+
+    for (;;)
+    {
+      for (auto& slot : m_slots)
+      {
+        if (m_claim(slot))
+        {
+          return &slot;
+        }
+      }
+
+      // MaxReaders threads are inside critical sections: wait for one to
+      // leave. Sections are short, so this cannot last.
+      common::cpu_relax();
+    }
+  }
+
+  std::uint64_t m_min_active(void) const noexcept
+  {
+    std::uint64_t min = kIdle;
+
+    for (const auto& slot : m_slots)
+    {
+      const std::uint64_t e = slot.epoch.load(std::memory_order_acquire);
+
+      if (e < min)
+      {
+        min = e;
+      }
+    }
+
+    return min;
+  }
+
+public:
+  /**
+   * @brief RAII critical section; pointers loaded while it lives stay valid.
+   */
+  class Guard final
+  {
+    Registration* m_reg;
+
+  public:
+    explicit Guard(Registration* reg) noexcept : m_reg(reg) {}
+
+    ~Guard() noexcept
+    {
+      if (--m_reg->depth == 0UL)
+      {
+        m_reg->slot->epoch.store(kIdle, std::memory_order_release);
+        m_reg->slot->owned.store(false, std::memory_order_release);
+        m_reg->slot = nullptr;
+      }
+    }
+
+    Guard(const Guard&)            = delete;
+    Guard& operator=(const Guard&) = delete;
+  };
+
+  static Epoch& get_instance(void) noexcept
+  {
+    static Epoch instance;
+    return instance;
+  }
+
+  Epoch(const Epoch&)          = delete;
+  void operator=(const Epoch&) = delete;
+  Epoch(Epoch&&)               = delete;
+  void operator=(Epoch&&)      = delete;
+
+  ~Epoch() noexcept
+  {
+    for (const auto& r : m_limbo)
+    {
+      r.deleter(r.ptr);
+    }
+  }
+
+  /**
+   * @brief Enters a read-side critical section. Nested pins are allowed.
+   */
+  [[nodiscard]] Guard pin(void) noexcept
+  {
+    Registration& reg = m_registration();
+
+    if (reg.depth++ == 0UL)
+    {
+      reg.slot = m_acquire(reg.last);
+      reg.last = reg.slot;
+      reg.slot->epoch.store(m_global.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+      // Order the slot publication before any load of shared pointers, pairing
+      // with the fence in collect().
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    return Guard(&reg);
+  }
+
+  /**
+   * @brief Defers deletion of an already unlinked object.
+   */
+  void retire(void* ptr, void (*deleter)(void*)) noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_limbo_mutex);
+    m_limbo.push_back({ptr, deleter, m_global.load(std::memory_order_relaxed)});
+  }
+
+  /**
+   * @brief Advances the epoch and frees every object whose grace period has passed.
+   *
+   * @return Number of objects still waiting for readers.
+   */
+  std::size_t collect(void) noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_limbo_mutex);
+
+    if (m_limbo.empty())
+    {
+      return 0UL;
+    }
+
+    m_global.fetch_add(1UL, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const std::uint64_t min = m_min_active();
+    std::size_t kept = 0UL;
+
+    for (std::size_t i = 0UL; i < m_limbo.size(); i++)
+    {
+      const Retired r = m_limbo[i];
+
+      if (r.epoch < min)
+      {
+        r.deleter(r.ptr);
+        continue;
+      }
+
+      m_limbo[kept++] = r;
+    }
+
+    m_limbo.resize(kept);
+    return kept;
+  }
+
+  /**
+   * @brief Blocks until every retired object has been freed.
+   */
+  void synchronize(void) noexcept
+  {
+    while (collect() != 0UL)
+    {
+      common::cpu_relax();
+    }
+  }
+};
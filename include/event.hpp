@@ -2,21 +2,27 @@
 
 #include <cstdint>
 #include <iostream>
-#include <string>
+#include <type_traits>
 
 enum class EventType : std::uint8_t { START, END };
 
+// A frame entered or left the stack; 16 bytes, stored by value in the event log.
 struct Event final
 {
-  EventType   type;
-  float       timestamp;
-  std::string name;
+  std::uint64_t timestamp;  // Clock ticks since start
+  std::uint32_t name;       // Interner id of the function
+  EventType     type;
+  std::uint16_t thread;     // Scanner thread index, in what was padding
 
   explicit Event() noexcept = default;
 
-  explicit Event(const EventType    type_,
-                 const float        timestamp_,
-                 const std::string& name_) noexcept;
+  explicit Event(const EventType     type_,
+                 const std::uint64_t timestamp_,
+                 const std::uint32_t name_,
+                 const std::uint16_t thread_ = 0U) noexcept;
 
   void print(void) const noexcept;
 };
+
+static_assert(std::is_trivially_copyable_v<Event>, "Event must stay a plain record");
+static_assert(sizeof(Event) == 16UL, "Event must stay 16 bytes");
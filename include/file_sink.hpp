@@ -0,0 +1,91 @@
+/*
+ * Responsibility - State and reporting shared by the sinks that aggregate samples and write one file on flush().
+ */
+#pragma once
+
+#include "isink.hpp"
+#include "stack_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief An output file, the frame names it is written with, and whether
+ *        the last write failed.
+ *
+ * flush() rewrites the whole file through m_write(), so calling it again
+ * later exports the longer profile. report() flushes and prints one line:
+ * "<title>: <what> written to <path>", or "[<tag>] failed to write <path>".
+ */
+class FileSink
+{
+  std::string              m_path;
+  std::string_view         m_tag;
+  std::string_view         m_title;
+  std::vector<std::string> m_names;
+  bool                     m_failed{false};
+
+protected:
+  // tag and title must outlive the sink; string literals do.
+  FileSink(std::string path, std::string_view tag, std::string_view title) noexcept;
+
+  // Writes the file; false when it could not be written.
+  [[nodiscard]] virtual bool m_write(void) noexcept = 0;
+
+  // What the file holds, for report(): "12 stacks, 480 samples".
+  virtual void m_describe(std::ostream& out) const noexcept = 0;
+
+  // Frame names by id, as define() gave them.
+  const std::vector<std::string>& m_get_names(void) const noexcept;
+
+  // The name of id, or "?" if it was never defined.
+  std::string_view m_name(const std::uint32_t id) const noexcept;
+
+public:
+  virtual ~FileSink() noexcept = default;
+
+  void define(const std::uint32_t id, std::string_view name) noexcept;
+
+  void flush(void) noexcept;
+
+  void report(void) noexcept;
+
+  const std::string& get_path(void) const noexcept;
+
+  // Whether the last flush() failed to write the file.
+  bool is_failed(void) const noexcept;
+};
+
+/**
+ * @brief A FileSink fed as an ISink: samples are aggregated by full stack
+ *        in a StackTable, so memory follows the number of distinct stacks
+ *        rather than the run length.
+ */
+class StackSink : public ISink, public FileSink
+{
+protected:
+  StackTable m_stacks;
+
+  StackSink(std::string path, std::string_view tag, std::string_view title) noexcept;
+
+  void m_describe(std::ostream& out) const noexcept override;
+
+public:
+  ~StackSink() noexcept override = default;
+
+  void define(const std::uint32_t id, std::string_view name) noexcept override;
+
+  void sample(const std::uint64_t  timestamp_ns,
+              const std::uint64_t  count,
+              const std::uint32_t* stack,
+              const std::size_t    depth) noexcept override;
+
+  void flush(void) noexcept override;
+
+  std::size_t   get_stacks(void)  const noexcept;
+  std::uint64_t get_samples(void) const noexcept;
+};
@@ -0,0 +1,13 @@
+/*
+ * Responsibility - Which way a flame graph merges and stacks its frames.
+ */
+#pragma once
+
+#include <cstdint>
+
+enum class FlameLayout : std::uint8_t
+{
+  FLAME,     // Roots at the bottom, callees stacked above their callers.
+  ICICLE,    // The same graph hanging from the top.
+  REVERSED,  // Stacks merged from the leaf, hanging from the top: who calls the hot functions.
+};
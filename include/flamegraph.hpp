@@ -0,0 +1,88 @@
+/*
+ * Responsibility - Self-contained interactive SVG flame graphs of aggregated stacks.
+ */
+#pragma once
+
+#include "file_sink.hpp"
+#include "flame_layout.hpp"
+#include "stack_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct FlameGraphStyle final
+{
+  std::string title{"Flame Graph"};
+  double      width{1200.0};        // pixels
+  double      frame_height{16.0};   // pixels
+  double      min_width{0.1};       // pixels; narrower frames are pruned
+};
+
+/**
+ * @brief Merged call tree of a StackTable, laid out for drawing.
+ *
+ * The distinct stacks are sorted by frame name and swept once: each stack
+ * shares a prefix with the one before it, so the sweep closes the frames
+ * past that prefix and opens the rest, producing the nodes already in
+ * pre-order (alphabetical siblings, like flamegraph.pl) together with
+ * their sample offsets from the left edge. No per-node lookups or child
+ * lists are needed and layout is that single pass.
+ *
+ * write_svg() emits one <g> per node at least min_width pixels wide;
+ * a narrower node is dropped with its whole subtree, which bounds the
+ * file by the image size rather than the profile size. The SVG embeds its
+ * own script (click to zoom, search, hover details) and references nothing
+ * outside the file.
+ */
+class FlameGraph final
+{
+  struct Node final
+  {
+    std::uint32_t id;
+    std::uint32_t depth;  // 0 for the outermost frame
+    std::uint64_t x;      // samples left of the node
+    std::uint64_t total;
+  };
+
+  std::vector<Node>        m_nodes;
+  std::vector<std::string> m_names;
+  std::uint64_t            m_samples{0UL};
+  FlameLayout              m_layout;
+
+  std::string_view m_name(const std::uint32_t id) const noexcept;
+
+public:
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  /**
+   * @param stacks Aggregated samples, outermost frame first.
+   * @param names  Frame names by id; a missing or empty one is drawn as "?".
+   */
+  FlameGraph(const StackTable& stacks, const std::vector<std::string>& names, const FlameLayout layout = FlameLayout::FLAME) noexcept;
+
+  [[nodiscard]] int write_svg(const std::string& path, const FlameGraphStyle& style = {}) const noexcept;
+
+  // Nodes of the merged tree, before pruning.
+  std::size_t   get_nodes(void)   const noexcept;
+  std::uint64_t get_samples(void) const noexcept;
+};
+
+/**
+ * @brief Sink that aggregates samples by stack, like FoldedWriter, and
+ *        renders them as an SVG flame graph on flush().
+ */
+class FlameGraphWriter final : public StackSink
+{
+  FlameLayout m_layout;
+
+  [[nodiscard]] bool m_write(void) noexcept override;
+
+public:
+  explicit FlameGraphWriter(std::string path, const FlameLayout layout = FlameLayout::FLAME) noexcept;
+
+  ~FlameGraphWriter() noexcept override = default;
+};
@@ -0,0 +1,66 @@
+/*
+ * Responsibility - Collapsed ("folded") stack export of the sample stream for flame graph tools.
+ */
+#pragma once
+
+#include "file_sink.hpp"
+#include "writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace folded
+{
+  /**
+   * @brief Writes stack as "outer;...;leaf", naming id i by name(i).
+   *
+   * ';' separates frames in the format, so one inside a name is written as ':'.
+   */
+  template <typename F>
+  inline void write_stack(Writer& out, const std::uint32_t* stack, const std::size_t depth, F&& name) noexcept
+  {
+    for (std::size_t i = 0UL; i < depth; i++)
+    {
+      const std::string_view frame = name(stack[i]);
+
+      if (i > 0UL)
+      {
+        out.put(';');
+      }
+
+      if (std::memchr(frame.data(), ';', frame.size()) == nullptr)
+      {
+        out.write(frame);
+        continue;
+      }
+
+      for (const char c : frame)
+      {
+        out.put((c == ';') ? ':' : c);
+      }
+    }
+  }
+} // namespace folded
+
+/**
+ * @brief Sink that aggregates samples by full stack and, on flush(), writes
+ *        one "a;b;c count" line per distinct stack (Brendan Gregg's
+ *        collapsed format, as read by flamegraph.pl, speedscope and others),
+ *        in one pass through a Writer.
+ */
+class FoldedWriter final : public StackSink
+{
+  std::uint64_t m_bytes{0UL};
+
+  [[nodiscard]] bool m_write(void) noexcept override;
+
+public:
+  explicit FoldedWriter(std::string path) noexcept;
+
+  ~FoldedWriter() noexcept override = default;
+
+  std::uint64_t get_bytes(void) const noexcept;
+};
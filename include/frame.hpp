@@ -1,13 +1,49 @@
 #pragma once
 
+#include "line_location.hpp"
 #include "snapshot.hpp"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One run of identical consecutive samples: the stack was first seen at
+// timestamp and last seen at last_timestamp (Clock ticks since start),
+// count samples in total.
 struct Frame final
 {
-  float    timestamp;
-  Snapshot snapshot;
+  std::uint64_t timestamp;
+  std::uint64_t last_timestamp;
+  std::uint64_t count;
+  std::uint64_t hash;
+  Snapshot      snapshot;
+
+  // Where each snapshot entry was executing; empty unless the Scanner
+  // tracks line offsets, in which case lines that differ split runs.
+  std::vector<LineLocation> lines;
+
+  // Each snapshot entry's linkage (mangled) name, where it differs from the
+  // display name; empty unless the Scanner tracks linkage names.
+  Snapshot linkage;
+
+  // Which of the Scanner's threads this run is from (0: the target); the
+  // thread's name rides along on its first run only. rooted: snapshot[0] is
+  // the synthetic "[name]" frame of that thread, not a function.
+  std::uint16_t thread{0U};
+  std::string   thread_name;
+  bool          rooted{false};
+
+  // Whether the thread was off-CPU (blocked) when sampled, and the wall
+  // time the run's samples stand for while it was: the part of the time
+  // since each one's previous sample of the same thread that it spent off
+  // a CPU. Both stay 0 on-CPU.
+  bool          off_cpu{false};
+  std::uint64_t off_cpu_ticks{0UL};
 
   Frame() noexcept = default;
 
-  Frame(const float timestamp_, Snapshot snapshot_) noexcept;
+  Frame(const std::uint64_t       timestamp_,
+        const std::uint64_t       hash_,
+        Snapshot                  snapshot_,
+        std::vector<LineLocation> lines_ = {}) noexcept;
 };
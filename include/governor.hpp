@@ -0,0 +1,50 @@
+/*
+ * Responsibility - Keeping the profiler's own CPU cost within a budget by adjusting the sampling rate.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class Governor final
+{
+  static constexpr double        kSmoothing       = (1.0 / 64.0); // EWMA weight of the newest sample
+  static constexpr double        kHysteresis      = 0.25;         // ignore rate changes below 25%
+  static constexpr double        kMinRate         = 1.0;
+  static constexpr std::uint64_t kControlInterval = 64UL;         // samples between decisions
+
+  double                     m_budget;
+  double                     m_max_rate;
+  double                     m_rate;
+  double                     m_avg_cost_ns{0.0};
+  std::uint64_t              m_total_cost_ns{0UL};
+  std::uint64_t              m_updates{0UL};
+  std::uint64_t              m_adjustments{0UL};
+  std::atomic<std::uint64_t> m_pending_ns{0UL};
+
+public:
+  /**
+   * @param budget   Fraction of one CPU the profiler may use (0 disables).
+   * @param max_rate Requested sampling rate; never exceeded.
+   */
+  Governor(const double budget, const double max_rate) noexcept;
+
+  // Adds profiler work done on any thread to the current sample's cost.
+  void charge(const std::uint64_t ns) noexcept;
+
+  /**
+   * @brief Closes one sample: folds its cost into the moving average and
+   *        recomputes the rate that keeps average cost * rate <= budget.
+   *
+   * @return true if the rate changed.
+   */
+  bool update(void) noexcept;
+
+  bool is_enabled(void) const noexcept;
+
+  double        get_budget(void)        const noexcept;
+  double        get_rate(void)          const noexcept;
+  double        get_avg_cost_ns(void)   const noexcept;
+  std::uint64_t get_total_cost_ns(void) const noexcept;
+  std::uint64_t get_adjustments(void)   const noexcept;
+};
@@ -0,0 +1,143 @@
+/*
+ * Responsibility - Fixed-size log-linear latency histogram for self-instrumentation.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Records unsigned values (nanoseconds) into 16 linear sub-buckets per
+ *        power of two, so any reported value is within 1/16 of the truth.
+ *
+ * record() is a handful of integer instructions and never allocates; the
+ * whole histogram is a flat array of counters. It is single-writer: give
+ * each thread its own and merge() them when reading.
+ */
+class Histogram final
+{
+  static constexpr std::uint32_t kSubBits    = 4U;
+  static constexpr std::uint64_t kSubBuckets = (1UL << kSubBits);
+  static constexpr std::size_t   kBuckets    = ((64UL - kSubBits + 1UL) * kSubBuckets);
+
+  std::array<std::uint64_t, kBuckets> m_counts{};
+  std::uint64_t                       m_count{0UL};
+  std::uint64_t                       m_sum{0UL};
+  std::uint64_t                       m_min{std::numeric_limits<std::uint64_t>::max()};
+  std::uint64_t                       m_max{0UL};
+
+  [[nodiscard]] static inline std::size_t m_index(const std::uint64_t value) noexcept
+  {
+    if (value < kSubBuckets)
+    {
+      return static_cast<std::size_t>(value);
+    }
+
+    const std::uint32_t exponent = static_cast<std::uint32_t>(std::bit_width(value) - 1);
+    const std::uint32_t shift    = (exponent - kSubBits);
+    const std::uint64_t sub      = ((value >> shift) & (kSubBuckets - 1UL));
+
+    return static_cast<std::size_t>((shift + 1UL) * kSubBuckets + sub);
+  }
+
+  // Largest value that maps to bucket i.
+  [[nodiscard]] static inline std::uint64_t m_upper(const std::size_t i) noexcept
+  {
+    if (i < kSubBuckets)
+    {
+      return static_cast<std::uint64_t>(i);
+    }
+
+    const std::uint64_t shift = (i / kSubBuckets) - 1UL;
+    const std::uint64_t sub   = (i % kSubBuckets);
+    const std::uint64_t lower = ((kSubBuckets + sub) << shift);
+
+    return lower + ((1UL << shift) - 1UL);
+  }
+
+public:
+  Histogram() noexcept = default;
+
+  inline void record(const std::uint64_t value) noexcept
+  {
+    ++m_counts[m_index(value)];
+    ++m_count;
+
+    m_sum += value;
+    m_min  = std::min(m_min, value);
+    m_max  = std::max(m_max, value);
+  }
+
+  /**
+   * @brief Value at or below which q percent of the recordings fall.
+   *
+   * Reported as the top of the matching bucket, clamped to the true maximum.
+   */
+  [[nodiscard]] std::uint64_t percentile(const double q) const noexcept
+  {
+    if (m_count == 0UL)
+    {
+      return 0UL;
+    }
+
+    const double clamped = std::clamp(q, 0.0, 100.0);
+    std::uint64_t rank = static_cast<std::uint64_t>((clamped / 100.0) * static_cast<double>(m_count) + 0.5);
+    rank = std::clamp<std::uint64_t>(rank, 1UL, m_count);
+
+    std::uint64_t seen = 0UL;
+
+    for (std::size_t i = 0UL; i < kBuckets; i++)
+    {
+      seen += m_counts[i];
+
+      if (seen >= rank)
+      {
+        return std::min(m_upper(i), m_max);
+      }
+    }
+
+    return m_max;
+  }
+
+  void merge(const Histogram& other) noexcept
+  {
+    for (std::size_t i = 0UL; i < kBuckets; i++)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+
+    m_count += other.m_count;
+    m_sum   += other.m_sum;
+    m_min    = std::min(m_min, other.m_min);
+    m_max    = std::max(m_max, other.m_max);
+  }
+
+  void reset(void) noexcept
+  {
+    *this = Histogram();
+  }
+
+  [[nodiscard]] std::uint64_t get_count(void) const noexcept
+  {
+    return m_count;
+  }
+
+  [[nodiscard]] std::uint64_t get_sum(void) const noexcept
+  {
+    return m_sum;
+  }
+
+  [[nodiscard]] std::uint64_t get_min(void) const noexcept
+  {
+    return (m_count == 0UL) ? 0UL : m_min;
+  }
+
+  [[nodiscard]] std::uint64_t get_max(void) const noexcept
+  {
+    return m_max;
+  }
+};
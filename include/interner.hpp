@@ -0,0 +1,66 @@
+/*
+ * Responsibility - Mapping frame names to dense 32-bit ids with stable, lock-free lookups.
+ */
+#pragma once
+
+#include "arena.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Single-writer, multi-reader string interner.
+ *
+ * The writer (the Profiler) calls intern(); any thread may call name() for an
+ * id it received through a synchronizing hand-off such as a queue. Strings
+ * are copied into arena chunks and the id table grows in fixed blocks, so
+ * nothing a reader can reach is ever moved or freed before destruction.
+ */
+class Interner final
+{
+  struct Entry final
+  {
+    const char*   data;
+    std::uint32_t size;
+  };
+
+  static constexpr std::size_t kBlockBits = 12UL;
+  static constexpr std::size_t kBlockSize = (1UL << kBlockBits);
+  static constexpr std::size_t kMaxBlocks = 1024UL;
+
+  Arena                                              m_strings;
+  std::vector<std::unique_ptr<char[]>>               m_oversized;
+  std::array<std::atomic<Entry*>, kMaxBlocks>        m_blocks{};
+  std::atomic<std::uint32_t>                         m_count{0U};
+  std::unordered_map<std::string_view, std::uint32_t> m_ids;
+
+  const char* m_store(std::string_view s) noexcept;
+
+public:
+  static constexpr std::uint32_t kInvalid = 0xFFFFFFFFU;
+
+  Interner() noexcept;
+
+  ~Interner() noexcept;
+
+  Interner(const Interner&)            = delete;
+  Interner& operator=(const Interner&) = delete;
+
+  /**
+   * @brief Writer only. Returns the id of s, assigning the next one if new.
+   *
+   * @return kInvalid once kMaxBlocks * kBlockSize names exist.
+   */
+  std::uint32_t intern(std::string_view s) noexcept;
+
+  // Any thread; id must come from intern().
+  std::string_view name(const std::uint32_t id) const noexcept;
+
+  std::uint32_t size(void) const noexcept;
+};
@@ -0,0 +1,39 @@
+/*
+ * Responsibility - Interface for consumers of the Profiler's sample stream.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * The Profiler calls define() the first time a name id appears, always
+ * before the first sample() that uses it. Stacks are outermost-first ids.
+ * finish() comes once, from Profiler::finalize(), after the last sample.
+ */
+class ISink
+{
+protected:
+  ISink() noexcept = default;
+
+public:
+  virtual ~ISink() noexcept = default;
+
+  virtual void define(const std::uint32_t id, std::string_view name) noexcept = 0;
+
+  virtual void sample(const std::uint64_t  timestamp_ns,
+                      const std::uint64_t  count,
+                      const std::uint32_t* stack,
+                      const std::size_t    depth) noexcept = 0;
+
+  virtual void flush(void) noexcept = 0;
+
+  // The session's wall time and the sampling ticks it ran; each tick
+  // samples one thread, so a sample stands for duration_ns / ticks.
+  virtual void finish(const std::uint64_t duration_ns, const std::uint64_t ticks) noexcept
+  {
+    (void)duration_ns;
+    (void)ticks;
+  }
+};
@@ -0,0 +1,82 @@
+/*
+ * Responsibility - Per-PC leaf sample counts and their annotated source listing.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct SourceLine final
+{
+  std::string   function;
+  std::string   file;
+  std::uint32_t line{0U};   // 0 when unknown
+};
+
+/**
+ * @brief Counts samples by the leaf frame's program counter.
+ *
+ * Sampling only bumps a counter per address; nothing is symbolized until
+ * resolve(), which looks each distinct PC up exactly once, typically at the
+ * end of the run. write() then folds PCs onto source lines and lists every
+ * function with its hottest lines, quoting the source when the file can be
+ * read, which is the loop-level view that function totals hide.
+ */
+class LineHistogram final
+{
+  struct Entry final
+  {
+    std::uint64_t samples{0UL};
+    bool          resolved{false};
+    SourceLine    line;
+  };
+
+  std::unordered_map<std::uintptr_t, Entry> m_pcs;
+  std::uint64_t                             m_samples{0UL};
+
+public:
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  static constexpr std::size_t kDefaultTopLines = 10UL;
+
+  LineHistogram() noexcept = default;
+
+  void add(const std::uintptr_t pc, const std::uint64_t count = 1UL) noexcept
+  {
+    m_pcs[pc].samples += count;
+    m_samples         += count;
+  }
+
+  // Calls resolve(pc, SourceLine&) once for each PC not resolved yet; a
+  // false return leaves that PC unknown.
+  template <class F>
+  void resolve(F&& resolve) noexcept
+  {
+    for (auto& [pc, entry] : m_pcs)
+    {
+      if (!entry.resolved)
+      {
+        entry.resolved = true;
+
+        if (!resolve(pc, entry.line))
+        {
+          entry.line = SourceLine{};
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Writes the annotated listing, hottest function first, with at
+   *        most top_lines lines each; the rest are summed up in one line.
+   *
+   * @return kOk, or kIoError when the file cannot be written.
+   */
+  [[nodiscard]] int write(const std::string& path, const std::size_t top_lines = kDefaultTopLines) const noexcept;
+
+  std::size_t   get_pcs(void)     const noexcept;
+  std::uint64_t get_samples(void) const noexcept;
+};
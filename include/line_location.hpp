@@ -0,0 +1,19 @@
+/*
+ * Responsibility - Where in its function a sampled frame was executing.
+ */
+#pragma once
+
+#include <cstdint>
+
+// A source line as a sample-based profile keys it: lines since the first
+// line of the enclosing function, plus the DWARF discriminator that tells
+// apart blocks sharing that line. kNoLine marks a frame without line info.
+struct LineLocation final
+{
+  static constexpr std::uint32_t kNoLine = 0xFFFFFFFFU;
+
+  std::uint32_t offset{kNoLine};
+  std::uint32_t discriminator{0U};
+
+  [[nodiscard]] bool operator==(const LineLocation&) const noexcept = default;
+};
@@ -68,6 +68,9 @@ public:
 
   int set(const K& key, const V& val) noexcept;
 
+  // Inserts a key known to be absent, skipping set()'s existence scan.
+  int set_unique(K&& key, const V& val) noexcept;
+
   int del(const K& key) noexcept;
 };
 
@@ -154,12 +157,14 @@ int Map<K, V, N>::get(V& val, const K& key) noexcept
   {
     Bucket& slot = m_slots[(displacement + base) % N];
 
-    if (slot.state == BucketState::EMPTY)
+    // Robin Hood invariant: the key would have displaced a slot closer to
+    // its home, so nothing further along can match.
+    if (slot.state == BucketState::EMPTY || slot.psl < displacement)
     {
       return (-1);
     }
 
-    if (slot.state == BucketState::OCCUPIED && key == slot.key)
+    if (key == slot.key)
     {
       val = slot.val;
       return 0;
@@ -273,3 +278,59 @@ int Map<K, V, N>::del(const K& key) noexcept
 
   return (-1);
 }
+
+template <typename K, typename V, std::size_t N>
+int Map<K, V, N>::set_unique(K&& key, const V& val) noexcept
+{
+  const std::uint64_t base = m_index_for_key(key);
+
+  // Only the run up to the next EMPTY slot is shifted, so that is all we
+  // need to look at to know whether the key fits.
+  bool has_empty = false;
+
+  for (std::uint64_t i = 0UL; i < N; i++)
+  {
+    if (m_slots[(base + i) % N].state == BucketState::EMPTY)
+    {
+      has_empty = true;
+      break;
+    }
+  }
+
+  if (!has_empty)
+  {
+    return (-1);
+  }
+
+  K           k = std::move(key);
+  V           v = val;
+  BucketBase  b = base;
+  PSL         p = 0UL;
+
+  for (std::uint64_t i = 0UL; i < N; i++)
+  {
+    Bucket& slot = m_slots[(static_cast<std::uint64_t>(b) + static_cast<std::uint64_t>(p)) % N];
+
+    if (slot.state == BucketState::EMPTY)
+    {
+      slot.state = BucketState::OCCUPIED;
+      slot.base  = b;
+      slot.psl   = p;
+      slot.key   = std::move(k);
+      slot.val   = std::move(v);
+      return 0;
+    }
+
+    if (slot.psl < p)
+    {
+      std::swap(slot.key,  k);
+      std::swap(slot.val,  v);
+      std::swap(slot.base, b);
+      std::swap(slot.psl,  p);
+    }
+
+    ++p;
+  }
+
+  return (-1);
+}
@@ -0,0 +1,29 @@
+/*
+ * Responsibility - Self-instrumentation counters and latency histograms for one profiling run.
+ */
+#pragma once
+
+#include "histogram.hpp"
+
+#include <cstdint>
+
+/**
+ * Every histogram is in nanoseconds and has a single writer: the sampling
+ * histograms are written by the thread that calls Scanner::scan, profile by
+ * the thread that runs the Profiler. They are read only after the run.
+ */
+struct Metrics final
+{
+  Histogram     scan;       // whole Scanner::scan for one sample
+  Histogram     capture;    // ITrace::capture (suspend, walk, symbolize)
+  Histogram     suspend;    // target thread suspended
+  Histogram     symbolize;  // symbol lookups inside capture
+  Histogram     profile;    // Profiler::m_profile for one frame run
+
+  std::uint64_t failed_captures{0UL};   // capture returned no frames
+  std::uint64_t off_cpu_samples{0UL};   // samples taken while the thread was blocked
+  std::uint64_t off_cpu_skipped{0UL};   // SampleMode::CPU ticks before a thread ran enough to be due
+  std::uint64_t frames_dropped{0UL};    // frame runs lost to a full queue
+  std::uint64_t events_dropped{0UL};    // START/END events lost to a full queue
+  std::uint64_t events_unmatched{0UL};  // events the sink could not pair
+};
@@ -0,0 +1,103 @@
+/*
+ * Responsibility - Run-time configuration of a profiling session.
+ */
+#pragma once
+
+#include "flame_layout.hpp"
+#include "overflow.hpp"
+#include "sample_mode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pace
+{
+  enum class ExecutionMode
+  {
+    SEQUENTIAL, // SCAN -> PROFILE -> THROTTLE on the calling thread.
+    PIPELINED,  // Sampler, profiler and sink threads linked by bounded queues.
+  };
+
+  struct Options final
+  {
+    ExecutionMode mode{ExecutionMode::SEQUENTIAL};
+
+    // Target sampling frequency; samples are scheduled on absolute deadlines.
+    double rate_hz{40.0};
+
+    // When non-zero, a capture stops the thread only to copy its registers
+    // and the top stack_copy_bytes of its stack, and unwinds the copy after
+    // resuming it, like perf --call-graph dwarf. Frames deeper than the
+    // copy are lost. 0 unwinds the stopped thread in place.
+    std::size_t stack_copy_bytes{0UL};
+
+    // WALL samples threads whether running or blocked and reports the time
+    // blocked by stack after the profile; CPU samples each thread in
+    // proportion to the CPU time it used.
+    SampleMode sample_mode{SampleMode::WALL};
+
+    // Fraction of one CPU the profiler may spend on capture and aggregation
+    // (e.g. 0.01). When set, the rate is lowered below rate_hz as needed to
+    // stay within it. 0 samples at rate_hz regardless of cost.
+    double overhead_budget{0.0};
+
+    // What the frame and event queues do when a burst fills them; the loss
+    // is counted and reported by dump(). REJECT keeps the fail-fast
+    // behaviour of trapping the process.
+    OverflowPolicy overflow{OverflowPolicy::DROP_NEWEST};
+
+    // PIPELINED with OverflowPolicy::BLOCK: how long a stage waits for room
+    // before dropping. 0 waits indefinitely.
+    std::uint32_t overflow_timeout_ms{0U};
+
+    // Memory budget of the profiler's event log in 64 KiB chunks (4095
+    // events each); the overflow policy applies once it is spent.
+    std::size_t event_log_chunks{256UL};
+
+    // When set, every sample is also streamed to an on-disk log at this
+    // path prefix (<path>.0000, <path>.0001, ...), rolled over every
+    // sample_log_segment_bytes. Read it back with SampleLogReader.
+    const char* sample_log{nullptr};
+    std::size_t sample_log_segment_bytes{64UL * 1024UL * 1024UL};
+
+    // When set, samples are aggregated by full stack and written to this
+    // file in collapsed "a;b;c count" form when the session ends, ready for
+    // flamegraph.pl, speedscope and similar tools.
+    const char* folded{nullptr};
+
+    // When set, the same aggregate is rendered to this file as a
+    // self-contained interactive SVG flame graph when the session ends.
+    const char* flamegraph{nullptr};
+    FlameLayout flamegraph_layout{FlameLayout::FLAME};
+
+    // When set, the same aggregate is written here as a pprof profile
+    // (profile.proto), gzipped unless pprof_compress is false.
+    const char* pprof{nullptr};
+    bool        pprof_compress{true};
+
+    // When set, every START/END is streamed to this file as a Chrome trace
+    // (Trace Event Format JSON) for chrome://tracing or ui.perfetto.dev.
+    const char* chrome_trace{nullptr};
+
+    // When set, frames are also resolved to lines and written here as an
+    // LLVM text sample profile at exit, for clang -fprofile-sample-use.
+    const char* sample_profile{nullptr};
+
+    // When set, each sample's leaf PC is counted and, at exit, resolved to
+    // its source line once per PC and written here as a per-function
+    // listing of the hottest line_profile_top lines.
+    const char* line_profile{nullptr};
+    std::size_t line_profile_top{10UL};
+
+    // Sample every thread of the process, one per tick round-robin, instead
+    // of only the target. With thread_roots each stack is rooted at a
+    // "[thread name]" frame, so every aggregate holds a profile per thread
+    // whose sum is the merged one.
+    bool all_threads{false};
+    bool thread_roots{true};
+
+    // PIPELINED only: write START/END durations from a dedicated sink thread
+    // as they are produced instead of buffering them until dump().
+    bool sink{true};
+  };
+} // namespace pace
@@ -0,0 +1,14 @@
+/*
+ * Responsibility - What a bounded queue does with an element that does not fit.
+ */
+#pragma once
+
+#include <cstdint>
+
+enum class OverflowPolicy : std::uint8_t
+{
+  REJECT,       // push() returns kFull and the caller decides.
+  DROP_NEWEST,  // The incoming element is discarded and counted.
+  DROP_OLDEST,  // The oldest queued element is overwritten and counted.
+  BLOCK,        // Wait for room (BlockingQueue only; Queue treats it as DROP_NEWEST).
+};
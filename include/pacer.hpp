@@ -0,0 +1,50 @@
+/*
+ * Responsibility - Scheduling samples on absolute deadlines at a fixed rate.
+ */
+#pragma once
+
+#include <cstdint>
+
+class Pacer final
+{
+  std::uint64_t m_period_ns{0UL};
+  std::uint64_t m_deadline_ns{0UL};
+  std::uint64_t m_ticks{0UL};
+  std::uint64_t m_missed{0UL};
+
+  // Windows: the high-resolution waitable timer sleeps wait on, and the
+  // final stretch before a deadline that is spun instead, since the timer
+  // may wake a little late.
+  void*         m_timer{nullptr};
+  std::uint64_t m_spin_ns{0UL};
+  bool          m_raised_period{false};
+
+  static std::uint64_t m_now_ns(void) noexcept;
+
+  void m_sleep_until_ns(const std::uint64_t deadline_ns) noexcept;
+
+public:
+  explicit Pacer(const double rate_hz) noexcept;
+
+  Pacer(const Pacer&)            = delete;
+  Pacer& operator=(const Pacer&) = delete;
+
+  ~Pacer() noexcept;
+
+  void start(void) noexcept;
+
+  /**
+   * @brief Sleeps until the next tick on the t0 + k * period grid.
+   *
+   * If the last sample overran, returns at once for the latest passed tick;
+   * the ticks before it are skipped and counted instead of run back to back,
+   * so the schedule never drifts.
+   */
+  void wait(void) noexcept;
+
+  void set_rate(const double rate_hz) noexcept;
+
+  double        get_rate(void)   const noexcept;
+  std::uint64_t get_ticks(void)  const noexcept;
+  std::uint64_t get_missed(void) const noexcept;
+};
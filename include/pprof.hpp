@@ -0,0 +1,75 @@
+/*
+ * Responsibility - pprof (profile.proto) export of aggregated stacks.
+ */
+#pragma once
+
+#include "file_sink.hpp"
+#include "stack_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PprofInfo final
+{
+  std::uint64_t time_ns{0UL};      // wall-clock start, ns since the Unix epoch; 0 if unknown
+  std::uint64_t duration_ns{0UL};
+  std::uint64_t period_ns{0UL};    // wall time one sample stands for; 0 drops the wall value
+  bool          compress{true};    // gzip, as pprof writes; false leaves the protobuf bare
+};
+
+namespace pprof
+{
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  /**
+   * @brief Writes stacks as a profile.proto message.
+   *
+   * One Sample per distinct stack, so encoding is linear in unique stacks
+   * rather than in samples. Sample values are [samples/count] plus
+   * [wall/nanoseconds] when the period is known. Frames here are function
+   * names, not addresses: each id in use becomes one Function and one
+   * Location (id + 1, address 0) holding a single Line, and the string
+   * table is the fixed type strings followed by those names. Names are
+   * already unique per id (the Profiler interns them), so nothing is
+   * deduplicated again.
+   */
+  [[nodiscard]] int write(const std::string&              path,
+                          const StackTable&               stacks,
+                          const std::vector<std::string>& names,
+                          const PprofInfo&                info) noexcept;
+
+  // The same message in memory, gzipped if info.compress.
+  void encode(const StackTable&               stacks,
+              const std::vector<std::string>& names,
+              const PprofInfo&                info,
+              std::vector<std::uint8_t>&      out) noexcept;
+} // namespace pprof
+
+/**
+ * @brief Sink that aggregates samples by stack and writes a pprof profile
+ *        on flush(). The sample period is the session's wall time over its
+ *        ticks, as finish() reports them, which follows any rate change the
+ *        governor made and does not depend on the order runs arrive in.
+ *        Before finish() it falls back to nominal_period_ns.
+ */
+class PprofWriter final : public StackSink
+{
+  std::uint64_t m_nominal_period_ns;
+  std::uint64_t m_start_ns;        // wall clock at construction
+  std::uint64_t m_duration_ns{0UL};
+  std::uint64_t m_ticks{0UL};
+  bool          m_compress;
+
+  [[nodiscard]] bool m_write(void) noexcept override;
+
+public:
+  explicit PprofWriter(std::string path, const std::uint64_t nominal_period_ns = 0UL, const bool compress = true) noexcept;
+
+  ~PprofWriter() noexcept override = default;
+
+  void finish(const std::uint64_t duration_ns, const std::uint64_t ticks) noexcept override;
+};
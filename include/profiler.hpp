@@ -3,43 +3,140 @@
  */
 #pragma once
 
+#include "chrome_trace.hpp"
+#include "chunked_log.hpp"
 #include "event.hpp"
 #include "frame.hpp"
+#include "histogram.hpp"
 #include "icontext.hpp"
+#include "interner.hpp"
+#include "isink.hpp"
+#include "line_location.hpp"
+#include "metrics.hpp"
+#include "overflow.hpp"
 #include "queue.hpp"
+#include "sample_profile.hpp"
 #include "snapshot.hpp"
+#include "stack.hpp"
+#include "stack_table.hpp"
 
+#include <cstddef>
 #include <cstdint>
-#include <tuple>
+#include <vector>
 
 class Profiler final
 {
-  using StartsNStopsTuple = std::tuple<std::vector<std::string>, std::vector<std::string>>;
-
   std::uint64_t       m_num_captured_samples;
-  Snapshot            m_previous_snapshot;
-  Queue<Event, 64UL>  m_queue;
+  std::uint64_t       m_num_missed_ticks{0UL};
+  double              m_requested_rate{0.0};
+  std::uint64_t       m_overhead_ns{0UL};
+  double              m_overhead_budget{0.0};
+  double              m_governed_rate{0.0};
+  std::uint64_t       m_rate_adjustments{0UL};
+  Interner            m_interner;
+  std::vector<std::uint32_t> m_previous_ids;
+  std::vector<std::uint32_t> m_current_ids;
+  std::vector<std::vector<std::uint32_t>> m_parked_ids;  // open stacks of the other threads
+  std::uint16_t       m_thread{0U};
+  ChunkedLog<Event>   m_log;
+  std::vector<Stack<Event, 128UL>> m_stacks;  // sink() stacks, one per thread
+  StackTable          m_off_cpu;  // off-CPU ticks by stack
+  std::uint64_t       m_off_cpu_samples{0UL};
   Queue<Frame, 64UL>* m_frame_buffer{nullptr};
   IContext*           m_context{nullptr};
+  Metrics*            m_metrics{nullptr};
+  std::vector<ISink*> m_sinks;
+  ChromeTraceWriter*  m_trace{nullptr};
+  SampleProfileWriter* m_sample_profile{nullptr};
+  std::uint32_t       m_defined{0U};
+  Interner            m_linkage;  // sample profile names, see m_add_sample_profile
+  std::vector<std::uint32_t> m_linkage_ids;
+  std::uint32_t       m_linkage_defined{0U};
+
+  void m_profile(const Frame& frame) noexcept;
+
+  void m_profile(const std::uint16_t              thread,
+                 const std::uint64_t              timestamp,
+                 const std::uint64_t              count,
+                 const Snapshot&                  snapshot) noexcept;
+
+  void m_add_sample_profile(const Frame& frame) noexcept;
+
+  // Makes thread's open stack the one m_previous_ids holds.
+  void m_switch_thread(const std::uint16_t thread) noexcept;
+
+  Stack<Event, 128UL>& m_stack_of(const std::uint16_t thread) noexcept;
 
-  void m_profile(const float timestamp, Snapshot snapshot) noexcept;
+  std::size_t m_common_prefix(void) const noexcept;
 
-  StartsNStopsTuple m_find_mismatches(const Snapshot& snapshot) noexcept;
+  void m_dump_metrics(const double elapsed_seconds) const noexcept;
+
+  void m_dump_off_cpu(void) const noexcept;
+
+  void m_sink_unmatched(Stack<Event, 128UL>& stack, const Event& event) noexcept;
+
+  void m_count_unmatched(const std::uint64_t n) noexcept;
 
 public:
+  // Stacks listed by dump() under off-CPU time.
+  static constexpr std::size_t kOffCpuStacks = 10UL;
+
+  // The trace's tid for the target thread; thread i of the Scanner is
+  // kTraceThread + i.
+  static constexpr std::uint32_t kTraceThread = 1U;
+
   explicit Profiler() noexcept;
 
   ~Profiler() noexcept = default;
 
-  void finalize(void) noexcept;
+  // Closes every thread's open runs and tells each sink the session's
+  // wall time and the ticks sampled in it.
+  void finalize(const std::uint64_t ticks) noexcept;
 
   void profile(void) noexcept;
 
   void profile_ERB(void) noexcept;
 
+  void profile(Frame frame) noexcept;
+
+  [[nodiscard]] bool next_event(Event& event) noexcept;
+
+  void sink(const Event& event) noexcept;
+
   void dump(void) noexcept;
 
   void set_context(IContext* context) noexcept;
 
   void set_frame_buffer(Queue<Frame, 64UL>* frame_buffer) noexcept;
+
+  void set_requested_rate(const double rate_hz) noexcept;
+
+  void set_missed_ticks(const std::uint64_t missed) noexcept;
+
+  // What the governor spent and where it left the rate; budget 0 when it
+  // was off.
+  void set_overhead(const std::uint64_t cost_ns,
+                    const double        budget,
+                    const double        rate_hz,
+                    const std::uint64_t adjustments) noexcept;
+
+  void set_metrics(Metrics* metrics) noexcept;
+
+  void set_overflow_policy(const OverflowPolicy policy) noexcept;
+
+  void set_event_budget(const std::size_t max_chunks) noexcept;
+
+  // Streams every sample (and each name before its first use) to sink as
+  // well as to any sink added before it. Add sinks before sampling starts.
+  void add_sink(ISink* sink) noexcept;
+
+  // Writes each START/END to trace as it is produced, on the tid of its
+  // thread, so the file grows with the run instead of with the event
+  // log. Set before sampling starts.
+  void set_trace(ChromeTraceWriter* trace) noexcept;
+
+  // Feeds every run with its line locations to sample_profile, named by
+  // linkage name. Runs only carry lines and linkage names when the Scanner
+  // tracks them.
+  void set_sample_profile(SampleProfileWriter* sample_profile) noexcept;
 };
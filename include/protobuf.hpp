@@ -0,0 +1,110 @@
+/*
+ * Responsibility - Minimal protocol buffers wire-format encoder for the export formats.
+ */
+#pragma once
+
+#include "varint.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace protobuf
+{
+  enum class WireType : std::uint8_t
+  {
+    VARINT = 0,
+    LEN    = 2,
+  };
+
+  /**
+   * @brief Appends fields to a byte buffer in the protobuf wire format.
+   *
+   * Only what the exporters need: varint scalars, strings, packed repeated
+   * varints and nested messages. A nested message is encoded into its own
+   * Encoder first and copied in by message(), since its length prefix must
+   * precede it; reuse one scratch Encoder (clear()) to keep that allocation
+   * free in loops.
+   */
+  class Encoder final
+  {
+    std::vector<std::uint8_t> m_data;
+
+    inline void m_raw(std::uint64_t v) noexcept
+    {
+      std::uint8_t bytes[varint::kMaxBytes];
+      const std::size_t n = varint::encode(v, bytes);
+
+      m_data.insert(m_data.end(), bytes, bytes + n);
+    }
+
+    inline void m_tag(const std::uint32_t field, const WireType type) noexcept
+    {
+      m_raw((static_cast<std::uint64_t>(field) << 3) | static_cast<std::uint64_t>(type));
+    }
+
+  public:
+    Encoder() noexcept = default;
+
+    // A zero value is the proto3 default and is omitted, as protoc does.
+    inline void varint(const std::uint32_t field, const std::uint64_t v) noexcept
+    {
+      if (v != 0UL)
+      {
+        m_tag(field, WireType::VARINT);
+        m_raw(v);
+      }
+    }
+
+    // Always emitted: repeated string entries are positional (a string table's "" at 0).
+    inline void bytes(const std::uint32_t field, std::string_view s) noexcept
+    {
+      m_tag(field, WireType::LEN);
+      m_raw(s.size());
+      m_data.insert(m_data.end(), s.begin(), s.end());
+    }
+
+    template <typename T>
+    inline void packed(const std::uint32_t field, const T* values, const std::size_t n) noexcept
+    {
+      if (n == 0UL)
+      {
+        return;
+      }
+
+      std::size_t size = 0UL;
+
+      for (std::size_t i = 0UL; i < n; i++)
+      {
+        std::uint8_t scratch[varint::kMaxBytes];
+        size += varint::encode(static_cast<std::uint64_t>(values[i]), scratch);
+      }
+
+      m_tag(field, WireType::LEN);
+      m_raw(size);
+
+      for (std::size_t i = 0UL; i < n; i++)
+      {
+        m_raw(static_cast<std::uint64_t>(values[i]));
+      }
+    }
+
+    inline void message(const std::uint32_t field, const Encoder& nested) noexcept
+    {
+      m_tag(field, WireType::LEN);
+      m_raw(nested.m_data.size());
+      m_data.insert(m_data.end(), nested.m_data.begin(), nested.m_data.end());
+    }
+
+    [[nodiscard]] inline const std::vector<std::uint8_t>& data(void) const noexcept
+    {
+      return m_data;
+    }
+
+    inline void clear(void) noexcept
+    {
+      m_data.clear();
+    }
+  };
+} // namespace protobuf
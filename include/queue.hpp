@@ -1,5 +1,7 @@
 #pragma once
 
+#include "overflow.hpp"
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -15,25 +17,60 @@ protected:
   std::uint64_t    m_head;
   std::uint64_t    m_tail;
 
+  OverflowPolicy   m_policy;
+  std::uint64_t    m_dropped;
+
   std::array<T, N> m_data;
 
+  // Makes room for one element according to the policy; false if the
+  // incoming element must not be stored.
+  [[nodiscard]] bool m_make_room(void) noexcept
+  {
+    if (m_size < N)
+    {
+      return true;
+    }
+
+    if (m_policy == OverflowPolicy::DROP_OLDEST)
+    {
+      ++m_head;
+      --m_size;
+      ++m_dropped;
+      return true;
+    }
+
+    if (m_policy != OverflowPolicy::REJECT)
+    {
+      ++m_dropped;
+    }
+
+    return false;
+  }
+
 public:
   static constexpr int kFull  = (-1);
   static constexpr int kEmpty = (-2);
   static constexpr int kOk    =   0 ;
 
-  Queue() noexcept : m_size(0UL),
-                     m_head(0UL),
-                     m_tail(0UL),
-                     m_data()
+  explicit Queue(const OverflowPolicy policy = OverflowPolicy::REJECT) noexcept
+    : m_size(0UL),
+      m_head(0UL),
+      m_tail(0UL),
+      m_policy(policy),
+      m_dropped(0UL),
+      m_data()
    {
    }
 
+   /**
+    * @return kOk if stored or dropped under a DROP_* policy, kFull if full
+    *         under REJECT.
+    */
    [[nodiscard]] int push(const T& element) noexcept
    {
-     if (m_size >= N)
+     if (!m_make_room())
      {
-       return kFull;
+       return (m_policy == OverflowPolicy::REJECT) ? kFull : kOk;
      }
 
      m_data[m_tail & kMask] = element;
@@ -47,9 +84,9 @@ public:
    template <typename... Args>
    [[nodiscard]] int emplace(Args&&... args) noexcept
    {
-      if (m_size >= N)
+      if (!m_make_room())
       {
-        return kFull;
+        return (m_policy == OverflowPolicy::REJECT) ? kFull : kOk;
       }
 
       m_data[m_tail & kMask] = T{std::forward<Args>(args)...};
@@ -98,4 +135,15 @@ public:
      out = m_size;
      return kOk;
    }
+
+   [[nodiscard]] int dropped(std::uint64_t& out) const noexcept
+   {
+     out = m_dropped;
+     return kOk;
+   }
+
+   void set_policy(const OverflowPolicy policy) noexcept
+   {
+     m_policy = policy;
+   }
 };
@@ -0,0 +1,125 @@
+/*
+ * Responsibility - Streaming binary sample log on disk: the writer sink and a sequential reader.
+ */
+#pragma once
+
+#include "codec.hpp"
+#include "isink.hpp"
+#include "segment.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Layout, after each segment header (see SegmentWriter):
+ *
+ *   NAME   := 0x01 varint(id) varint(length) bytes
+ *   SAMPLE := 0x02 codec sample (timestamp delta, count, pop k, push ids)
+ *
+ * A zero byte where a record tag is expected ends the segment. Samples are
+ * deltas against the previous SAMPLE in the same segment (see codec.hpp);
+ * the first sample of a segment is whole, so segments decode independently.
+ * Names are defined once, before first use, for the whole log.
+ */
+enum class SampleLogRecord : std::uint8_t
+{
+  END    = 0x00,
+  NAME   = 0x01,
+  SAMPLE = 0x02,
+};
+
+struct Sample final
+{
+  std::uint64_t              timestamp_ns{0UL};
+  std::uint64_t              count{0UL};
+  std::vector<std::uint32_t> stack;        // outermost first
+  std::size_t                shared{0UL};  // leading frames equal to the previous sample's
+};
+
+class SampleLogWriter final : public ISink
+{
+  SegmentWriter             m_segments;
+  std::vector<std::uint8_t> m_scratch;
+  codec::StackEncoder       m_encoder;
+  std::uint32_t             m_segment{0U};  // segment m_encoder's state belongs to
+  std::uint64_t             m_samples{0UL};
+  std::uint64_t             m_failed{0UL};
+
+  void m_put(const std::uint64_t v) noexcept;
+
+  void m_emit(const SampleLogRecord tag) noexcept;
+
+public:
+  // 2: SAMPLE bodies are stack deltas instead of whole stacks.
+  // 3: the deltas restart at every segment.
+  static constexpr std::uint32_t kVersion             = 3U;
+  static constexpr std::size_t   kDefaultSegmentBytes = (64UL * 1024UL * 1024UL);
+
+  explicit SampleLogWriter(std::string path, const std::size_t segment_bytes = kDefaultSegmentBytes) noexcept;
+
+  ~SampleLogWriter() noexcept override = default;
+
+  [[nodiscard]] bool is_open(void) const noexcept;
+
+  void define(const std::uint32_t id, std::string_view name) noexcept override;
+
+  void sample(const std::uint64_t  timestamp_ns,
+              const std::uint64_t  count,
+              const std::uint32_t* stack,
+              const std::size_t    depth) noexcept override;
+
+  void flush(void) noexcept override;
+
+  std::uint32_t get_segments(void) const noexcept;
+  std::uint64_t get_bytes(void)    const noexcept;
+  std::uint64_t get_samples(void)  const noexcept;
+  std::uint64_t get_failed(void)   const noexcept;
+};
+
+/**
+ * @brief Decodes a sample log front to back, one mapped segment at a time.
+ *
+ * NAME records are absorbed into the name table as they pass; next() only
+ * surfaces samples. A reader can be given a subset of the segments (every
+ * stride-th one from first) so several readers split one log between them;
+ * each then only sees the names defined in its own segments.
+ */
+class SampleLogReader final
+{
+  std::string                 m_base;
+  std::uint32_t               m_index{0U};
+  std::uint32_t               m_stride{1U};
+  std::uint32_t               m_opened{0U};
+  std::unique_ptr<MappedFile> m_file;
+  const std::uint8_t*         m_cursor{nullptr};
+  const std::uint8_t*         m_end{nullptr};
+  codec::StackDecoder         m_decoder;
+  std::vector<std::string>    m_names;
+  bool                        m_corrupt{false};
+
+  bool m_open_next(void) noexcept;
+
+  bool m_read_name(void) noexcept;
+
+  bool m_read_sample(Sample& out) noexcept;
+
+public:
+  explicit SampleLogReader(std::string path) noexcept;
+
+  SampleLogReader(std::string path, const std::uint32_t first, const std::uint32_t stride) noexcept;
+
+  // Fills out with the next sample; false at the end of the log or on corruption.
+  [[nodiscard]] bool next(Sample& out) noexcept;
+
+  std::string_view name(const std::uint32_t id) const noexcept;
+
+  const std::vector<std::string>& get_names(void) const noexcept;
+
+  bool is_corrupt(void) const noexcept;
+
+  std::uint32_t get_segments(void) const noexcept;
+};
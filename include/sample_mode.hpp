@@ -0,0 +1,12 @@
+/*
+ * Responsibility - Which clock decides that a thread is due for a sample.
+ */
+#pragma once
+
+#include <cstdint>
+
+enum class SampleMode : std::uint8_t
+{
+  WALL,  // Every tick, running or blocked; blocked samples carry their wait as off-CPU time.
+  CPU,   // In proportion to the CPU time each thread used: where CPU time goes.
+};
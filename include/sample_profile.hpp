@@ -0,0 +1,117 @@
+/*
+ * Responsibility - LLVM text sample-profile export for -fprofile-sample-use.
+ */
+#pragma once
+
+#include "file_sink.hpp"
+#include "line_location.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Line-level samples per function, in the shape of LLVM's text
+ *        sample profile (the format llvm-profdata merge --text writes).
+ *
+ *   function:total_samples:head_samples
+ *    offset[.discriminator]: samples [callee:samples]...
+ *
+ * Every frame of a stack credits its own line: the leaf the line it was
+ * executing, each caller its call site, which also records the callee as a
+ * call target. A hot path therefore stays hot all the way up once the
+ * sample loader propagates block weights. Head samples are the entries the
+ * stacks prove: a frame counts as entered when it was not on the previous
+ * stack of the same thread at the same depth, called from the same site.
+ * Calls that begin and return between two samples go unseen, so this is a
+ * lower bound.
+ *
+ * Frames without line info still count towards their function's total but
+ * add no line. The profile is flat: each function once, callers' lines
+ * hold call targets rather than nested inline bodies.
+ */
+class SampleProfile final
+{
+  struct Line final
+  {
+    std::uint64_t                                     samples{0UL};
+    std::unordered_map<std::uint32_t, std::uint64_t> targets;   // callee id -> samples
+  };
+
+  struct Function final
+  {
+    std::uint64_t                            total{0UL};
+    std::uint64_t                            head{0UL};
+    std::unordered_map<std::uint64_t, Line> lines;              // offset << 32 | discriminator
+  };
+
+  struct Previous final
+  {
+    std::vector<std::uint32_t> stack;
+    std::vector<LineLocation>  lines;
+  };
+
+  std::vector<Function>      m_functions;                       // by name id
+  std::vector<Previous>      m_previous;                        // by thread
+  std::uint64_t              m_samples{0UL};
+
+public:
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  SampleProfile() noexcept = default;
+
+  // stack and lines are outermost first, depth entries each; thread is the
+  // Scanner's index of the thread they were sampled on.
+  void add(const std::uint16_t  thread,
+           const std::uint32_t* stack,
+           const LineLocation*  lines,
+           const std::size_t    depth,
+           const std::uint64_t  count) noexcept;
+
+  /**
+   * @brief Writes the profile, hottest function first.
+   *
+   * Functions are keyed by their names as given. LLVM matches them against
+   * linkage names, which is what the Profiler passes for C++ code (see
+   * Scanner::set_linkage_names). Call targets whose names contain
+   * whitespace are left out, since the format separates them by spaces.
+   *
+   * @return kOk, or kIoError when the file cannot be written.
+   */
+  [[nodiscard]] int write(const std::string& path, const std::vector<std::string>& names) const noexcept;
+
+  // Functions with at least one sample.
+  std::size_t   get_functions(void) const noexcept;
+  std::uint64_t get_samples(void)   const noexcept;
+};
+
+/**
+ * @brief Collects a SampleProfile from the Profiler's runs and writes it on
+ *        flush(). Not an ISink: it needs each frame's line as well.
+ */
+class SampleProfileWriter final : public FileSink
+{
+  SampleProfile m_profile;
+
+  [[nodiscard]] bool m_write(void) noexcept override;
+
+  void m_describe(std::ostream& out) const noexcept override;
+
+public:
+  explicit SampleProfileWriter(std::string path) noexcept;
+
+  ~SampleProfileWriter() noexcept override = default;
+
+  void sample(const std::uint16_t  thread,
+              const std::uint64_t  count,
+              const std::uint32_t* stack,
+              const LineLocation*  lines,
+              const std::size_t    depth) noexcept;
+
+  std::size_t   get_functions(void) const noexcept;
+  std::uint64_t get_samples(void)   const noexcept;
+};
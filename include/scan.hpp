@@ -5,13 +5,25 @@
 
 #include "frame.hpp"
 #include "icontext.hpp"
+#include "line_histogram.hpp"
+#include "line_location.hpp"
+#include "metrics.hpp"
 #include "queue.hpp"
+#include "sample_mode.hpp"
 #include "snapshot.hpp"
+#include "threads.hpp"
 #include "trace.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <future>
 #include <iostream>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #if defined(_WIN32) || defined(__CYGWIN__)
   #include <windows.h>
@@ -19,15 +31,81 @@
 
 class Scanner final
 {
+  // A sampled thread and its pending run; index 0 is always the target.
+  struct Thread final
+  {
+    HANDLE        handle{nullptr};
+    std::uint32_t id{0U};
+    std::string   name;
+    Frame         run{};
+    bool          has_run{false};
+    bool          named{false};  // name already sent along with a run
+    bool          alive{true};
+    std::uint64_t cpu{0UL};         // CPU time at the last check, platform units
+    std::uint64_t cpu_checked_ns{0UL};
+    bool          cpu_known{false};
+    double        cpu_credit{0.0};  // SampleMode::CPU: samples earned, not yet taken
+    std::uint64_t sampled_at{0UL};  // timestamp of the last capture, 0 before it
+  };
+
+  // Re-enumerate every this many scans, or right after a failed capture.
+  static constexpr std::uint64_t kRefreshScans = 64UL;
+
+  // Runs pushed per scan() once the target is done; keeps a frame buffer
+  // that is drained between scans from overflowing.
+  static constexpr std::size_t kFlushBatch = 16UL;
+
+  // SampleMode::WALL tags a sample off-CPU when the thread ran for less
+  // than this share of the time since its previous check.
+  static constexpr double kBlockedShare = 0.5;
+
+  // Thread indices travel as 16-bit values in Frame and Event.
+  static constexpr std::size_t kMaxThreads = 0xFFFFUL;
+
   HANDLE                  m_th;
   std::future<void>       m_done;
   std::thread             m_worker;
   std::promise<HANDLE>    m_th_promise;
   std::future<HANDLE>     m_th_future = m_th_promise.get_future();
   Queue<Frame, 64UL>      m_frame_buffer;
+  std::vector<Thread>     m_threads;
+  std::unordered_map<std::uint32_t, std::size_t> m_thread_index;  // live thread id -> index
+  std::vector<std::size_t> m_exited;      // exited threads with a pending run
+  std::vector<std::uint32_t> m_ignored;
+  std::mutex              m_ignored_mutex;
+  std::atomic<bool>       m_ignored_changed{false};
+  std::uint32_t           m_owner{0U};   // the thread that built the Scanner
+  std::size_t             m_cursor{0UL};
+  std::uint64_t           m_scans{0UL};
+  bool                    m_stale{true};
   IContext*               m_context{nullptr};
+  Metrics*                m_metrics{nullptr};
+  LineHistogram*          m_line_histogram{nullptr};
+  bool                    m_line_offsets{false};
+  bool                    m_linkage_names{false};
+  bool                    m_all_threads{false};
+  bool                    m_thread_roots{true};
+  SampleMode              m_sample_mode{SampleMode::WALL};
+  double                  m_cpu_per_ns{0.0};  // thread_cpu_time() units per ns; 0 if unknown
   std::shared_ptr<pace::ITrace> m_trace{nullptr};
 
+  void m_flush_run(Thread& thread) noexcept;
+
+  [[nodiscard]] bool m_flush_runs(const std::size_t limit) noexcept;
+
+  void m_refresh_threads(void) noexcept;
+
+  std::size_t m_next_thread(void) noexcept;
+
+  // Sets share to the part of the wall time since thread was last checked
+  // that it spent on a CPU, in [0, 1]. False when that is unknown: its CPU
+  // time cannot be read, or there was no earlier check to measure from.
+  [[nodiscard]] bool m_cpu_share(Thread& thread, double& share) noexcept;
+
+  void m_record_scan(const std::uint64_t begin) const noexcept;
+
+  static LineLocation m_line_location(const pace::Frame& frame) noexcept;
+
 public:
   template <class T>
   Scanner(T&& target) noexcept;
@@ -40,6 +118,61 @@ public:
   Queue<Frame, 64UL>* get_frame_buffer(void) noexcept;
 
   void set_context(IContext* context) noexcept;
+
+  void set_metrics(Metrics* metrics) noexcept;
+
+  // Also resolve where in its function each frame is, into Frame::lines.
+  // Costs one more symbol lookup per frame. Set before scanning starts.
+  void set_line_offsets(const bool enabled) noexcept;
+
+  // Also keep each frame's linkage (mangled) name, into Frame::linkage, and
+  // tell runs apart by it. Set before scanning starts.
+  void set_linkage_names(const bool enabled) noexcept;
+
+  // Counts every sample's leaf PC into histogram. Set before scanning starts.
+  void set_line_histogram(LineHistogram* histogram) noexcept;
+
+  // Symbolizes the histogram's new PCs; call once sampling has stopped.
+  void resolve_lines(void) noexcept;
+
+  /**
+   * @brief Samples every thread of the process instead of only the target.
+   *
+   * Each scan() captures one thread, round-robin over the live ones, so the
+   * cost per tick stays that of one capture however many threads there are;
+   * each thread is sampled at rate / threads. New and exited threads are
+   * picked up every kRefreshScans scans. The scanning thread, the thread that
+   * built the Scanner and any thread that called ignore_current_thread() are
+   * never sampled. With thread_roots every stack is rooted at a "[name]"
+   * frame, which splits every profile per thread under the merged total.
+   * Set before scanning starts.
+   */
+  void set_all_threads(const bool enabled, const bool thread_roots = true) noexcept;
+
+  // Keeps the calling thread (a profiler-owned one) out of set_all_threads().
+  void ignore_current_thread(void) noexcept;
+
+  /**
+   * @brief Chooses what a tick samples.
+   *
+   * Both modes measure the share of the time since a thread's last check
+   * that it spent running. WALL captures the thread whatever it is doing
+   * and tags a sample off-CPU when that share is below kBlockedShare,
+   * crediting it with the rest of the interval as time blocked. CPU adds
+   * the share to a credit and captures once that adds up to a whole
+   * sample, weighted by the whole samples earned, so samples follow CPU
+   * time. A thread whose share is unknown is captured untagged. Set
+   * before scanning starts.
+   */
+  void set_sample_mode(const SampleMode mode) noexcept;
+
+  // Captures copy the top bytes of the stack and unwind the copy after the
+  // thread runs again (see ITrace::set_stack_copy); 0 unwinds in place.
+  // Set before scanning starts.
+  void set_stack_copy(const std::size_t bytes) noexcept;
+
+  // Threads found so far, exited ones and the target included.
+  std::size_t get_threads(void) const noexcept;
 };
 
 template <class T>
@@ -88,4 +221,20 @@ Scanner::Scanner(T&& target) noexcept
     m_worker.join();
     exit(EXIT_FAILURE);
   }
+
+  Thread first;
+  first.handle = m_th;
+  first.name   = "target";
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  first.id = static_cast<std::uint32_t>(::GetThreadId(m_th));
+#endif
+
+  m_cpu_per_ns = pace::cpu_time_per_ns();
+
+  double share = 0.0;
+  (void)m_cpu_share(first, share);
+
+  m_threads.push_back(std::move(first));
+  m_owner = pace::current_thread_id();
 }
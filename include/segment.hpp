@@ -0,0 +1,112 @@
+/*
+ * Responsibility - Memory-mapped, size-capped file segments for append-only logs.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  #include <windows.h>
+#endif
+
+/**
+ * @brief Appends bytes to <base>.0000, <base>.0001, ... through writable
+ *        file mappings.
+ *
+ * Each segment is sized up front and mapped shared, so appending is a
+ * memcpy into the page cache: nothing passes through stdio, and whatever was
+ * written survives a crash of the process (the kernel owns the pages). A
+ * segment is rolled over when the next record does not fit and is trimmed to
+ * its used length when closed. Never-written tail bytes read back as zero.
+ *
+ * Every segment starts with kHeaderBytes: the 8-byte magic, a little-endian
+ * u32 format version and the u32 segment index.
+ */
+class SegmentWriter final
+{
+  std::string   m_base;
+  std::size_t   m_segment_bytes;
+  std::uint32_t m_version;
+  std::uint32_t m_index{0U};
+  std::uint8_t* m_data{nullptr};
+  std::size_t   m_used{0UL};
+  std::uint64_t m_total{0UL};
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  HANDLE        m_file{INVALID_HANDLE_VALUE};
+  HANDLE        m_mapping{nullptr};
+#else
+  int           m_fd{-1};
+#endif
+
+  bool m_open_next(void) noexcept;
+
+  void m_close_current(void) noexcept;
+
+public:
+  static constexpr char        kMagic[8]    = {'P', 'A', 'C', 'E', 'L', 'O', 'G', '\0'};
+  static constexpr std::size_t kHeaderBytes = 16UL;
+
+  /**
+   * @param base          Path prefix; segment i is written to segment_path(base, i).
+   * @param segment_bytes Size cap of one segment, header included.
+   * @param version       Format version stamped into every header.
+   */
+  SegmentWriter(std::string base, const std::size_t segment_bytes, const std::uint32_t version) noexcept;
+
+  ~SegmentWriter() noexcept;
+
+  SegmentWriter(const SegmentWriter&)            = delete;
+  SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+  [[nodiscard]] bool is_open(void) const noexcept;
+
+  /**
+   * @brief Room for n contiguous bytes, rolling to a new segment if needed.
+   *
+   * @return nullptr if n can never fit in a segment or the file cannot be
+   *         created. The bytes become part of the log on commit(n).
+   */
+  [[nodiscard]] std::uint8_t* reserve(const std::size_t n) noexcept;
+
+  void commit(const std::size_t n) noexcept;
+
+  // Starts write-back of everything committed so far without waiting for it.
+  void flush(void) noexcept;
+
+  std::uint32_t get_segments(void) const noexcept;
+  std::uint64_t get_bytes(void)    const noexcept;
+
+  static std::string segment_path(const std::string& base, const std::uint32_t index) noexcept;
+};
+
+/**
+ * @brief Read-only mapping of a whole file.
+ */
+class MappedFile final
+{
+  const std::uint8_t* m_data{nullptr};
+  std::size_t         m_size{0UL};
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  HANDLE              m_file{INVALID_HANDLE_VALUE};
+  HANDLE              m_mapping{nullptr};
+#else
+  int                 m_fd{-1};
+#endif
+
+public:
+  explicit MappedFile(const std::string& path) noexcept;
+
+  ~MappedFile() noexcept;
+
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  [[nodiscard]] bool is_open(void) const noexcept;
+
+  const std::uint8_t* data(void) const noexcept;
+  std::size_t         size(void) const noexcept;
+};
@@ -0,0 +1,76 @@
+/*
+ * Responsibility - Aggregating samples by full stack in a flat hash table.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Distinct stacks with their summed sample counts.
+ *
+ * Open addressing keyed by a 128-bit hash of the frame ids. Two stacks are
+ * taken to be equal when their hashes and depths match: with 2^-128 odds of a
+ * false match the frames need not be compared, so a lookup touches a single
+ * slot (count included) and never the frames. Those live back to back in
+ * one vector and are only read for output. Tables built on different threads
+ * are combined with merge().
+ */
+class StackTable final
+{
+  struct Hash final
+  {
+    std::uint64_t low;
+    std::uint64_t high;
+  };
+
+  struct Slot final
+  {
+    Hash          hash;
+    std::uint64_t count;   // 0 when empty
+    std::size_t   offset;
+    std::size_t   depth;
+  };
+
+  std::vector<Slot>          m_slots;
+  std::vector<std::uint32_t> m_frames;
+  std::size_t                m_size{0UL};
+  std::size_t                m_last{0UL};  // slot of the last add()
+  std::uint64_t              m_samples{0UL};
+
+  static Hash m_hash(const std::uint32_t* stack, const std::size_t depth) noexcept;
+
+  void m_grow(void) noexcept;
+
+public:
+  StackTable() noexcept;
+
+  void add(const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept;
+
+  // Adds count to the stack of the last add() without looking it up again.
+  void repeat(const std::uint64_t count) noexcept;
+
+  // Samples recorded for stack, 0 if it was never added.
+  [[nodiscard]] std::uint64_t count(const std::uint32_t* stack, const std::size_t depth) const noexcept;
+
+  void merge(const StackTable& other) noexcept;
+
+  void clear(void) noexcept;
+
+  // visit(const std::uint32_t* stack, std::size_t depth, std::uint64_t count) per distinct stack.
+  template <typename F>
+  void for_each(F&& visit) const noexcept
+  {
+    for (const Slot& slot : m_slots)
+    {
+      if (slot.count > 0UL)
+      {
+        visit(m_frames.data() + slot.offset, slot.depth, slot.count);
+      }
+    }
+  }
+
+  std::size_t   size(void)        const noexcept;
+  std::uint64_t get_samples(void) const noexcept;
+};
@@ -0,0 +1,205 @@
+/*
+ * Responsibility - Enumerating and naming the threads of this process.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  #include <windows.h>
+  #include <tlhelp32.h>
+#else
+  #include <dirent.h>
+  #include <fstream>
+  #include <unistd.h>
+#endif
+
+namespace pace
+{
+  struct ThreadInfo final
+  {
+    std::uint32_t id{0U};
+    std::string   name;  // empty when the thread was never named
+  };
+
+  // Windows: Toolhelp snapshot plus GetThreadDescription where the OS has
+  // it. Elsewhere: /proc/self/task and each task's comm.
+  inline std::vector<ThreadInfo> list_threads(void) noexcept
+  {
+    std::vector<ThreadInfo> threads;
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+    using GetThreadDescriptionFn = HRESULT (WINAPI*)(HANDLE, PWSTR*);
+
+    // Windows 10 1607 and later only, so looked up rather than linked.
+    static const auto get_description = reinterpret_cast<GetThreadDescriptionFn>(
+      reinterpret_cast<void*>(::GetProcAddress(::GetModuleHandleA("kernel32.dll"), "GetThreadDescription")));
+
+    const HANDLE snapshot = ::CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+
+    if (snapshot == INVALID_HANDLE_VALUE)
+    {
+      return threads;
+    }
+
+    const DWORD   process = ::GetCurrentProcessId();
+    THREADENTRY32 entry{};
+    entry.dwSize = sizeof(entry);
+
+    for (BOOL ok = ::Thread32First(snapshot, &entry); ok; ok = ::Thread32Next(snapshot, &entry))
+    {
+      if (entry.th32OwnerProcessID != process)
+      {
+        continue;
+      }
+
+      ThreadInfo info;
+      info.id = static_cast<std::uint32_t>(entry.th32ThreadID);
+
+      if (get_description != nullptr)
+      {
+        const HANDLE th = ::OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+        PWSTR        description = nullptr;
+
+        if (th != nullptr && SUCCEEDED(get_description(th, &description)) && description != nullptr)
+        {
+          char      utf8[256];
+          const int n = ::WideCharToMultiByte(CP_UTF8, 0, description, -1, utf8, sizeof(utf8), nullptr, nullptr);
+
+          if (n > 1)
+          {
+            info.name.assign(utf8, static_cast<std::size_t>(n - 1));
+          }
+
+          (void)::LocalFree(description);
+        }
+
+        if (th != nullptr)
+        {
+          (void)::CloseHandle(th);
+        }
+      }
+
+      threads.push_back(std::move(info));
+    }
+
+    (void)::CloseHandle(snapshot);
+#else
+    DIR* tasks = ::opendir("/proc/self/task");
+
+    if (tasks == nullptr)
+    {
+      return threads;
+    }
+
+    while (const dirent* task = ::readdir(tasks))
+    {
+      if (task->d_name[0] < '0' || task->d_name[0] > '9')
+      {
+        continue;
+      }
+
+      ThreadInfo info;
+      info.id = static_cast<std::uint32_t>(std::strtoul(task->d_name, nullptr, 10));
+
+      std::ifstream comm(std::string("/proc/self/task/") + task->d_name + "/comm");
+      std::getline(comm, info.name);
+
+      threads.push_back(std::move(info));
+    }
+
+    (void)::closedir(tasks);
+#endif
+
+    return threads;
+  }
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  // CPU consumed by thread so far, in cycles (QueryThreadCycleTime). Only
+  // deltas mean anything; GetThreadTimes would do in ns, but it only moves
+  // once per scheduler tick, too coarse to tell whether a thread ran
+  // between two samples.
+  inline bool thread_cpu_time(const HANDLE thread, std::uint64_t& out) noexcept
+  {
+    ULONG64 cycles = 0;
+
+    if (!::QueryThreadCycleTime(thread, &cycles))
+    {
+      return false;
+    }
+
+    out = static_cast<std::uint64_t>(cycles);
+    return true;
+  }
+
+  // thread_cpu_time() units per nanosecond, 0 if unknown. Cycles have no
+  // documented rate, so this spins the calling thread for a millisecond and
+  // compares its cycles with the wall time: call it once, up front.
+  inline double cpu_time_per_ns(void) noexcept
+  {
+    using SteadyClock = std::chrono::steady_clock;
+
+    const HANDLE  self  = ::GetCurrentThread();
+    std::uint64_t begin = 0UL;
+    std::uint64_t end   = 0UL;
+    const auto    t0    = SteadyClock::now();
+
+    if (!thread_cpu_time(self, begin))
+    {
+      return 0.0;
+    }
+
+    while ((SteadyClock::now() - t0) < std::chrono::milliseconds(1))
+    {
+    }
+
+    const auto t1 = SteadyClock::now();
+
+    if (!thread_cpu_time(self, end) || end <= begin)
+    {
+      return 0.0;
+    }
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+    return (ns > 0) ? (static_cast<double>(end - begin) / static_cast<double>(ns)) : 0.0;
+  }
+#else
+  // CPU consumed by thread id so far, in ns: the first field of its
+  // schedstat, which is what CLOCK_THREAD_CPUTIME_ID reads for that thread
+  // without needing its pthread_t.
+  inline bool thread_cpu_time(const std::uint32_t id, std::uint64_t& out) noexcept
+  {
+    std::ifstream schedstat("/proc/self/task/" + std::to_string(id) + "/schedstat");
+    unsigned long long ns = 0ULL;
+
+    if (!(schedstat >> ns))
+    {
+      return false;
+    }
+
+    out = static_cast<std::uint64_t>(ns);
+    return true;
+  }
+
+  // schedstat counts nanoseconds.
+  inline double cpu_time_per_ns(void) noexcept
+  {
+    return 1.0;
+  }
+#endif
+
+  inline std::uint32_t current_thread_id(void) noexcept
+  {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return static_cast<std::uint32_t>(::GetCurrentThreadId());
+#else
+    return static_cast<std::uint32_t>(::gettid());
+#endif
+  }
+} // namespace pace
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "clock.hpp"
 #include "trie.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -23,6 +25,7 @@
 #include <dbghelp.h>
 
 #if defined(__CYGWIN__)
+  #include <cxxabi.h>
   #include <pthread.h>
 #endif
 
@@ -42,22 +45,59 @@ namespace pace
       std::string    module;
       std::string    file;
       std::uint32_t  line{};
+      std::uint32_t  function_line{};  // first line of the function; 0 unless CaptureFlags::LineOffsets
       std::uintptr_t offset{};
+      std::string    linkage;          // mangled name; empty unless CaptureFlags::LinkageNames
     };
   } // namespace
 
   class ITrace
   {
+  public:
+    // What the last capture() cost, in nanoseconds.
+    struct CaptureStats final
+    {
+      std::uint64_t suspend_ns{0UL};    // target thread was stopped
+      std::uint64_t symbolize_ns{0UL};  // spent resolving names
+    };
+
   protected:
+    CaptureStats m_stats{};
+
     ITrace() noexcept = default;
 
   public:
     virtual ~ITrace() noexcept = default;
 
+    const CaptureStats& get_last_stats(void) const noexcept
+    {
+      return m_stats;
+    }
+
     virtual  inline std::vector<Frame> capture(HANDLE,
                                                std::size_t,
                                                std::size_t,
                                                std::uint32_t = 0U) noexcept = 0;
+
+    // Resolves one address to function, file and line after the fact, for
+    // PCs kept by capture() callers. False when nothing is known about it.
+    virtual bool symbolize(std::uintptr_t, Frame&) noexcept
+    {
+      return false;
+    }
+
+    // Makes capture() copy the registers and the top bytes of the stack
+    // while the thread is stopped, and unwind that copy once it runs again;
+    // 0 unwinds the stopped thread in place. False when not supported.
+    virtual bool set_stack_copy(std::size_t) noexcept
+    {
+      return false;
+    }
+
+    // Drops what capture() keeps about thread id. Call once the thread has
+    // exited and before its last handle is closed, while the id cannot yet
+    // name a new thread.
+    virtual void forget_thread(std::uint32_t) noexcept {}
   };
 
   class ITraceFactory
@@ -90,6 +130,122 @@ namespace pace
 
   class WindowsTrace final : public ITrace
   {
+    // A stack copied while its thread was stopped, and the reservation it
+    // came from: the rest of that memory has moved on since.
+    struct StackCopy final
+    {
+      DWORD64             base{0};  // the stopped thread's stack pointer
+      const std::uint8_t* data{nullptr};
+      std::size_t         size{0UL};
+      DWORD64             low{0};
+      DWORD64             high{0};
+    };
+
+    // A thread's stack reservation, which does not move while it lives.
+    struct StackBounds final
+    {
+      DWORD   id{0};  // 0: empty
+      DWORD64 low{0};
+      DWORD64 high{0};
+    };
+
+    // Direct-mapped by thread id. Prime, so ids that come in steps of four
+    // still spread over every entry.
+    static constexpr std::size_t kStackBoundsSlots = 251UL;
+
+    std::vector<std::uint8_t> m_stack_copy;  // the preallocated slot; empty: unwind in place
+
+    // Learned on a thread's first copy so later ones skip VirtualQuery, and
+    // allocated with the slot so a stopped thread's copy never allocates.
+    // Two threads sharing an entry take turns querying; a stack pointer
+    // outside the cached bounds is queried again.
+    std::vector<StackBounds> m_stack_bounds;
+
+    StackBounds& bounds_entry(const DWORD id) noexcept
+    {
+      return m_stack_bounds[id % kStackBoundsSlots];
+    }
+
+    // StackWalk64 hands its read routine no context, so the copy being
+    // walked is found through this.
+    static inline thread_local const StackCopy* t_stack_copy = nullptr;
+
+    // Stack reads come from the copy; reads of code and unwind data from
+    // the live process.
+    static BOOL CALLBACK read_copied_stack(HANDLE process, DWORD64 address, PVOID buffer, DWORD size, LPDWORD read) noexcept
+    {
+      const StackCopy* copy = t_stack_copy;
+      const DWORD64    end  = address + size;
+
+      if (copy != nullptr && address < copy->high && end > copy->low)
+      {
+        if (address < copy->base || end > copy->base + copy->size)
+        {
+          return FALSE;  // beyond what was copied
+        }
+
+        std::memcpy(buffer, copy->data + (address - copy->base), size);
+
+        if (read != nullptr)
+        {
+          *read = size;
+        }
+
+        return TRUE;
+      }
+
+      SIZE_T     n  = 0;
+      const BOOL ok = ::ReadProcessMemory(process, reinterpret_cast<LPCVOID>(address), buffer, size, &n);
+
+      if (read != nullptr)
+      {
+        *read = static_cast<DWORD>(n);
+      }
+
+      return ok;
+    }
+
+    // Copies from the stack pointer up to the slot size or the top of the
+    // stack, whichever comes first. Runs with the thread stopped, so it
+    // must not allocate.
+    inline bool copy_stack(const CONTEXT& ctx, const DWORD id, StackCopy& copy) noexcept
+    {
+  #if defined(_M_X64) || defined(__x86_64__)
+      const DWORD64 sp = static_cast<DWORD64>(ctx.Rsp);
+  #else
+      const DWORD64 sp = static_cast<DWORD64>(ctx.Esp);
+  #endif
+
+      StackBounds& bounds = bounds_entry(id);
+
+      if (bounds.id != id || sp < bounds.low || sp >= bounds.high)
+      {
+        MEMORY_BASIC_INFORMATION region{};
+
+        if (::VirtualQuery(reinterpret_cast<LPCVOID>(sp), &region, sizeof(region)) == 0)
+        {
+          bounds = StackBounds{};
+          return false;
+        }
+
+        bounds.id   = id;
+        bounds.low  = reinterpret_cast<DWORD64>(region.AllocationBase);
+        bounds.high = reinterpret_cast<DWORD64>(region.BaseAddress) + static_cast<DWORD64>(region.RegionSize);
+      }
+
+      const std::size_t size = static_cast<std::size_t>(std::min<DWORD64>(m_stack_copy.size(), bounds.high - sp));
+
+      std::memcpy(m_stack_copy.data(), reinterpret_cast<const void*>(sp), size);
+
+      copy.base = sp;
+      copy.data = m_stack_copy.data();
+      copy.size = size;
+      copy.low  = bounds.low;
+      copy.high = bounds.high;
+
+      return true;
+    }
+
   public:
     struct FilterDB final
     {
@@ -154,6 +310,8 @@ namespace pace
       FilterSTL         = 1u << 0,
       KeepExeOnly       = 1u << 1,
       FilterConventions = 1u << 2,
+      LineOffsets       = 1u << 3,  // also resolve each function's first line
+      LinkageNames      = 1u << 4,  // also keep each function's mangled name
     };
 
      inline std::string strip_trailing_newlines(std::string s) noexcept
@@ -322,8 +480,10 @@ namespace pace
       if (ready) return;
       ready = true;
 
+      // Names come back decorated so linkage names can be kept; display
+      // names are undecorated in symbolize_dbghelp instead.
       HANDLE proc = ::GetCurrentProcess();
-      ::SymSetOptions(SYMOPT_DEFERRED_LOADS | SYMOPT_UNDNAME | SYMOPT_LOAD_LINES);
+      ::SymSetOptions(SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
       (void)::SymInitialize(proc, nullptr, TRUE);
     }
 
@@ -344,10 +504,29 @@ namespace pace
       return dup; // caller must CloseHandle()
     }
 
+    // MSVC-decorated names ("?...") as SYMOPT_UNDNAME would show them;
+    // anything else is returned as is.
+     inline std::string undecorate(const char* name) noexcept
+    {
+      if (name[0] != '?')
+        return name;
+
+      char buf[1024];
+      if (::UnDecorateSymbolName(name, buf, static_cast<DWORD>(sizeof(buf)), UNDNAME_NAME_ONLY) == 0)
+        return name;
+
+      return buf;
+    }
+
     // ----------------------------------------------
     // DbgHelp symbolization: function/module/file/line
     // ----------------------------------------------
-     inline void symbolize_dbghelp(HANDLE proc, DWORD64 pc, Frame& f) noexcept
+    // line_pc is where the line is looked up: a caller's return address can
+    // already belong to the next line, so callers pass pc - 1. With
+    // function_line set, the first line of the function is resolved too;
+    // with linkage set, the decorated name is kept in f.linkage.
+     inline void symbolize_dbghelp(HANDLE proc, DWORD64 pc, Frame& f, DWORD64 line_pc = 0, bool function_line = false,
+                                   bool linkage = false) noexcept
     {
       ensure_symbols_initialized();
 
@@ -364,8 +543,20 @@ namespace pace
         if (::SymFromAddr(proc, pc, &disp, si))
         {
           // In w32api headers, Name is a fixed array (never null).
-          f.function = (si->Name[0] != '\0') ? si->Name : "<unknown>";
+          f.function = (si->Name[0] != '\0') ? undecorate(si->Name) : "<unknown>";
           f.offset   = static_cast<std::uintptr_t>(disp);
+
+          if (linkage && si->Name[0] != '\0')
+            f.linkage = si->Name;
+
+          IMAGEHLP_LINE64 first{};
+          first.SizeOfStruct = sizeof(first);
+
+          DWORD first_disp = 0;
+          if (function_line && ::SymGetLineFromAddr64(proc, si->Address, &first_disp, &first))
+          {
+            f.function_line = static_cast<std::uint32_t>(first.LineNumber);
+          }
         }
         else
         {
@@ -391,7 +582,7 @@ namespace pace
         line.SizeOfStruct = sizeof(line);
 
         DWORD disp32 = 0;
-        if (::SymGetLineFromAddr64(proc, pc, &disp32, &line))
+        if (::SymGetLineFromAddr64(proc, (line_pc != 0) ? line_pc : pc, &disp32, &line))
         {
           if (line.FileName) f.file = line.FileName;
           f.line = static_cast<std::uint32_t>(line.LineNumber);
@@ -431,14 +622,15 @@ namespace pace
     }
 
      inline std::string addr2line_query(const std::string& module_posix,
-                                              std::uintptr_t addr) noexcept
+                                              std::uintptr_t addr,
+                                              bool demangle = true) noexcept
     {
       char addr_buf[32];
       std::snprintf(addr_buf, sizeof(addr_buf), "0x%llx",
                     static_cast<unsigned long long>(addr));
 
       // -f function, -C demangle, -p pretty, -i inline frames (we keep last line)
-      std::string cmd = "bash -c \"addr2line -f -C -p -i -e ";
+      std::string cmd = demangle ? "bash -c \"addr2line -f -C -p -i -e " : "bash -c \"addr2line -f -p -i -e ";
       cmd += escape_for_bash_single_quotes(module_posix);
       cmd += " ";
       cmd += addr_buf;
@@ -538,8 +730,24 @@ namespace pace
     }
 
   #if defined(__CYGWIN__)
+    // What addr2line -C prints for a mangled name.
+     inline std::string demangle(const std::string& name) noexcept
+    {
+      int   status    = 0;
+      char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+
+      if (demangled == nullptr)
+        return name;
+
+      std::string out(demangled);
+      std::free(demangled);
+      return out;
+    }
+
     // --- UPDATED: symbolize_addr2line now fills function/file/line cleanly ---
-     inline void symbolize_addr2line(Frame& f) noexcept
+    // With linkage set, names are queried mangled, kept in f.linkage and
+    // demangled here, so one addr2line run gives both.
+     inline void symbolize_addr2line(Frame& f, bool linkage = false) noexcept
     {
       std::uintptr_t base = 0;
       std::string module_posix;
@@ -552,10 +760,10 @@ namespace pace
       const std::uintptr_t abs = f.pc;
       const std::uintptr_t rel = (base && abs >= base) ? (abs - base) : abs;
 
-      std::string out = addr2line_query(module_posix, rel);
+      std::string out = addr2line_query(module_posix, rel, !linkage);
       if (out.empty() || looks_unknown_addr2line(out))
       {
-        std::string out2 = addr2line_query(module_posix, abs);
+        std::string out2 = addr2line_query(module_posix, abs, !linkage);
         if (!out2.empty() && !looks_unknown_addr2line(out2))
           out = std::move(out2);
       }
@@ -567,7 +775,12 @@ namespace pace
       std::uint32_t line = 0;
       parse_addr2line_pretty(out, func, file, line);
 
-      if (!func.empty())
+      if (!func.empty() && linkage)
+      {
+        f.function = demangle(func);
+        f.linkage  = std::move(func);
+      }
+      else if (!func.empty())
         f.function = std::move(func);
 
       if (!file.empty() && file != "??")
@@ -578,13 +791,62 @@ namespace pace
     }
   #endif
 
+     inline bool symbolize(std::uintptr_t pc, Frame& f) noexcept override
+    {
+      f    = Frame{};
+      f.pc = pc;
+
+      symbolize_dbghelp(::GetCurrentProcess(), static_cast<DWORD64>(pc), f);
+
+  #if defined(__CYGWIN__)
+      if (f.function.empty() || f.function == "<unknown>" || f.line == 0)
+        symbolize_addr2line(f);
+  #endif
+
+      return !f.function.empty() && f.function != "<unknown>";
+    }
+
+    bool set_stack_copy(const std::size_t bytes) noexcept override
+    {
+      m_stack_copy.assign(bytes, 0U);
+      m_stack_copy.shrink_to_fit();
+      m_stack_bounds.assign((bytes > 0UL) ? kStackBoundsSlots : 0UL, StackBounds{});
+      return true;
+    }
+
+    void forget_thread(const std::uint32_t id) noexcept override
+    {
+      if (m_stack_bounds.empty())
+      {
+        return;
+      }
+
+      StackBounds& bounds = bounds_entry(static_cast<DWORD>(id));
+
+      if (bounds.id == static_cast<DWORD>(id))
+      {
+        bounds = StackBounds{};
+      }
+    }
+
     // ----------------------------------------------
     // Capture stack from another thread (suspend + context + StackWalk64)
     //
+    // With set_stack_copy() the thread only stays stopped for its context
+    // and a memcpy of the top of its stack; the walk then runs on the copy,
+    // so frames deeper than the copy are lost.
+    //
     // th must be a REAL thread handle with:
     //   THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION
     //
     // skip: number of walked frames to skip AFTER StackWalk has begun (not including capture()).
+    //
+    // On x64 the walk needs no frame pointers: StackWalk64 unwinds through
+    // the .pdata tables that SymFunctionTableAccess64 hands it, so code
+    // built without them keeps its full stack. compile.bat still passes
+    // -fno-omit-frame-pointer for 32-bit x86, which has no such tables,
+    // and -fno-optimize-sibling-calls, because a frame a tail call
+    // replaced is gone from the stack for any unwinder.
     // ----------------------------------------------
      inline std::vector<Frame> capture(HANDLE th,
                                              std::size_t skip = 0,
@@ -596,6 +858,8 @@ namespace pace
       std::vector<Frame> out;
       out.reserve(max_frames);
 
+      m_stats = {};
+
       if (!th || th == INVALID_HANDLE_VALUE)
       {
         std::cerr << "[stacktrace] invalid thread handle\n";
@@ -604,6 +868,8 @@ namespace pace
 
       ensure_symbols_initialized();
 
+      const DWORD id = ::GetThreadId(th);
+
       ::SetLastError(0);
       DWORD prev = ::SuspendThread(th);
       if (prev == static_cast<DWORD>(-1))
@@ -614,9 +880,26 @@ namespace pace
 
       struct ResumeGuard
       {
-        HANDLE t{};
-        ~ResumeGuard() { (void)::ResumeThread(t); }
-      } guard{th};
+        HANDLE         t{};
+        std::uint64_t  begin{};
+        std::uint64_t* suspend_ns{};
+        bool           resumed{false};
+
+        void resume()
+        {
+          if (!resumed)
+          {
+            resumed = true;
+            (void)::ResumeThread(t);
+            *suspend_ns = (Clock::now_ns() - begin);
+          }
+        }
+
+        ~ResumeGuard()
+        {
+          resume();
+        }
+      } guard{th, Clock::now_ns(), &m_stats.suspend_ns};
 
       CONTEXT ctx{};
       ctx.ContextFlags = CONTEXT_FULL;
@@ -626,6 +909,19 @@ namespace pace
         return out;
       }
 
+      StackCopy copy{};
+
+      if (!m_stack_copy.empty())
+      {
+        if (!copy_stack(ctx, id, copy))
+        {
+          std::cerr << "[stacktrace] VirtualQuery failed: " << ::GetLastError() << "\n";
+          return out;
+        }
+
+        guard.resume();
+      }
+
       HANDLE proc = ::GetCurrentProcess();
 
       STACKFRAME64 frame{};
@@ -651,6 +947,8 @@ namespace pace
 
       std::size_t walked = 0;
 
+      t_stack_copy = (copy.data != nullptr) ? &copy : nullptr;
+
       // Walk frames
       while (out.size() < max_frames)
       {
@@ -659,7 +957,7 @@ namespace pace
                                 th,
                                 &frame,
                                 &ctx,
-                                nullptr,
+                                (copy.data != nullptr) ? read_copied_stack : nullptr,
                                 ::SymFunctionTableAccess64,
                                 ::SymGetModuleBase64,
                                 nullptr);
@@ -670,19 +968,27 @@ namespace pace
         if (walked++ < skip)
           continue;
 
+        const DWORD64 pc = static_cast<DWORD64>(frame.AddrPC.Offset);
+
         Frame f{};
-        f.pc = static_cast<std::uintptr_t>(frame.AddrPC.Offset);
+        f.pc = static_cast<std::uintptr_t>(pc);
 
-        // 1) DbgHelp first: good for OS dll exports
-        symbolize_dbghelp(proc, static_cast<DWORD64>(frame.AddrPC.Offset), f);
+        const std::uint64_t symbolize_begin = Clock::now_ns();
+
+        // 1) DbgHelp first: good for OS dll exports; only the first walked
+        //    frame is not at a return address
+        symbolize_dbghelp(proc, pc, f, (walked > 1) ? (pc - 1) : pc, (flags & CaptureFlags::LineOffsets) != 0u,
+                          (flags & CaptureFlags::LinkageNames) != 0u);
 
   #if defined(__CYGWIN__)
         // 2) addr2line: fixes your EXE / DWARF modules (try rel+abs)
         // Only override if still unknown-ish.
         if (f.function.empty() || f.function == "<unknown>")
-          symbolize_addr2line(f);
+          symbolize_addr2line(f, (flags & CaptureFlags::LinkageNames) != 0u);
   #endif
 
+        m_stats.symbolize_ns += (Clock::now_ns() - symbolize_begin);
+
         if ((flags & CaptureFlags::KeepExeOnly) != 0u)
         {
           if (!is_exe_frame(f))
@@ -704,6 +1010,8 @@ namespace pace
         out.push_back(std::move(f));
       }
 
+      t_stack_copy = nullptr;
+
       if (out.empty())
         std::cerr << "[stacktrace] StackWalk64 produced 0 frames\n";
 
@@ -5,10 +5,12 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 template <std::size_t BucketCapacity = 64UL>
 class HATTrie
@@ -71,12 +73,21 @@ protected:
 
     Node() noexcept : is_end(false), bucket(std::make_unique<BucketMap>()), children() {}
 
+    explicit Node(const bool with_bucket) noexcept
+      : is_end(false),
+        bucket(with_bucket ? std::make_unique<BucketMap>() : nullptr),
+        children() {}
+
     [[nodiscard]] bool is_bucket(void) const noexcept
     {
       return (bucket != nullptr);
     }
   };
 
+  // Bulk-loaded buckets are left partially empty so probes still hit an
+  // EMPTY slot early and later inserts do not split straight away.
+  static constexpr std::size_t kBulkLoad = ((BucketCapacity * 7UL) / 8UL);
+
   std::unique_ptr<Node> m_root;
 
   [[nodiscard]] static inline std::size_t idx(unsigned char c) noexcept
@@ -124,6 +135,50 @@ protected:
     // Note: old is destroyed here; its strings are copied into child buckets.
   }
 
+  // Lays out [lo, hi) (sorted, unique, sharing the first depth bytes) in one
+  // depth-first pass; nodes are allocated in the order lookups visit them.
+  static std::unique_ptr<Node> m_build(const std::string_view* lo,
+                                       const std::string_view* hi,
+                                       std::size_t depth) noexcept
+  {
+    if (static_cast<std::size_t>(hi - lo) <= kBulkLoad)
+    {
+      auto node = std::make_unique<Node>(true);
+
+      for (; lo != hi; lo++)
+      {
+        (void)node->bucket->set_unique(std::string(*lo), 1U);
+      }
+
+      return node;
+    }
+
+    auto node = std::make_unique<Node>(false);
+
+    // Sorted order puts a key that ends at this depth first.
+    if (lo->size() == depth)
+    {
+      node->is_end = true;
+      ++lo;
+    }
+
+    while (lo != hi)
+    {
+      const unsigned char uc = static_cast<unsigned char>((*lo)[depth]);
+      const std::string_view* run = lo + 1;
+
+      while (run != hi && static_cast<unsigned char>((*run)[depth]) == uc)
+      {
+        ++run;
+      }
+
+      node->children[idx(uc)] = m_build(lo, run, depth + 1UL);
+      lo = run;
+    }
+
+    return node;
+  }
+
 public:
   HATTrie() noexcept : m_root(std::make_unique<Node>()) {}
 
@@ -132,6 +187,40 @@ public:
     m_root = std::make_unique<Node>();
   }
 
+  /**
+   * @brief Replaces the contents with the keys of a sorted range.
+   *
+   * No bucket is ever split: the range is partitioned by byte at each depth
+   * and buckets are filled directly. Duplicates are skipped. The range must be
+   * sorted in byte order (std::string's operator<); unsorted input leaves the
+   * trie with missing keys.
+   */
+  template <class InputIt>
+  void build(InputIt first, InputIt last) noexcept
+  {
+    std::vector<std::string_view> keys;
+
+    for (; first != last; ++first)
+    {
+      const std::string_view key(*first);
+
+      if (!keys.empty() && keys.back() == key)
+      {
+        continue;
+      }
+
+      keys.push_back(key);
+    }
+
+    m_root = m_build(keys.data(), keys.data() + keys.size(), 0UL);
+  }
+
+  template <class Range>
+  void build(const Range& sorted) noexcept
+  {
+    build(std::begin(sorted), std::end(sorted));
+  }
+
   void insert(std::string_view key) noexcept
   {
     Node* node = m_root.get();
@@ -0,0 +1,63 @@
+/*
+ * Responsibility - LEB128 variable-length integers for the on-disk formats.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace varint
+{
+  // Longest encoding of a 64-bit value.
+  static constexpr std::size_t kMaxBytes = 10UL;
+
+  /**
+   * @brief Writes v as unsigned LEB128 (7 bits per byte, low bits first).
+   *
+   * @return Number of bytes written (1..kMaxBytes); out needs kMaxBytes room.
+   */
+  static inline std::size_t encode(std::uint64_t v, std::uint8_t* out) noexcept
+  {
+    std::size_t n = 0UL;
+
+    while (v >= 0x80UL)
+    {
+      out[n++] = static_cast<std::uint8_t>(v | 0x80UL);
+      v >>= 7;
+    }
+
+    out[n++] = static_cast<std::uint8_t>(v);
+
+    return n;
+  }
+
+  /**
+   * @brief Reads one unsigned LEB128 value from [p, end).
+   *
+   * @return One past the value, or nullptr if it is truncated or overlong.
+   */
+  static inline const std::uint8_t* decode(const std::uint8_t* p,
+                                           const std::uint8_t* end,
+                                           std::uint64_t&      out) noexcept
+  {
+    std::uint64_t v     = 0UL;
+    unsigned      shift = 0U;
+
+    while (p < end && shift < 64U)
+    {
+      const std::uint8_t byte = *p++;
+
+      v |= (static_cast<std::uint64_t>(byte & 0x7FU) << shift);
+
+      if ((byte & 0x80U) == 0U)
+      {
+        out = v;
+        return p;
+      }
+
+      shift += 7U;
+    }
+
+    return nullptr;
+  }
+} // namespace varint
@@ -0,0 +1,100 @@
+/*
+ * Responsibility - Large-buffer sequential file output for exporters.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Appends to a file through one big user-space buffer.
+ *
+ * stdio's own buffering is switched off and the buffer is handed to the OS
+ * only when it fills or on close(), so an export of millions of lines costs
+ * a few large writes and no per-line flushes. Errors are sticky and reported
+ * once by close().
+ */
+class Writer final
+{
+  std::FILE*        m_file{nullptr};
+  std::vector<char> m_buffer;
+  std::size_t       m_used{0UL};
+  std::uint64_t     m_bytes{0UL};
+  bool              m_failed{false};
+
+  void m_drain(void) noexcept;
+
+public:
+  static constexpr int kOk      =   0 ;
+  static constexpr int kIoError = (-1);
+
+  static constexpr std::size_t kDefaultBufferBytes = (1UL << 20);
+
+  explicit Writer(const std::string& path, const std::size_t buffer_bytes = kDefaultBufferBytes) noexcept;
+
+  // Closes the file if close() was not called; any error is lost.
+  ~Writer() noexcept;
+
+  Writer(const Writer&)            = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  [[nodiscard]] bool is_open(void) const noexcept;
+
+  inline void write(std::string_view s) noexcept
+  {
+    if (s.size() > (m_buffer.size() - m_used))
+    {
+      m_drain();
+
+      if (s.size() > m_buffer.size())
+      {
+        // Larger than the whole buffer: skip the copy.
+        m_failed = m_failed || (m_file == nullptr) || (std::fwrite(s.data(), 1UL, s.size(), m_file) != s.size());
+        m_bytes += s.size();
+        return;
+      }
+    }
+
+    std::memcpy(m_buffer.data() + m_used, s.data(), s.size());
+    m_used += s.size();
+  }
+
+  inline void put(const char c) noexcept
+  {
+    if (m_used == m_buffer.size())
+    {
+      m_drain();
+    }
+
+    m_buffer[m_used++] = c;
+  }
+
+  // Decimal, without going through a locale-aware formatter.
+  inline void write_u64(std::uint64_t v) noexcept
+  {
+    char digits[20];
+    std::size_t n = sizeof(digits);
+
+    do
+    {
+      digits[--n] = static_cast<char>('0' + (v % 10UL));
+      v          /= 10UL;
+    }
+    while (v != 0UL);
+
+    write(std::string_view(digits + n, sizeof(digits) - n));
+  }
+
+  /**
+   * @return kOk if every byte reached the file, kIoError otherwise (or if it
+   *         never opened).
+   */
+  [[nodiscard]] int close(void) noexcept;
+
+  std::uint64_t get_bytes(void) const noexcept;
+};
@@ -0,0 +1,578 @@
+#include "analysis.hpp"
+#include "folded.hpp"
+#include "sample_log.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+  // What one load() worker accumulates from its share of the segments.
+  struct Shard final
+  {
+    StackTable               stacks;
+    std::vector<std::string> names;
+    std::uint64_t            first_ns{std::numeric_limits<std::uint64_t>::max()};
+    std::uint64_t            last_ns{0UL};
+    std::uint32_t            segments{0U};
+    bool                     corrupt{false};
+  };
+
+  void load_shard(const std::string& path, const std::uint32_t first, const std::uint32_t stride, Shard& shard) noexcept
+  {
+    SampleLogReader reader(path, first, stride);
+    Sample sample;
+
+    std::size_t previous = 0UL;
+    bool        counted  = false;  // the previous sample went through add()
+
+    while (reader.next(sample))
+    {
+      const std::size_t depth = sample.stack.size();
+
+      // Tight loops sample the same stack back to back; the log says so for free.
+      if (counted && sample.shared == depth && depth == previous)
+      {
+        shard.stacks.repeat(sample.count);
+      }
+      else
+      {
+        shard.stacks.add(sample.stack.data(), depth, sample.count);
+      }
+
+      previous = depth;
+      counted  = (sample.count > 0UL);
+
+      shard.first_ns = std::min(shard.first_ns, sample.timestamp_ns);
+      shard.last_ns  = std::max(shard.last_ns,  sample.timestamp_ns);
+    }
+
+    shard.names    = reader.get_names();
+    shard.segments = reader.get_segments();
+    shard.corrupt  = reader.is_corrupt();
+  }
+
+  // Self and total samples indexed by id, for ids below at least min_ids.
+  std::vector<FunctionCost> costs_by_id(const StackTable& stacks, const std::size_t min_ids) noexcept
+  {
+    std::size_t ids = min_ids;
+
+    stacks.for_each([&ids](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t) noexcept
+    {
+      for (std::size_t i = 0UL; i < depth; i++)
+      {
+        ids = std::max(ids, static_cast<std::size_t>(stack[i]) + 1UL);
+      }
+    });
+
+    std::vector<FunctionCost> costs(ids);
+    std::vector<std::size_t>  seen(ids, 0UL);
+    std::size_t               visit = 0UL;
+
+    stacks.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+    {
+      ++visit;
+
+      if (depth > 0UL)
+      {
+        costs[stack[depth - 1UL]].self += count;
+      }
+
+      for (std::size_t i = 0UL; i < depth; i++)
+      {
+        if (seen[stack[i]] != visit)
+        {
+          seen[stack[i]]         = visit;
+          costs[stack[i]].total += count;
+        }
+      }
+    });
+
+    for (std::size_t id = 0UL; id < costs.size(); id++)
+    {
+      costs[id].id = static_cast<std::uint32_t>(id);
+    }
+
+    return costs;
+  }
+
+  double share(const std::uint64_t part, const std::uint64_t whole) noexcept
+  {
+    return (whole > 0UL) ? (static_cast<double>(part) / static_cast<double>(whole)) : 0.0;
+  }
+
+  // Two-proportion z statistic for x1 of n1 versus x2 of n2, pooled variance.
+  double z_score(const std::uint64_t x1, const std::uint64_t n1, const std::uint64_t x2, const std::uint64_t n2) noexcept
+  {
+    if (n1 == 0UL || n2 == 0UL)
+    {
+      return 0.0;
+    }
+
+    const double p        = static_cast<double>(x1 + x2) / static_cast<double>(n1 + n2);
+    const double variance = p * (1.0 - p) * ((1.0 / static_cast<double>(n1)) + (1.0 / static_cast<double>(n2)));
+
+    return (variance > 0.0) ? ((share(x2, n2) - share(x1, n1)) / std::sqrt(variance)) : 0.0;
+  }
+
+  /**
+   * Visits every stack in base or cand once with both counts.
+   */
+  template <typename F>
+  void for_each_pair(const StackTable& base, const StackTable& cand, F&& visit) noexcept
+  {
+    cand.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+    {
+      visit(stack, depth, base.count(stack, depth), count);
+    });
+
+    base.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+    {
+      if (cand.count(stack, depth) == 0UL)
+      {
+        visit(stack, depth, count, 0UL);
+      }
+    });
+  }
+
+  // The n paths with the largest sign * share change, largest first.
+  std::vector<PathDelta> top_paths(const StackTable& base, const StackTable& cand, const std::size_t n, const double sign) noexcept
+  {
+    const std::uint64_t nb = base.get_samples();
+    const std::uint64_t nc = cand.get_samples();
+
+    const auto larger = [sign](const PathDelta& a, const PathDelta& b) noexcept
+    {
+      return (sign * a.delta) > (sign * b.delta);
+    };
+
+    std::vector<PathDelta> paths;
+    paths.reserve(n);
+
+    for_each_pair(base, cand, [&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t b, const std::uint64_t c) noexcept
+    {
+      const double delta = share(c, nc) - share(b, nb);
+
+      if ((sign * delta) <= 0.0 || n == 0UL)
+      {
+        return;
+      }
+
+      if (paths.size() == n)
+      {
+        if ((sign * delta) <= (sign * paths.front().delta))
+        {
+          return;
+        }
+
+        std::pop_heap(paths.begin(), paths.end(), larger);
+        paths.pop_back();
+      }
+
+      paths.push_back({std::vector<std::uint32_t>(stack, stack + depth), b, c, delta, z_score(b, nb, c, nc)});
+      std::push_heap(paths.begin(), paths.end(), larger);
+    });
+
+    std::sort_heap(paths.begin(), paths.end(), larger);
+
+    return paths;
+  }
+
+  std::vector<CallEdge> collect_edges(const StackTable& stacks, const std::uint32_t id, const bool callers) noexcept
+  {
+    std::unordered_map<std::uint32_t, std::uint64_t> counts;
+    std::vector<std::uint32_t> seen;
+
+    stacks.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+    {
+      seen.clear();
+
+      for (std::size_t i = 1UL; i < depth; i++)
+      {
+        const std::uint32_t other = callers ? stack[i - 1UL] : stack[i];
+
+        if ((callers ? stack[i] : stack[i - 1UL]) != id ||
+            std::find(seen.begin(), seen.end(), other) != seen.end())
+        {
+          continue;
+        }
+
+        seen.push_back(other);
+        counts[other] += count;
+      }
+    });
+
+    std::vector<CallEdge> edges;
+    edges.reserve(counts.size());
+
+    for (const auto& [other, count] : counts)
+    {
+      edges.push_back(callers ? CallEdge{other, id, count} : CallEdge{id, other, count});
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const CallEdge& a, const CallEdge& b) noexcept
+    {
+      return (a.count != b.count) ? (a.count > b.count) : ((a.caller != b.caller) ? (a.caller < b.caller) : (a.callee < b.callee));
+    });
+
+    return edges;
+  }
+} // namespace
+
+int Profile::load(const std::string& path, unsigned threads) noexcept
+{
+  if (threads == 0U)
+  {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  std::vector<Shard> shards(threads);
+
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (unsigned k = 0U; k < threads; k++)
+    {
+      workers.emplace_back([&path, &shard = shards[k], k, threads]() noexcept
+      {
+        load_shard(path, k, threads, shard);
+      });
+    }
+
+    for (auto& worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  m_stacks.clear();
+  m_names.clear();
+  m_first_ns = std::numeric_limits<std::uint64_t>::max();
+  m_last_ns  = 0UL;
+  m_segments = 0U;
+  m_corrupt  = false;
+
+  for (const Shard& shard : shards)
+  {
+    m_stacks.merge(shard.stacks);
+
+    if (shard.names.size() > m_names.size())
+    {
+      m_names.resize(shard.names.size());
+    }
+
+    // Ids are global to the log; each shard saw the names from its own segments.
+    for (std::size_t id = 0UL; id < shard.names.size(); id++)
+    {
+      if (!shard.names[id].empty())
+      {
+        m_names[id] = shard.names[id];
+      }
+    }
+
+    m_first_ns  = std::min(m_first_ns, shard.first_ns);
+    m_last_ns   = std::max(m_last_ns,  shard.last_ns);
+    m_segments += shard.segments;
+    m_corrupt   = (m_corrupt || shard.corrupt);
+  }
+
+  if (m_stacks.get_samples() == 0UL)
+  {
+    m_first_ns = 0UL;
+  }
+
+  if (m_corrupt)
+  {
+    return kCorrupt;
+  }
+
+  return (m_segments == 0U) ? kMissing : kOk;
+}
+
+std::vector<FunctionCost> Profile::flat(void) const noexcept
+{
+  std::vector<FunctionCost> costs = costs_by_id(m_stacks, m_names.size());
+
+  costs.erase(std::remove_if(costs.begin(), costs.end(), [](const FunctionCost& c) noexcept
+  {
+    return c.total == 0UL;
+  }), costs.end());
+
+  std::sort(costs.begin(), costs.end(), [](const FunctionCost& a, const FunctionCost& b) noexcept
+  {
+    if (a.self != b.self)
+    {
+      return a.self > b.self;
+    }
+
+    return (a.total != b.total) ? (a.total > b.total) : (a.id < b.id);
+  });
+
+  return costs;
+}
+
+std::vector<HotPath> Profile::hot_paths(const std::size_t n) const noexcept
+{
+  const auto hotter = [](const HotPath& a, const HotPath& b) noexcept
+  {
+    return a.count > b.count;
+  };
+
+  // Min-heap of the n best so far: only stacks that make the cut are copied.
+  std::vector<HotPath> paths;
+  paths.reserve(n);
+
+  m_stacks.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    if (paths.size() == n)
+    {
+      if (n == 0UL || count <= paths.front().count)
+      {
+        return;
+      }
+
+      std::pop_heap(paths.begin(), paths.end(), hotter);
+      paths.pop_back();
+    }
+
+    paths.push_back({std::vector<std::uint32_t>(stack, stack + depth), count});
+    std::push_heap(paths.begin(), paths.end(), hotter);
+  });
+
+  std::sort_heap(paths.begin(), paths.end(), hotter);
+
+  return paths;
+}
+
+int Profile::write_folded(const std::string& path) const noexcept
+{
+  Writer out(path);
+
+  if (!out.is_open())
+  {
+    return kIoError;
+  }
+
+  m_stacks.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    folded::write_stack(out, stack, depth, [this](const std::uint32_t id) noexcept
+    {
+      return name(id);
+    });
+
+    out.put(' ');
+    out.write_u64(count);
+    out.put('\n');
+  });
+
+  return (out.close() == Writer::kOk) ? kOk : kIoError;
+}
+
+std::vector<CallEdge> Profile::callers(const std::uint32_t id) const noexcept
+{
+  return collect_edges(m_stacks, id, true);
+}
+
+std::vector<CallEdge> Profile::callees(const std::uint32_t id) const noexcept
+{
+  return collect_edges(m_stacks, id, false);
+}
+
+std::string_view Profile::name(const std::uint32_t id) const noexcept
+{
+  return (id < m_names.size()) ? std::string_view(m_names[id]) : std::string_view();
+}
+
+std::uint32_t Profile::find(std::string_view name) const noexcept
+{
+  for (std::size_t id = 0UL; id < m_names.size(); id++)
+  {
+    if (m_names[id] == name)
+    {
+      return static_cast<std::uint32_t>(id);
+    }
+  }
+
+  return kNotFound;
+}
+
+const StackTable& Profile::get_stacks(void) const noexcept
+{
+  return m_stacks;
+}
+
+const std::vector<std::string>& Profile::get_names(void) const noexcept
+{
+  return m_names;
+}
+
+std::uint64_t Profile::get_samples(void) const noexcept
+{
+  return m_stacks.get_samples();
+}
+
+std::uint64_t Profile::get_duration_ns(void) const noexcept
+{
+  return m_last_ns - m_first_ns;
+}
+
+std::uint32_t Profile::get_segments(void) const noexcept
+{
+  return m_segments;
+}
+
+bool Profile::is_corrupt(void) const noexcept
+{
+  return m_corrupt;
+}
+
+ProfileDiff::ProfileDiff(const Profile& baseline, const Profile& candidate) noexcept
+  : m_names(),
+    m_base(),
+    m_cand(),
+    m_base_seconds(static_cast<double>(baseline.get_duration_ns())  / 1e9),
+    m_cand_seconds(static_cast<double>(candidate.get_duration_ns()) / 1e9)
+{
+  m_import(baseline,  m_base);
+  m_import(candidate, m_cand);
+}
+
+void ProfileDiff::m_import(const Profile& profile, StackTable& out) noexcept
+{
+  // Profile id -> shared id, resolved the first time each id is met.
+  std::vector<std::uint32_t> remap;
+  std::vector<std::uint32_t> shared;
+
+  profile.get_stacks().for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    shared.resize(depth);
+
+    for (std::size_t i = 0UL; i < depth; i++)
+    {
+      const std::uint32_t id = stack[i];
+
+      if (id >= remap.size())
+      {
+        remap.resize(static_cast<std::size_t>(id) + 1UL, Interner::kInvalid);
+      }
+
+      if (remap[id] == Interner::kInvalid)
+      {
+        const std::string_view name = profile.name(id);
+        remap[id] = name.empty() ? m_names.intern("<" + std::to_string(id) + ">") : m_names.intern(name);
+      }
+
+      shared[i] = remap[id];
+    }
+
+    out.add(shared.data(), depth, count);
+  });
+}
+
+std::vector<FunctionDelta> ProfileDiff::functions(const Rank rank) const noexcept
+{
+  const std::uint64_t nb = m_base.get_samples();
+  const std::uint64_t nc = m_cand.get_samples();
+
+  const std::vector<FunctionCost> base = costs_by_id(m_base, m_names.size());
+  const std::vector<FunctionCost> cand = costs_by_id(m_cand, m_names.size());
+
+  std::vector<FunctionDelta> deltas;
+  deltas.reserve(base.size());
+
+  for (std::size_t id = 0UL; id < base.size() && id < cand.size(); id++)
+  {
+    const FunctionCost& b = base[id];
+    const FunctionCost& c = cand[id];
+
+    if (b.total == 0UL && c.total == 0UL)
+    {
+      continue;
+    }
+
+    FunctionDelta d;
+
+    d.id            = static_cast<std::uint32_t>(id);
+    d.base_self     = share(b.self,  nb);
+    d.base_total    = share(b.total, nb);
+    d.cand_self     = share(c.self,  nc);
+    d.cand_total    = share(c.total, nc);
+    d.self_seconds  = (d.cand_self  * m_cand_seconds) - (d.base_self  * m_base_seconds);
+    d.total_seconds = (d.cand_total * m_cand_seconds) - (d.base_total * m_base_seconds);
+    d.self_z        = z_score(b.self,  nb, c.self,  nc);
+    d.total_z       = z_score(b.total, nb, c.total, nc);
+
+    deltas.push_back(d);
+  }
+
+  std::sort(deltas.begin(), deltas.end(), [rank](const FunctionDelta& a, const FunctionDelta& b) noexcept
+  {
+    const double da = (rank == Rank::SELF) ? (a.cand_self - a.base_self) : (a.cand_total - a.base_total);
+    const double db = (rank == Rank::SELF) ? (b.cand_self - b.base_self) : (b.cand_total - b.base_total);
+
+    return (da != db) ? (da > db) : (a.id < b.id);
+  });
+
+  return deltas;
+}
+
+std::vector<PathDelta> ProfileDiff::regressions(const std::size_t n) const noexcept
+{
+  return top_paths(m_base, m_cand, n, 1.0);
+}
+
+std::vector<PathDelta> ProfileDiff::improvements(const std::size_t n) const noexcept
+{
+  return top_paths(m_base, m_cand, n, -1.0);
+}
+
+int ProfileDiff::write_folded(const std::string& path) const noexcept
+{
+  Writer out(path);
+
+  if (!out.is_open())
+  {
+    return kIoError;
+  }
+
+  for_each_pair(m_base, m_cand, [&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t b, const std::uint64_t c) noexcept
+  {
+    folded::write_stack(out, stack, depth, [this](const std::uint32_t id) noexcept
+    {
+      return m_names.name(id);
+    });
+
+    out.put(' ');
+    out.write_u64(b);
+    out.put(' ');
+    out.write_u64(c);
+    out.put('\n');
+  });
+
+  return (out.close() == Writer::kOk) ? kOk : kIoError;
+}
+
+std::string_view ProfileDiff::name(const std::uint32_t id) const noexcept
+{
+  return m_names.name(id);
+}
+
+std::uint64_t ProfileDiff::get_base_samples(void) const noexcept
+{
+  return m_base.get_samples();
+}
+
+std::uint64_t ProfileDiff::get_cand_samples(void) const noexcept
+{
+  return m_cand.get_samples();
+}
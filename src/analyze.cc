@@ -0,0 +1,379 @@
+#include "analysis.hpp"
+#include "flamegraph.hpp"
+#include "pprof.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  struct Arguments final
+  {
+    const char* path{nullptr};
+    const char* baseline{nullptr};
+    const char* folded{nullptr};
+    const char* svg{nullptr};
+    const char* pprof{nullptr};
+    const char* function{nullptr};
+    std::size_t top{20UL};
+    std::size_t paths{10UL};
+    unsigned    threads{0U};
+    FlameLayout layout{FlameLayout::FLAME};
+    bool        by_total{false};
+  };
+
+  void usage(void) noexcept
+  {
+    std::cerr << "usage: analyze <sample log> [-n functions] [-p paths] [-j threads] [-f function] [-o folded]"
+                 " [-g svg] [-l flame|icicle|reversed] [-P pprof[.gz]]" << std::endl;
+    std::cerr << "       analyze -d <baseline log> <candidate log> [-n functions] [-p paths] [-j threads]"
+                 " [-r self|total] [-o folded diff]" << std::endl;
+  }
+
+  bool parse_layout(std::string_view value, FlameLayout& layout) noexcept
+  {
+    if (value == "flame")    { layout = FlameLayout::FLAME;    return true; }
+    if (value == "icicle")   { layout = FlameLayout::ICICLE;   return true; }
+    if (value == "reversed") { layout = FlameLayout::REVERSED; return true; }
+
+    return false;
+  }
+
+  bool parse(const int argc, char** argv, Arguments& args) noexcept
+  {
+    for (int i = 1; i < argc; i++)
+    {
+      const std::string_view arg = argv[i];
+
+      if (arg.size() == 2UL && arg[0] == '-' && (i + 1) < argc)
+      {
+        const char* value = argv[++i];
+
+        switch (arg[1])
+        {
+          case 'n': args.top      = std::strtoul(value, nullptr, 10);                        continue;
+          case 'p': args.paths    = std::strtoul(value, nullptr, 10);                        continue;
+          case 'j': args.threads  = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); continue;
+          case 'f': args.function = value;                                                   continue;
+          case 'd': args.baseline = value;                                                   continue;
+          case 'o': args.folded   = value;                                                   continue;
+          case 'g': args.svg      = value;                                                   continue;
+          case 'P': args.pprof    = value;                                                   continue;
+          case 'l': if (!parse_layout(value, args.layout)) { return false; }                 continue;
+          case 'r': args.by_total = (std::strcmp(value, "total") == 0);                      break;
+          default:  return false;
+        }
+
+        // Only -r falls through here.
+        if (!args.by_total && std::strcmp(value, "self") != 0)
+        {
+          return false;
+        }
+
+        continue;
+      }
+
+      if (arg.empty() || arg[0] == '-' || args.path != nullptr)
+      {
+        return false;
+      }
+
+      args.path = argv[i];
+    }
+
+    return args.path != nullptr;
+  }
+
+  double percent(const std::uint64_t part, const std::uint64_t whole) noexcept
+  {
+    return (whole > 0UL) ? (static_cast<double>(part) / static_cast<double>(whole)) * 100.0 : 0.0;
+  }
+
+  std::string label(const Profile& profile, const std::uint32_t id) noexcept
+  {
+    const std::string_view name = profile.name(id);
+    return name.empty() ? ("<" + std::to_string(id) + ">") : std::string(name);
+  }
+
+  void print_flat(const Profile& profile, const std::size_t top) noexcept
+  {
+    const std::uint64_t samples = profile.get_samples();
+    const auto          costs   = profile.flat();
+
+    std::cout << std::endl << "Flat profile:" << std::endl;
+    std::cout << std::right << std::setw(8)  << "self%"
+                            << std::setw(12) << "self"
+                            << std::setw(8)  << "total%"
+                            << std::setw(12) << "total" << "  function" << std::endl;
+
+    for (std::size_t i = 0UL; i < costs.size() && i < top; i++)
+    {
+      std::cout << std::setw(8)  << percent(costs[i].self, samples)
+                << std::setw(12) << costs[i].self
+                << std::setw(8)  << percent(costs[i].total, samples)
+                << std::setw(12) << costs[i].total << "  " << label(profile, costs[i].id) << std::endl;
+    }
+  }
+
+  void print_paths(const Profile& profile, const std::size_t n) noexcept
+  {
+    const std::uint64_t samples = profile.get_samples();
+
+    std::cout << std::endl << "Hot paths:" << std::endl;
+
+    for (const HotPath& path : profile.hot_paths(n))
+    {
+      std::cout << std::setw(8) << percent(path.count, samples) << std::setw(12) << path.count << "  ";
+
+      for (std::size_t i = 0UL; i < path.stack.size(); i++)
+      {
+        std::cout << ((i > 0UL) ? ";" : "") << label(profile, path.stack[i]);
+      }
+
+      std::cout << std::endl;
+    }
+  }
+
+  std::string stack_label(const ProfileDiff& diff, const std::vector<std::uint32_t>& stack) noexcept
+  {
+    std::string out;
+
+    for (std::size_t i = 0UL; i < stack.size(); i++)
+    {
+      out += (i > 0UL) ? ";" : "";
+      out += diff.name(stack[i]);
+    }
+
+    return out;
+  }
+
+  void print_delta(const ProfileDiff& diff, const FunctionDelta& d) noexcept
+  {
+    std::cout << std::setw(8)  << (d.base_self  * 100.0)
+              << std::setw(8)  << (d.cand_self  * 100.0)
+              << std::setw(8)  << ((d.cand_self  - d.base_self)  * 100.0)
+              << std::setw(8)  << ((d.cand_total - d.base_total) * 100.0)
+              << std::setw(10) << (d.self_seconds * 1e3)
+              << std::setw(8)  << d.self_z << "  " << diff.name(d.id) << std::endl;
+  }
+
+  void print_path_deltas(const ProfileDiff& diff, const char* title, const std::vector<PathDelta>& paths) noexcept
+  {
+    std::cout << std::endl << title << std::endl;
+    std::cout << std::right << std::setw(8) << "dshare" << std::setw(8) << "z"
+              << std::setw(12) << "base" << std::setw(12) << "cand" << "  path" << std::endl;
+
+    for (const PathDelta& path : paths)
+    {
+      std::cout << std::setw(8)  << (path.delta * 100.0)
+                << std::setw(8)  << path.z
+                << std::setw(12) << path.base
+                << std::setw(12) << path.cand << "  " << stack_label(diff, path.stack) << std::endl;
+    }
+  }
+
+  int run_diff(const Arguments& args, const unsigned threads) noexcept
+  {
+    Profile baseline, candidate;
+
+    if (baseline.load(args.baseline, threads) == Profile::kMissing)
+    {
+      std::cerr << "analyze: no sample log at " << args.baseline << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (candidate.load(args.path, threads) == Profile::kMissing)
+    {
+      std::cerr << "analyze: no sample log at " << args.path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const ProfileDiff diff(baseline, candidate);
+    const auto        rank   = args.by_total ? ProfileDiff::Rank::TOTAL : ProfileDiff::Rank::SELF;
+    const auto        deltas = diff.functions(rank);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Baseline:  " << args.baseline << " (" << baseline.get_samples() << " samples, "
+              << (static_cast<double>(baseline.get_duration_ns()) / 1e9) << " seconds)" << std::endl;
+    std::cout << "Candidate: " << args.path << " (" << candidate.get_samples() << " samples, "
+              << (static_cast<double>(candidate.get_duration_ns()) / 1e9) << " seconds)" << std::endl;
+
+    std::cout << std::endl << "Function deltas, ranked by " << (args.by_total ? "total" : "self")
+              << " share (|z| > 2 is unlikely to be noise):" << std::endl;
+    std::cout << std::right << std::setw(8)  << "base%"
+                            << std::setw(8)  << "cand%"
+                            << std::setw(8)  << "dself"
+                            << std::setw(8)  << "dtotal"
+                            << std::setw(10) << "dself ms"
+                            << std::setw(8)  << "z" << "  function" << std::endl;
+
+    // The most regressed rows, then the most improved ones.
+    const std::size_t head = std::min(args.top, deltas.size());
+    const std::size_t tail = std::min(args.top, deltas.size() - head);
+
+    for (std::size_t i = 0UL; i < head; i++)
+    {
+      print_delta(diff, deltas[i]);
+    }
+
+    if (head + tail < deltas.size())
+    {
+      std::cout << std::setw(8) << "..." << std::endl;
+    }
+
+    for (std::size_t i = deltas.size() - tail; i < deltas.size(); i++)
+    {
+      print_delta(diff, deltas[i]);
+    }
+
+    print_path_deltas(diff, "Regressed paths:", diff.regressions(args.paths));
+    print_path_deltas(diff, "Improved paths:",  diff.improvements(args.paths));
+
+    if (args.folded != nullptr)
+    {
+      if (diff.write_folded(args.folded) != ProfileDiff::kOk)
+      {
+        std::cerr << "analyze: cannot write " << args.folded << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      std::cout << std::endl << "Folded diff written to " << args.folded << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  void print_edges(const Profile& profile, const char* title, const std::vector<CallEdge>& edges, const bool callers) noexcept
+  {
+    const std::uint64_t samples = profile.get_samples();
+
+    std::cout << std::endl << title << std::endl;
+
+    for (const CallEdge& edge : edges)
+    {
+      std::cout << std::setw(8)  << percent(edge.count, samples)
+                << std::setw(12) << edge.count << "  "
+                << label(profile, callers ? edge.caller : edge.callee) << std::endl;
+    }
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  Arguments args;
+
+  if (!parse(argc, argv, args))
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const unsigned threads = (args.threads > 0U) ? args.threads : std::max(1U, std::thread::hardware_concurrency());
+
+  if (args.baseline != nullptr)
+  {
+    return run_diff(args, threads);
+  }
+
+  Profile profile;
+
+  const auto start  = std::chrono::steady_clock::now();
+  const int  status = profile.load(args.path, threads);
+  const auto end    = std::chrono::steady_clock::now();
+
+  if (status == Profile::kMissing)
+  {
+    std::cerr << "analyze: no sample log at " << args.path << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double load_seconds = std::chrono::duration<double>(end - start).count();
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Profile: " << args.path << std::endl;
+  std::cout << "Samples: " << profile.get_samples() << " over "
+            << (static_cast<double>(profile.get_duration_ns()) / 1e9) << " seconds, "
+            << profile.get_stacks().size() << " distinct stacks, " << profile.get_segments() << " segments" << std::endl;
+  std::cout << "Loaded in " << load_seconds << " seconds on " << threads << " threads" << std::endl;
+
+  if (status == Profile::kCorrupt)
+  {
+    std::cout << "(log is corrupt past some point; showing what was read before it)" << std::endl;
+  }
+
+  print_flat(profile, args.top);
+  print_paths(profile, args.paths);
+
+  if (args.function != nullptr)
+  {
+    const std::uint32_t id = profile.find(args.function);
+
+    if (id == Profile::kNotFound)
+    {
+      std::cerr << "analyze: no function named " << args.function << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    print_edges(profile, "Callers:", profile.callers(id), true);
+    print_edges(profile, "Callees:", profile.callees(id), false);
+  }
+
+  if (args.folded != nullptr)
+  {
+    if (profile.write_folded(args.folded) != Profile::kOk)
+    {
+      std::cerr << "analyze: cannot write " << args.folded << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << std::endl << "Folded stacks written to " << args.folded << std::endl;
+  }
+
+  if (args.svg != nullptr)
+  {
+    const FlameGraph graph(profile.get_stacks(), profile.get_names(), args.layout);
+
+    FlameGraphStyle style;
+    style.title = std::string(args.path);
+
+    if (graph.write_svg(args.svg, style) != FlameGraph::kOk)
+    {
+      std::cerr << "analyze: cannot write " << args.svg << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Flame graph (" << graph.get_nodes() << " frames before pruning) written to " << args.svg << std::endl;
+  }
+
+  if (args.pprof != nullptr)
+  {
+    const std::string_view path = args.pprof;
+    const std::uint64_t    n    = profile.get_samples();
+
+    // The log keeps no wall-clock start; the period is the average spacing.
+    PprofInfo info;
+    info.duration_ns = profile.get_duration_ns();
+    info.period_ns   = (n > 1UL) ? (info.duration_ns / (n - 1UL)) : 0UL;
+    info.compress    = (path.size() > 3UL && path.substr(path.size() - 3UL) == ".gz");
+
+    if (pprof::write(args.pprof, profile.get_stacks(), profile.get_names(), info) != pprof::kOk)
+    {
+      std::cerr << "analyze: cannot write " << args.pprof << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "pprof profile written to " << args.pprof << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
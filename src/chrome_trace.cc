@@ -0,0 +1,161 @@
+#include "chrome_trace.hpp"
+#include "writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace
+{
+  void append_escaped(std::string& out, std::string_view s) noexcept
+  {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    for (const char c : s)
+    {
+      const unsigned char u = static_cast<unsigned char>(c);
+
+      if (c == '"' || c == '\\')
+      {
+        out += '\\';
+        out += c;
+      }
+      else if (u < 0x20U)
+      {
+        out += "\\u00";
+        out += kHex[u >> 4];
+        out += kHex[u & 0xFU];
+      }
+      else
+      {
+        out += c;
+      }
+    }
+  }
+
+  std::string name_fragment(std::string_view name) noexcept
+  {
+    std::string fragment = "\"name\":\"";
+
+    append_escaped(fragment, name);
+    fragment += '"';
+
+    return fragment;
+  }
+} // namespace
+
+ChromeTraceWriter::ChromeTraceWriter(const std::string& path, const std::size_t buffer_bytes) noexcept
+  : m_out(path, buffer_bytes),
+    m_names()
+{
+  m_out.put('[');
+}
+
+ChromeTraceWriter::~ChromeTraceWriter() noexcept
+{
+  (void)close();
+}
+
+bool ChromeTraceWriter::is_open(void) const noexcept
+{
+  return m_out.is_open();
+}
+
+void ChromeTraceWriter::m_separator(void) noexcept
+{
+  if (m_events > 0UL)
+  {
+    m_out.put(',');
+  }
+
+  m_out.put('\n');
+  ++m_events;
+}
+
+void ChromeTraceWriter::define(const std::uint32_t id, std::string_view name) noexcept
+{
+  if (id >= m_names.size())
+  {
+    m_names.resize(static_cast<std::size_t>(id) + 1UL);
+  }
+
+  m_names[id] = name_fragment(name);
+}
+
+void ChromeTraceWriter::thread_name(const std::uint32_t tid, std::string_view name) noexcept
+{
+  if (m_closed)
+  {
+    return;
+  }
+
+  m_separator();
+  m_out.write("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":");
+  m_out.write_u64(kPid);
+  m_out.write(",\"tid\":");
+  m_out.write_u64(tid);
+  m_out.write(",\"args\":{");
+  m_out.write(name_fragment(name));
+  m_out.write("}}");
+}
+
+void ChromeTraceWriter::m_event(const char phase, const std::uint32_t tid, const std::uint32_t id, const std::uint64_t timestamp_ns) noexcept
+{
+  if (m_closed)
+  {
+    return;
+  }
+
+  const std::uint64_t fraction = timestamp_ns % 1000UL;
+
+  m_separator();
+  m_out.write("{\"ph\":\"");
+  m_out.put(phase);
+  m_out.write("\",");
+  m_out.write((id < m_names.size() && !m_names[id].empty()) ? std::string_view(m_names[id]) : std::string_view("\"name\":\"?\""));
+  m_out.write(",\"ts\":");
+  m_out.write_u64(timestamp_ns / 1000UL);
+  m_out.put('.');
+  m_out.put(static_cast<char>('0' + (fraction / 100UL)));
+  m_out.put(static_cast<char>('0' + ((fraction / 10UL) % 10UL)));
+  m_out.put(static_cast<char>('0' + (fraction % 10UL)));
+  m_out.write(",\"pid\":");
+  m_out.write_u64(kPid);
+  m_out.write(",\"tid\":");
+  m_out.write_u64(tid);
+  m_out.put('}');
+}
+
+void ChromeTraceWriter::begin(const std::uint32_t tid, const std::uint32_t id, const std::uint64_t timestamp_ns) noexcept
+{
+  m_event('B', tid, id, timestamp_ns);
+}
+
+void ChromeTraceWriter::end(const std::uint32_t tid, const std::uint32_t id, const std::uint64_t timestamp_ns) noexcept
+{
+  m_event('E', tid, id, timestamp_ns);
+}
+
+int ChromeTraceWriter::close(void) noexcept
+{
+  if (m_closed)
+  {
+    return kIoError;
+  }
+
+  m_closed = true;
+  m_out.write("\n]\n");
+
+  return (m_out.close() == Writer::kOk) ? kOk : kIoError;
+}
+
+std::uint64_t ChromeTraceWriter::get_events(void) const noexcept
+{
+  return m_events;
+}
+
+std::uint64_t ChromeTraceWriter::get_bytes(void) const noexcept
+{
+  return m_out.get_bytes();
+}
@@ -1,23 +1,89 @@
 #include "clock.hpp"
 
 #include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(PACE_CLOCK_HAS_TSC)
+  #include <cpuid.h>
+#endif
+
+namespace
+{
+  constexpr auto kCalibrationWindow = std::chrono::milliseconds(20);
+} // namespace
+
+void Clock::m_calibrate(void) noexcept
+{
+  m_calibrated  = true;
+  m_use_tsc     = false;
+  m_ns_per_tick = 1.0;
+
+#if defined(PACE_CLOCK_HAS_TSC)
+  unsigned int eax = 0U, ebx = 0U, ecx = 0U, edx = 0U;
+
+  // CPUID.80000007H:EDX[8] - the TSC ticks at a constant rate in every
+  // P-, C- and T-state, so it can stand in for a wall clock.
+  if (!__get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx) || (edx & (1U << 8)) == 0U)
+  {
+    return;
+  }
+
+  const std::uint64_t ns0  = now_ns();
+  const std::uint64_t tsc0 = static_cast<std::uint64_t>(__rdtsc());
+
+  std::this_thread::sleep_for(kCalibrationWindow);
+
+  const std::uint64_t ns1  = now_ns();
+  const std::uint64_t tsc1 = static_cast<std::uint64_t>(__rdtsc());
+
+  if (tsc1 <= tsc0 || ns1 <= ns0)
+  {
+    return;
+  }
+
+  m_ns_per_tick = static_cast<double>(ns1 - ns0) / static_cast<double>(tsc1 - tsc0);
+  m_use_tsc     = true;
+#endif
+}
 
 void Clock::start(void) noexcept
 {
-  m_start = std::chrono::steady_clock::now();
+  if (!m_calibrated)
+  {
+    m_calibrate();
+  }
+
+  m_start = now();
+  m_stop  = m_start;
 }
 
 void Clock::stop(void) noexcept
 {
-  m_stop = std::chrono::steady_clock::now();
+  m_stop = now();
 }
 
-std::chrono::time_point<std::chrono::steady_clock> Clock::get_start(void) const noexcept
+std::uint64_t Clock::get_start(void) const noexcept
 {
   return m_start;
 }
 
-std::chrono::time_point<std::chrono::steady_clock> Clock::get_stop(void)  const noexcept
+std::uint64_t Clock::get_stop(void)  const noexcept
 {
   return m_stop;
 }
+
+double Clock::to_seconds(const std::uint64_t ticks) const noexcept
+{
+  return (static_cast<double>(ticks) * m_ns_per_tick) / 1e9;
+}
+
+std::uint64_t Clock::to_ns(const std::uint64_t ticks) const noexcept
+{
+  return static_cast<std::uint64_t>(static_cast<double>(ticks) * m_ns_per_tick);
+}
+
+bool Clock::is_tsc(void) const noexcept
+{
+  return m_use_tsc;
+}
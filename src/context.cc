@@ -1,9 +1,17 @@
+#include "bqueue.hpp"
+#include "clock.hpp"
 #include "common.hpp"
 #include "context.hpp"
+#include "event.hpp"
+#include "frame.hpp"
 
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <thread>
 
 #if defined(_WIN32) || defined(__CYGWIN__)
   #include <windows.h>
@@ -32,8 +40,7 @@ namespace pace
 
   bool Context::StateThrottle::next(void) noexcept
   {
-    using namespace std::chrono_literals;
-    std::this_thread::sleep_for(25ms);
+    m_ctx->throttle();
     return false;
   }
 
@@ -42,6 +49,154 @@ namespace pace
     return m_next_state();
   }
 
+  void Context::m_run(void) noexcept
+  {
+    Clock& clock = Clock::get_instance();
+    clock.start();
+
+    m_pacer.start();
+    m_profiler.set_requested_rate(m_pacer.get_rate());
+
+    switch (m_options.mode)
+    {
+      case ExecutionMode::SEQUENTIAL:
+        m_run_sequential();
+        break;
+
+      case ExecutionMode::PIPELINED:
+        m_run_pipelined();
+        break;
+
+      default:
+        common::fatal_trap();
+    }
+
+    m_profiler.set_missed_ticks(m_pacer.get_missed());
+    m_profiler.set_overhead(m_governor.get_total_cost_ns(), m_governor.get_budget(),
+                            m_governor.get_rate(), m_governor.get_adjustments());
+  }
+
+  void Context::m_run_sequential(void) noexcept
+  {
+    for (;;)
+    {
+      if (m_next())
+      {
+        break;
+      }
+    }
+
+    Clock::get_instance().stop();
+
+    m_profiler.finalize(m_pacer.get_ticks());
+  }
+
+  void Context::m_run_pipelined(void) noexcept
+  {
+    using FrameChannel = BlockingQueue<::Frame, 64UL>;
+    using EventChannel = BlockingQueue<Event, 256UL>;
+
+    const std::chrono::milliseconds timeout(m_options.overflow_timeout_ms);
+
+    FrameChannel frames(m_options.overflow, timeout);
+    EventChannel events(m_options.overflow, timeout);
+
+    // Sampler: capture on schedule; a slow profiler only shows up as
+    // backpressure on the frame channel, never inside a capture.
+    std::thread sampler([this, &frames]() noexcept
+    {
+      auto& buffer = *m_scanner.get_frame_buffer();
+
+      for (;;)
+      {
+        const bool done = scan();
+
+        ::Frame frame;
+
+        while (buffer.pop(frame) == Queue<::Frame, 64UL>::kOk)
+        {
+          if (frames.push(std::move(frame)) != FrameChannel::kOk)
+          {
+            common::fatal_trap();
+          }
+        }
+
+        if (done)
+        {
+          break;
+        }
+
+        throttle();
+      }
+
+      Clock::get_instance().stop();
+      frames.close();
+    });
+
+    // Profiler: turn frames into START/END events.
+    std::thread profiler([this, &frames, &events]() noexcept
+    {
+      m_scanner.ignore_current_thread();
+
+      auto forward = [this, &events]() noexcept
+      {
+        if (!m_options.sink)
+        {
+          return;
+        }
+
+        Event event;
+
+        while (m_profiler.next_event(event))
+        {
+          if (events.push(std::move(event)) != EventChannel::kOk)
+          {
+            common::fatal_trap();
+          }
+        }
+      };
+
+      ::Frame frame;
+
+      while (frames.pop(frame) == FrameChannel::kOk)
+      {
+        const std::uint64_t begin = Clock::now_ns();
+
+        m_profiler.profile(std::move(frame));
+        forward();
+
+        m_governor.charge(Clock::now_ns() - begin);
+      }
+
+      m_profiler.finalize(m_pacer.get_ticks());
+      forward();
+
+      events.close();
+    });
+
+    // Sink: write durations as soon as their END arrives.
+    std::thread sink([this, &events]() noexcept
+    {
+      m_scanner.ignore_current_thread();
+
+      Event event;
+
+      std::cout << std::fixed << std::setprecision(2);
+
+      while (events.pop(event) == EventChannel::kOk)
+      {
+        m_profiler.sink(event);
+      }
+    });
+
+    sampler.join();
+    profiler.join();
+    sink.join();
+
+    (void)frames.dropped(m_metrics.frames_dropped);
+    (void)events.dropped(m_metrics.events_dropped);
+  }
+
   inline bool Context::m_next_state(void) noexcept
   {
     if (m_state == nullptr)
@@ -111,6 +266,61 @@ namespace pace
   Context::~Context() noexcept
   {
     m_profiler.dump();
+
+    if (m_options.all_threads)
+    {
+      std::cout << "Threads: " << m_scanner.get_threads() << " sampled" << std::endl;
+    }
+
+    if (m_sample_log != nullptr)
+    {
+      m_sample_log->flush();
+
+      std::cout << "Sample log: " << m_sample_log->get_samples() << " samples in "
+                << m_sample_log->get_segments() << " segments, " << m_sample_log->get_bytes() << " bytes";
+
+      if (m_sample_log->get_failed() > 0UL)
+      {
+        std::cout << " (" << m_sample_log->get_failed() << " records lost)";
+      }
+
+      std::cout << std::endl;
+    }
+
+    for (const std::shared_ptr<FileSink>& file : m_files)
+    {
+      file->report();
+    }
+
+    if (m_chrome_trace != nullptr)
+    {
+      const std::uint64_t events = m_chrome_trace->get_events();
+
+      if (m_chrome_trace->close() != ChromeTraceWriter::kOk)
+      {
+        std::cerr << "[chrome_trace] failed to write " << m_options.chrome_trace << "\n";
+      }
+      else
+      {
+        std::cout << "Chrome trace: " << events << " events, " << m_chrome_trace->get_bytes()
+                  << " bytes written to " << m_options.chrome_trace << std::endl;
+      }
+    }
+
+    if (m_line_histogram != nullptr)
+    {
+      m_scanner.resolve_lines();
+
+      if (m_line_histogram->write(m_options.line_profile, m_options.line_profile_top) != LineHistogram::kOk)
+      {
+        std::cerr << "[line_profile] failed to write " << m_options.line_profile << "\n";
+      }
+      else
+      {
+        std::cout << "Line profile: " << m_line_histogram->get_pcs() << " PCs, " << m_line_histogram->get_samples()
+                  << " samples written to " << m_options.line_profile << std::endl;
+      }
+    }
   }
 
   void Context::profile(void) noexcept
@@ -120,11 +330,31 @@ namespace pace
 
   void Context::profile_ERB(void) noexcept
   {
+    const std::uint64_t begin = Clock::now_ns();
+
     m_profiler.profile_ERB();
+
+    m_governor.charge(Clock::now_ns() - begin);
   }
 
   bool Context::scan(void) noexcept
   {
-    return m_scanner.scan(/*skip=*/0UL, /*max_frames=*/64UL);
+    const std::uint64_t begin = Clock::now_ns();
+
+    const bool done = m_scanner.scan(/*skip=*/0UL, /*max_frames=*/64UL);
+
+    m_governor.charge(Clock::now_ns() - begin);
+
+    return done;
+  }
+
+  void Context::throttle(void) noexcept
+  {
+    if (m_governor.update())
+    {
+      m_pacer.set_rate(m_governor.get_rate());
+    }
+
+    m_pacer.wait();
   }
 } // namespace pace
@@ -0,0 +1,303 @@
+#include "deflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+  constexpr std::size_t kWindow    = 32768UL;
+  constexpr unsigned    kHashBits  = 15U;
+  constexpr unsigned    kMaxChain  = 16U;
+  constexpr std::size_t kMinMatch  = 3UL;
+  constexpr std::size_t kMaxMatch  = 258UL;
+  constexpr std::size_t kMaxStored = 65535UL;
+
+  constexpr std::array<std::uint16_t, 29> kLengthBase =
+  {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+  };
+
+  constexpr std::array<std::uint8_t, 29> kLengthExtra =
+  {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+  };
+
+  constexpr std::array<std::uint16_t, 30> kDistanceBase =
+  {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+  };
+
+  constexpr std::array<std::uint8_t, 30> kDistanceExtra =
+  {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+  };
+
+  // Bits are packed from the least significant end, as DEFLATE requires.
+  class BitWriter final
+  {
+    std::vector<std::uint8_t>& m_out;
+    std::uint64_t              m_bits{0UL};
+    unsigned                   m_count{0U};
+
+  public:
+    explicit BitWriter(std::vector<std::uint8_t>& out) noexcept : m_out(out) {}
+
+    inline void put(const std::uint32_t bits, const unsigned n) noexcept
+    {
+      m_bits  |= (static_cast<std::uint64_t>(bits) << m_count);
+      m_count += n;
+
+      while (m_count >= 8U)
+      {
+        m_out.push_back(static_cast<std::uint8_t>(m_bits));
+        m_bits  >>= 8;
+        m_count  -= 8U;
+      }
+    }
+
+    // Huffman codes are defined most significant bit first.
+    inline void code(const std::uint32_t code, const unsigned n) noexcept
+    {
+      std::uint32_t reversed = 0U;
+
+      for (unsigned i = 0U; i < n; i++)
+      {
+        reversed |= ((code >> i) & 1U) << (n - 1U - i);
+      }
+
+      put(reversed, n);
+    }
+
+    inline void align(void) noexcept
+    {
+      if (m_count > 0U)
+      {
+        put(0U, 8U - m_count);
+      }
+    }
+  };
+
+  // Fixed literal/length code (RFC 1951 3.2.6).
+  inline void put_symbol(BitWriter& bits, const unsigned symbol) noexcept
+  {
+    if (symbol < 144U)
+    {
+      bits.code(0x30U + symbol, 8U);
+    }
+    else if (symbol < 256U)
+    {
+      bits.code(0x190U + (symbol - 144U), 9U);
+    }
+    else if (symbol < 280U)
+    {
+      bits.code(symbol - 256U, 7U);
+    }
+    else
+    {
+      bits.code(0xC0U + (symbol - 280U), 8U);
+    }
+  }
+
+  inline void put_match(BitWriter& bits, const std::size_t length, const std::size_t distance) noexcept
+  {
+    const std::size_t l = static_cast<std::size_t>(std::upper_bound(kLengthBase.begin(), kLengthBase.end(), length) - kLengthBase.begin()) - 1UL;
+    const std::size_t d = static_cast<std::size_t>(std::upper_bound(kDistanceBase.begin(), kDistanceBase.end(), distance) - kDistanceBase.begin()) - 1UL;
+
+    put_symbol(bits, 257U + static_cast<unsigned>(l));
+    bits.put(static_cast<std::uint32_t>(length - kLengthBase[l]), kLengthExtra[l]);
+    bits.code(static_cast<std::uint32_t>(d), 5U);
+    bits.put(static_cast<std::uint32_t>(distance - kDistanceBase[d]), kDistanceExtra[d]);
+  }
+
+  inline std::uint32_t hash3(const std::uint8_t* p) noexcept
+  {
+    const std::uint32_t v = (static_cast<std::uint32_t>(p[0]) << 16) | (static_cast<std::uint32_t>(p[1]) << 8) | p[2];
+    return (v * 2654435761U) >> (32U - kHashBits);
+  }
+
+  void compress_stored(const std::uint8_t* data, const std::size_t size, std::vector<std::uint8_t>& out) noexcept
+  {
+    std::size_t at = 0UL;
+
+    do
+    {
+      const std::size_t n     = std::min(size - at, kMaxStored);
+      const bool        final = (at + n == size);
+
+      // BFINAL and BTYPE=00, padded to the byte boundary.
+      out.push_back(final ? 1U : 0U);
+      out.push_back(static_cast<std::uint8_t>(n));
+      out.push_back(static_cast<std::uint8_t>(n >> 8));
+      out.push_back(static_cast<std::uint8_t>(~n));
+      out.push_back(static_cast<std::uint8_t>(~n >> 8));
+      out.insert(out.end(), data + at, data + at + n);
+
+      at += n;
+    }
+    while (at < size);
+  }
+
+  void compress_fast(const std::uint8_t* data, const std::size_t size, std::vector<std::uint8_t>& out) noexcept
+  {
+    std::vector<std::int64_t> head(1UL << kHashBits, -1L);
+    std::vector<std::int64_t> prev(kWindow, -1L);
+
+    BitWriter bits(out);
+
+    // One final block with fixed codes.
+    bits.put(1U, 1U);
+    bits.put(1U, 2U);
+
+    auto insert = [&](const std::size_t at) noexcept
+    {
+      const std::uint32_t h = hash3(data + at);
+
+      prev[at & (kWindow - 1UL)] = head[h];
+      head[h]                    = static_cast<std::int64_t>(at);
+    };
+
+    std::size_t i = 0UL;
+
+    while (i < size)
+    {
+      std::size_t best_length   = 0UL;
+      std::size_t best_distance = 0UL;
+
+      if (i + kMinMatch <= size)
+      {
+        const std::size_t limit     = std::min(kMaxMatch, size - i);
+        std::int64_t      candidate = head[hash3(data + i)];
+
+        for (unsigned chain = 0U; chain < kMaxChain && candidate >= 0; chain++)
+        {
+          const std::size_t from = static_cast<std::size_t>(candidate);
+
+          if (i - from > kWindow)
+          {
+            break;
+          }
+
+          std::size_t length = 0UL;
+
+          while (length < limit && data[from + length] == data[i + length])
+          {
+            ++length;
+          }
+
+          if (length > best_length)
+          {
+            best_length   = length;
+            best_distance = i - from;
+
+            if (length == limit)
+            {
+              break;
+            }
+          }
+
+          const std::int64_t next = prev[from & (kWindow - 1UL)];
+
+          // A slot reused by a newer position ends the chain.
+          if (next >= candidate)
+          {
+            break;
+          }
+
+          candidate = next;
+        }
+
+        insert(i);
+      }
+
+      if (best_length < kMinMatch)
+      {
+        put_symbol(bits, data[i]);
+        ++i;
+        continue;
+      }
+
+      put_match(bits, best_length, best_distance);
+
+      for (std::size_t k = 1UL; k < best_length && (i + k + kMinMatch) <= size; k++)
+      {
+        insert(i + k);
+      }
+
+      i += best_length;
+    }
+
+    put_symbol(bits, 256U);
+    bits.align();
+  }
+
+  void put_u32(std::vector<std::uint8_t>& out, const std::uint32_t v) noexcept
+  {
+    for (unsigned shift = 0U; shift < 32U; shift += 8U)
+    {
+      out.push_back(static_cast<std::uint8_t>(v >> shift));
+    }
+  }
+} // namespace
+
+namespace deflate
+{
+  std::uint32_t crc32(const std::uint8_t* data, const std::size_t size, const std::uint32_t crc) noexcept
+  {
+    static const std::array<std::uint32_t, 256> table = []() noexcept
+    {
+      std::array<std::uint32_t, 256> t{};
+
+      for (std::uint32_t n = 0U; n < 256U; n++)
+      {
+        std::uint32_t c = n;
+
+        for (unsigned k = 0U; k < 8U; k++)
+        {
+          c = (c & 1U) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+        }
+
+        t[n] = c;
+      }
+
+      return t;
+    }();
+
+    std::uint32_t c = ~crc;
+
+    for (std::size_t i = 0UL; i < size; i++)
+    {
+      c = table[(c ^ data[i]) & 0xFFU] ^ (c >> 8);
+    }
+
+    return ~c;
+  }
+
+  void compress(const std::uint8_t* data, const std::size_t size, std::vector<std::uint8_t>& out, const Level level) noexcept
+  {
+    if (level == Level::STORE)
+    {
+      compress_stored(data, size, out);
+    }
+    else
+    {
+      compress_fast(data, size, out);
+    }
+  }
+
+  void gzip(const std::uint8_t* data, const std::size_t size, std::vector<std::uint8_t>& out, const Level level) noexcept
+  {
+    // Magic, CM=8 (deflate), no flags, no mtime, no extra flags, OS unknown.
+    static constexpr std::uint8_t kHeader[] = {0x1FU, 0x8BU, 0x08U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0xFFU};
+
+    out.insert(out.end(), kHeader, kHeader + sizeof(kHeader));
+
+    compress(data, size, out, level);
+
+    put_u32(out, crc32(data, size));
+    put_u32(out, static_cast<std::uint32_t>(size));
+  }
+} // namespace deflate
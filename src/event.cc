@@ -1,15 +1,17 @@
+#include "clock.hpp"
 #include "event.hpp"
 
 #include <cstdint>
 #include <iostream>
-#include <string>
 
-Event::Event(const EventType    type_,
-             const float        timestamp_,
-             const std::string& name_) noexcept
-  : type(type_),
-    timestamp(timestamp_),
-    name(std::move(name_)) {}
+Event::Event(const EventType     type_,
+             const std::uint64_t timestamp_,
+             const std::uint32_t name_,
+             const std::uint16_t thread_) noexcept
+  : timestamp(timestamp_),
+    name(name_),
+    type(type_),
+    thread(thread_) {}
 
 void Event::print(void) const noexcept
 {
@@ -28,5 +30,5 @@ void Event::print(void) const noexcept
     default: break;
   }
 
-  std::cout << ", timestamp: " << timestamp << ", name: " << name << " }" << std::endl;
+  std::cout << ", timestamp: " << Clock::get_instance().to_seconds(timestamp) << ", name: " << name << ", thread: " << thread << " }" << std::endl;
 }
@@ -0,0 +1,107 @@
+#include "file_sink.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+FileSink::FileSink(std::string path, std::string_view tag, std::string_view title) noexcept
+  : m_path(std::move(path)),
+    m_tag(tag),
+    m_title(title),
+    m_names()
+{
+}
+
+const std::vector<std::string>& FileSink::m_get_names(void) const noexcept
+{
+  return m_names;
+}
+
+std::string_view FileSink::m_name(const std::uint32_t id) const noexcept
+{
+  return (id < m_names.size()) ? std::string_view(m_names[id]) : std::string_view("?");
+}
+
+void FileSink::define(const std::uint32_t id, std::string_view name) noexcept
+{
+  if (id >= m_names.size())
+  {
+    m_names.resize(static_cast<std::size_t>(id) + 1UL);
+  }
+
+  m_names[id].assign(name.data(), name.size());
+}
+
+void FileSink::flush(void) noexcept
+{
+  m_failed = !m_write();
+}
+
+void FileSink::report(void) noexcept
+{
+  flush();
+
+  if (m_failed)
+  {
+    std::cerr << "[" << m_tag << "] failed to write " << m_path << "\n";
+    return;
+  }
+
+  std::cout << m_title << ": ";
+  m_describe(std::cout);
+  std::cout << " written to " << m_path << std::endl;
+}
+
+const std::string& FileSink::get_path(void) const noexcept
+{
+  return m_path;
+}
+
+bool FileSink::is_failed(void) const noexcept
+{
+  return m_failed;
+}
+
+StackSink::StackSink(std::string path, std::string_view tag, std::string_view title) noexcept
+  : FileSink(std::move(path), tag, title),
+    m_stacks()
+{
+}
+
+void StackSink::m_describe(std::ostream& out) const noexcept
+{
+  out << m_stacks.size() << " stacks, " << m_stacks.get_samples() << " samples";
+}
+
+void StackSink::define(const std::uint32_t id, std::string_view name) noexcept
+{
+  FileSink::define(id, name);
+}
+
+void StackSink::sample(const std::uint64_t,
+                       const std::uint64_t  count,
+                       const std::uint32_t* stack,
+                       const std::size_t    depth) noexcept
+{
+  m_stacks.add(stack, depth, count);
+}
+
+void StackSink::flush(void) noexcept
+{
+  FileSink::flush();
+}
+
+std::size_t StackSink::get_stacks(void) const noexcept
+{
+  return m_stacks.size();
+}
+
+std::uint64_t StackSink::get_samples(void) const noexcept
+{
+  return m_stacks.get_samples();
+}
@@ -0,0 +1,486 @@
+#include "flamegraph.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  constexpr std::uint32_t kRoot = std::numeric_limits<std::uint32_t>::max();
+
+  constexpr double kPad       = 10.0;
+  constexpr double kFontSize  = 12.0;
+  constexpr double kCharWidth = kFontSize * 0.59;
+
+  // Zoom, search and hover details; fg_pad, fg_width, fg_total and fg_charw are defined ahead of it.
+  constexpr std::string_view kScript = R"JS(
+var details, unzoombtn, matchedtxt, searching = false;
+function init(evt) {
+  details = document.getElementById("details").firstChild;
+  unzoombtn = document.getElementById("unzoom");
+  matchedtxt = document.getElementById("matched").firstChild;
+}
+function find_group(node) {
+  for (; node && node.getAttribute; node = node.parentNode) {
+    if (node.nodeName == "g" && node.getAttribute("class") == "f") return node;
+  }
+  return null;
+}
+function frames() { return document.getElementById("frames").getElementsByTagName("g"); }
+function title(g) { return g.getElementsByTagName("title")[0].firstChild.nodeValue; }
+function fname(g) { var t = title(g); return t.substring(0, t.lastIndexOf(" (")); }
+function num(g, a) { return +g.getAttribute(a); }
+function place(g, x, w) {
+  var r = g.getElementsByTagName("rect")[0], t = g.getElementsByTagName("text")[0];
+  var fit = Math.floor(w / fg_charw), name = fname(g);
+  r.setAttribute("x", x.toFixed(1));
+  r.setAttribute("width", w.toFixed(1));
+  t.setAttribute("x", (x + 3).toFixed(1));
+  t.textContent = (fit < 3) ? "" : (name.length <= fit) ? name : name.substring(0, fit - 2) + "..";
+}
+function zoom(z) {
+  var x0 = num(z, "data-x"), w0 = num(z, "data-w"), d0 = num(z, "data-d"), scale = fg_width / w0, gs = frames();
+  unzoombtn.style.opacity = "1.0";
+  for (var i = 0; i < gs.length; i++) {
+    var g = gs[i], x = num(g, "data-x"), w = num(g, "data-w"), d = num(g, "data-d");
+    if (d < d0 && x <= x0 && x + w >= x0 + w0) {
+      g.style.display = ""; g.style.opacity = "0.5"; place(g, fg_pad, fg_width);
+    } else if (d >= d0 && x >= x0 && x + w <= x0 + w0) {
+      g.style.display = ""; g.style.opacity = ""; place(g, fg_pad + (x - x0) * scale, w * scale);
+    } else {
+      g.style.display = "none";
+    }
+  }
+}
+function unzoom() {
+  var gs = frames(), scale = fg_width / fg_total;
+  unzoombtn.style.opacity = "0.0";
+  for (var i = 0; i < gs.length; i++) {
+    gs[i].style.display = ""; gs[i].style.opacity = "";
+    place(gs[i], fg_pad + num(gs[i], "data-x") * scale, num(gs[i], "data-w") * scale);
+  }
+}
+function search(term) {
+  var re = term ? new RegExp(term) : null, gs = frames(), hits = [], covered = 0, end = -1;
+  for (var i = 0; i < gs.length; i++) {
+    var r = gs[i].getElementsByTagName("rect")[0];
+    if (!r.hasAttribute("data-c")) r.setAttribute("data-c", r.getAttribute("fill"));
+    if (re && re.test(fname(gs[i]))) {
+      r.setAttribute("fill", "rgb(230,0,230)");
+      hits.push([num(gs[i], "data-x"), num(gs[i], "data-w")]);
+    } else {
+      r.setAttribute("fill", r.getAttribute("data-c"));
+    }
+  }
+  searching = (re != null);
+  // Nested matches share samples: count each span once, outermost first.
+  hits.sort(function(a, b) { return (a[0] - b[0]) || (b[1] - a[1]); });
+  for (var j = 0; j < hits.length; j++) {
+    if (hits[j][0] >= end) { covered += hits[j][1]; end = hits[j][0] + hits[j][1]; }
+  }
+  matchedtxt.nodeValue = searching ? "Matched: " + (100 * covered / fg_total).toFixed(1) + "%" : " ";
+}
+function search_prompt() {
+  if (searching) { search(null); return; }
+  var term = prompt("Search for (regular expression):", "");
+  if (term) search(term);
+}
+window.addEventListener("click", function(e) {
+  var g = find_group(e.target);
+  if (g) zoom(g);
+  else if (e.target.id == "unzoom") unzoom();
+  else if (e.target.id == "search") search_prompt();
+}, false);
+window.addEventListener("mouseover", function(e) {
+  var g = find_group(e.target);
+  if (g) details.nodeValue = title(g);
+}, false);
+window.addEventListener("mouseout", function(e) {
+  if (find_group(e.target)) details.nodeValue = " ";
+}, false);
+window.addEventListener("keydown", function(e) {
+  if (e.keyCode === 114 || ((e.ctrlKey || e.metaKey) && e.keyCode === 70)) { e.preventDefault(); search_prompt(); }
+}, false);
+)JS";
+
+  // Non-negative v with the given number of decimals, independent of the locale.
+  void write_fixed(Writer& out, const double v, const unsigned decimals) noexcept
+  {
+    std::uint64_t scale = 1UL;
+
+    for (unsigned i = 0U; i < decimals; i++)
+    {
+      scale *= 10UL;
+    }
+
+    const std::uint64_t scaled = static_cast<std::uint64_t>(std::llround(std::max(v, 0.0) * static_cast<double>(scale)));
+
+    out.write_u64(scaled / scale);
+
+    if (decimals > 0U)
+    {
+      std::uint64_t fraction = scaled % scale;
+
+      out.put('.');
+
+      for (std::uint64_t digit = scale / 10UL; digit > 0UL; digit /= 10UL)
+      {
+        out.put(static_cast<char>('0' + (fraction / digit)));
+        fraction %= digit;
+      }
+    }
+  }
+
+  void write_escaped(Writer& out, std::string_view s) noexcept
+  {
+    std::size_t run = 0UL;
+
+    for (std::size_t i = 0UL; i < s.size(); i++)
+    {
+      const char*       entity = nullptr;
+      const std::size_t at     = i;
+
+      switch (s[i])
+      {
+        case '&': entity = "&amp;";  break;
+        case '<': entity = "&lt;";   break;
+        case '>': entity = "&gt;";   break;
+        case '"': entity = "&quot;"; break;
+        default:  continue;
+      }
+
+      out.write(s.substr(run, at - run));
+      out.write(entity);
+      run = at + 1UL;
+    }
+
+    out.write(s.substr(run));
+  }
+
+  // flamegraph.pl's "hot" palette, keyed by name so a function keeps its colour across graphs.
+  void write_colour(Writer& out, std::string_view name) noexcept
+  {
+    std::uint32_t hash = 2166136261U;
+
+    for (const char c : name)
+    {
+      hash = (hash ^ static_cast<std::uint8_t>(c)) * 16777619U;
+    }
+
+    const double v1 = static_cast<double>(hash & 0xFFU)         / 255.0;
+    const double v2 = static_cast<double>((hash >> 8U)  & 0xFFU) / 255.0;
+    const double v3 = static_cast<double>((hash >> 16U) & 0xFFU) / 255.0;
+
+    out.write("rgb(");
+    out.write_u64(static_cast<std::uint64_t>(205.0 + (50.0 * v3)));
+    out.put(',');
+    out.write_u64(static_cast<std::uint64_t>(230.0 * v1));
+    out.put(',');
+    out.write_u64(static_cast<std::uint64_t>(55.0 * v2));
+    out.put(')');
+  }
+} // namespace
+
+FlameGraph::FlameGraph(const StackTable& stacks, const std::vector<std::string>& names, const FlameLayout layout) noexcept
+  : m_nodes(),
+    m_names(names),
+    m_samples(stacks.get_samples()),
+    m_layout(layout)
+{
+  struct Entry final
+  {
+    std::size_t   offset;
+    std::size_t   depth;
+    std::uint64_t count;
+  };
+
+  std::vector<Entry>         entries;
+  std::vector<std::uint32_t> frames;
+  std::uint32_t              ids = static_cast<std::uint32_t>(m_names.size());
+
+  entries.reserve(stacks.size());
+
+  stacks.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    entries.push_back({frames.size(), depth, count});
+
+    if (layout == FlameLayout::REVERSED)
+    {
+      frames.insert(frames.end(), std::make_reverse_iterator(stack + depth), std::make_reverse_iterator(stack));
+    }
+    else
+    {
+      frames.insert(frames.end(), stack, stack + depth);
+    }
+
+    for (std::size_t i = 0UL; i < depth; i++)
+    {
+      ids = std::max(ids, stack[i] + 1U);
+    }
+  });
+
+  // Rank ids by name, so that ordering stacks by rank orders them by name.
+  std::vector<std::uint32_t> order(ids);
+  std::vector<std::uint32_t> rank(ids);
+
+  std::iota(order.begin(), order.end(), 0U);
+  std::sort(order.begin(), order.end(), [this](const std::uint32_t a, const std::uint32_t b) noexcept
+  {
+    const std::string_view x = m_name(a);
+    const std::string_view y = m_name(b);
+
+    return (x != y) ? (x < y) : (a < b);
+  });
+
+  for (std::uint32_t i = 0U; i < ids; i++)
+  {
+    rank[order[i]] = i;
+  }
+
+  for (std::uint32_t& frame : frames)
+  {
+    frame = rank[frame];
+  }
+
+  std::sort(entries.begin(), entries.end(), [&frames](const Entry& a, const Entry& b) noexcept
+  {
+    return std::lexicographical_compare(frames.begin() + static_cast<std::ptrdiff_t>(a.offset),
+                                        frames.begin() + static_cast<std::ptrdiff_t>(a.offset + a.depth),
+                                        frames.begin() + static_cast<std::ptrdiff_t>(b.offset),
+                                        frames.begin() + static_cast<std::ptrdiff_t>(b.offset + b.depth));
+  });
+
+  // path[d] is the open node at depth d (the root at 0); cursor[d] is where
+  // the next node at depth d starts.
+  std::vector<std::size_t>   path{0UL};
+  std::vector<std::uint64_t> cursor{0UL, 0UL};
+  const std::uint32_t*       previous = nullptr;
+
+  m_nodes.push_back({kRoot, 0U, 0UL, m_samples});
+
+  for (const Entry& entry : entries)
+  {
+    const std::uint32_t* stack = frames.data() + entry.offset;
+    std::size_t          lcp   = 0UL;
+
+    while (lcp + 1UL < path.size() && lcp < entry.depth && previous[lcp] == stack[lcp])
+    {
+      ++lcp;
+    }
+
+    path.resize(lcp + 1UL);
+
+    if (cursor.size() < entry.depth + 2UL)
+    {
+      cursor.resize(entry.depth + 2UL, 0UL);
+    }
+
+    for (std::size_t i = lcp; i < entry.depth; i++)
+    {
+      const std::uint32_t  depth = static_cast<std::uint32_t>(i + 1UL);
+      const std::uint64_t  x     = cursor[depth];
+
+      path.push_back(m_nodes.size());
+      m_nodes.push_back({order[stack[i]], depth, x, 0UL});
+
+      cursor[depth + 1UL] = x;
+    }
+
+    for (std::size_t d = 1UL; d < path.size(); d++)
+    {
+      m_nodes[path[d]].total += entry.count;
+      cursor[d]              += entry.count;
+    }
+
+    previous = stack;
+  }
+}
+
+std::string_view FlameGraph::m_name(const std::uint32_t id) const noexcept
+{
+  if (id == kRoot)
+  {
+    return "all";
+  }
+
+  return (id < m_names.size() && !m_names[id].empty()) ? std::string_view(m_names[id]) : std::string_view("?");
+}
+
+int FlameGraph::write_svg(const std::string& path, const FlameGraphStyle& style) const noexcept
+{
+  Writer out(path);
+
+  if (!out.is_open())
+  {
+    return kIoError;
+  }
+
+  const double fh       = style.frame_height;
+  const double usable   = std::max(style.width - (2.0 * kPad), 1.0);
+  const double per      = (m_samples > 0UL) ? (usable / static_cast<double>(m_samples)) : 0.0;
+  const double top      = fh * 3.0;
+  const double bottom   = fh * 2.0;
+  const bool   hanging  = (m_layout != FlameLayout::FLAME);
+
+  // A node too narrow to draw is skipped with everything above it: its
+  // subtree follows it in pre-order at greater depths.
+  auto for_each_drawn = [this, per, &style](auto&& visit) noexcept
+  {
+    std::uint32_t pruned = std::numeric_limits<std::uint32_t>::max();
+
+    for (const Node& node : m_nodes)
+    {
+      if (node.depth > pruned)
+      {
+        continue;
+      }
+
+      pruned = std::numeric_limits<std::uint32_t>::max();
+
+      if (static_cast<double>(node.total) * per < style.min_width)
+      {
+        pruned = node.depth;
+        continue;
+      }
+
+      visit(node);
+    }
+  };
+
+  std::uint32_t max_depth = 0U;
+
+  for_each_drawn([&max_depth](const Node& node) noexcept
+  {
+    max_depth = std::max(max_depth, node.depth);
+  });
+
+  const double height = top + (static_cast<double>(max_depth + 1U) * fh) + bottom;
+
+  out.write("<?xml version=\"1.0\" standalone=\"no\"?>\n"
+            "<svg version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\" onload=\"init(evt)\" width=\"");
+  write_fixed(out, style.width, 0U);
+  out.write("\" height=\"");
+  write_fixed(out, height, 0U);
+  out.write("\" viewBox=\"0 0 ");
+  write_fixed(out, style.width, 0U);
+  out.put(' ');
+  write_fixed(out, height, 0U);
+  out.write("\">\n<style type=\"text/css\">\n"
+            "text { font-family: Verdana, sans-serif; font-size: 12px; fill: rgb(0,0,0); }\n"
+            "#title { text-anchor: middle; font-size: 17px; }\n"
+            "#search, #unzoom { cursor: pointer; }\n"
+            "#frames > *:hover { stroke: black; stroke-width: 0.5; cursor: pointer; }\n"
+            "</style>\n<script type=\"text/ecmascript\"><![CDATA[\nvar fg_pad = ");
+  write_fixed(out, kPad, 1U);
+  out.write(", fg_width = ");
+  write_fixed(out, usable, 2U);
+  out.write(", fg_total = ");
+  out.write_u64(std::max<std::uint64_t>(m_samples, 1UL));
+  out.write(", fg_charw = ");
+  write_fixed(out, kCharWidth, 2U);
+  out.write(";");
+  out.write(kScript);
+  out.write("]]></script>\n<rect x=\"0\" y=\"0\" width=\"100%\" height=\"100%\" fill=\"rgb(248,248,232)\"/>\n"
+            "<text id=\"title\" x=\"");
+  write_fixed(out, style.width / 2.0, 1U);
+  out.write("\" y=\"24\">");
+  write_escaped(out, style.title);
+  out.write("</text>\n<text id=\"unzoom\" x=\"10\" y=\"24\" style=\"opacity:0\">Reset Zoom</text>\n<text id=\"search\" x=\"");
+  write_fixed(out, style.width - kPad - 100.0, 1U);
+  out.write("\" y=\"24\">Search</text>\n<text id=\"matched\" x=\"");
+  write_fixed(out, style.width - kPad - 100.0, 1U);
+  out.write("\" y=\"");
+  write_fixed(out, height - 17.0, 1U);
+  out.write("\"> </text>\n<text id=\"details\" x=\"10\" y=\"");
+  write_fixed(out, height - 17.0, 1U);
+  out.write("\"> </text>\n<g id=\"frames\">\n");
+
+  for_each_drawn([&](const Node& node) noexcept
+  {
+    const std::string_view name = m_name(node.id);
+    const double           x    = kPad + (static_cast<double>(node.x) * per);
+    const double           w    = static_cast<double>(node.total) * per;
+    const double           y    = hanging ? (top + (static_cast<double>(node.depth) * fh))
+                                          : (height - bottom - (static_cast<double>(node.depth + 1U) * fh));
+    const std::size_t      fit  = static_cast<std::size_t>(w / kCharWidth);
+
+    out.write("<g class=\"f\" data-x=\"");
+    out.write_u64(node.x);
+    out.write("\" data-w=\"");
+    out.write_u64(node.total);
+    out.write("\" data-d=\"");
+    out.write_u64(node.depth);
+    out.write("\"><title>");
+    write_escaped(out, name);
+    out.write(" (");
+    out.write_u64(node.total);
+    out.write(" samples, ");
+    write_fixed(out, (static_cast<double>(node.total) * 100.0) / static_cast<double>(std::max<std::uint64_t>(m_samples, 1UL)), 2U);
+    out.write("%)</title><rect x=\"");
+    write_fixed(out, x, 1U);
+    out.write("\" y=\"");
+    write_fixed(out, y, 1U);
+    out.write("\" width=\"");
+    write_fixed(out, w, 1U);
+    out.write("\" height=\"");
+    write_fixed(out, fh - 1.0, 1U);
+    out.write("\" fill=\"");
+    write_colour(out, name);
+    out.write("\" rx=\"2\" ry=\"2\"/><text x=\"");
+    write_fixed(out, x + 3.0, 1U);
+    out.write("\" y=\"");
+    write_fixed(out, y + (fh * 0.7), 1U);
+    out.write("\">");
+
+    // Same truncation as place() in the script.
+    if (fit >= 3UL)
+    {
+      if (name.size() <= fit)
+      {
+        write_escaped(out, name);
+      }
+      else
+      {
+        write_escaped(out, name.substr(0UL, fit - 2UL));
+        out.write("..");
+      }
+    }
+
+    out.write("</text></g>\n");
+  });
+
+  out.write("</g>\n</svg>\n");
+
+  return (out.close() == Writer::kOk) ? kOk : kIoError;
+}
+
+std::size_t FlameGraph::get_nodes(void) const noexcept
+{
+  return m_nodes.size();
+}
+
+std::uint64_t FlameGraph::get_samples(void) const noexcept
+{
+  return m_samples;
+}
+
+FlameGraphWriter::FlameGraphWriter(std::string path, const FlameLayout layout) noexcept
+  : StackSink(std::move(path), "flamegraph", "Flame graph"),
+    m_layout(layout)
+{
+}
+
+bool FlameGraphWriter::m_write(void) noexcept
+{
+  const FlameGraph graph(m_stacks, m_get_names(), m_layout);
+
+  return graph.write_svg(get_path()) == FlameGraph::kOk;
+}
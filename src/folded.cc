@@ -0,0 +1,38 @@
+#include "folded.hpp"
+#include "writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+FoldedWriter::FoldedWriter(std::string path) noexcept
+  : StackSink(std::move(path), "folded", "Folded stacks")
+{
+}
+
+bool FoldedWriter::m_write(void) noexcept
+{
+  Writer out(get_path());
+
+  m_stacks.for_each([this, &out](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    folded::write_stack(out, stack, depth, [this](const std::uint32_t id) noexcept
+    {
+      return m_name(id);
+    });
+
+    out.put(' ');
+    out.write_u64(count);
+    out.put('\n');
+  });
+
+  m_bytes = out.get_bytes();
+
+  return out.close() == Writer::kOk;
+}
+
+std::uint64_t FoldedWriter::get_bytes(void) const noexcept
+{
+  return m_bytes;
+}
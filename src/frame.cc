@@ -1,5 +1,18 @@
 #include "frame.hpp"
+#include "line_location.hpp"
 #include "snapshot.hpp"
 
-Frame::Frame(const float timestamp_, Snapshot snapshot_) noexcept
-  : timestamp(timestamp_), snapshot(std::move(snapshot_)) {}
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+Frame::Frame(const std::uint64_t       timestamp_,
+             const std::uint64_t       hash_,
+             Snapshot                  snapshot_,
+             std::vector<LineLocation> lines_) noexcept
+  : timestamp(timestamp_),
+    last_timestamp(timestamp_),
+    count(1UL),
+    hash(hash_),
+    snapshot(std::move(snapshot_)),
+    lines(std::move(lines_)) {}
@@ -0,0 +1,79 @@
+#include "governor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+Governor::Governor(const double budget, const double max_rate) noexcept
+  : m_budget(budget),
+    m_max_rate(max_rate),
+    m_rate(max_rate) {}
+
+void Governor::charge(const std::uint64_t ns) noexcept
+{
+  m_pending_ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+bool Governor::update(void) noexcept
+{
+  const std::uint64_t cost = m_pending_ns.exchange(0UL, std::memory_order_relaxed);
+
+  m_total_cost_ns += cost;
+
+  if (m_avg_cost_ns == 0.0)
+  {
+    m_avg_cost_ns = static_cast<double>(cost);
+  }
+  else
+  {
+    m_avg_cost_ns += kSmoothing * (static_cast<double>(cost) - m_avg_cost_ns);
+  }
+
+  if (!is_enabled() || m_avg_cost_ns <= 0.0 || (++m_updates % kControlInterval) != 0UL)
+  {
+    return false;
+  }
+
+  const double target = std::clamp((m_budget * 1e9) / m_avg_cost_ns, kMinRate, m_max_rate);
+
+  if (std::fabs(target - m_rate) < (kHysteresis * m_rate))
+  {
+    return false;
+  }
+
+  m_rate = target;
+  ++m_adjustments;
+
+  return true;
+}
+
+bool Governor::is_enabled(void) const noexcept
+{
+  return (m_budget > 0.0);
+}
+
+double Governor::get_budget(void) const noexcept
+{
+  return m_budget;
+}
+
+double Governor::get_rate(void) const noexcept
+{
+  return m_rate;
+}
+
+double Governor::get_avg_cost_ns(void) const noexcept
+{
+  return m_avg_cost_ns;
+}
+
+std::uint64_t Governor::get_total_cost_ns(void) const noexcept
+{
+  return m_total_cost_ns + m_pending_ns.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Governor::get_adjustments(void) const noexcept
+{
+  return m_adjustments;
+}
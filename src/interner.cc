@@ -0,0 +1,88 @@
+#include "interner.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+Interner::Interner() noexcept : m_strings(), m_oversized(), m_ids() {}
+
+Interner::~Interner() noexcept
+{
+  for (auto& block : m_blocks)
+  {
+    delete[] block.load(std::memory_order_relaxed);
+  }
+}
+
+const char* Interner::m_store(std::string_view s) noexcept
+{
+  char* data = static_cast<char*>(m_strings.allocate(s.size() + 1UL, 1UL));
+
+  if (data == nullptr)
+  {
+    // Longer than a chunk: give it its own allocation.
+    m_oversized.emplace_back(new char[s.size() + 1UL]);
+    data = m_oversized.back().get();
+  }
+
+  std::memcpy(data, s.data(), s.size());
+  data[s.size()] = '\0';
+
+  return data;
+}
+
+std::uint32_t Interner::intern(std::string_view s) noexcept
+{
+  const auto it = m_ids.find(s);
+
+  if (it != m_ids.end())
+  {
+    return it->second;
+  }
+
+  const std::uint32_t id    = m_count.load(std::memory_order_relaxed);
+  const std::size_t   block = (static_cast<std::size_t>(id) >> kBlockBits);
+
+  if (block >= kMaxBlocks)
+  {
+    return kInvalid;
+  }
+
+  Entry* entries = m_blocks[block].load(std::memory_order_relaxed);
+
+  if (entries == nullptr)
+  {
+    entries = new Entry[kBlockSize];
+    m_blocks[block].store(entries, std::memory_order_release);
+  }
+
+  const char* data = m_store(s);
+
+  entries[id & (kBlockSize - 1UL)] = {data, static_cast<std::uint32_t>(s.size())};
+  m_ids.emplace(std::string_view(data, s.size()), id);
+
+  m_count.store(id + 1U, std::memory_order_release);
+
+  return id;
+}
+
+std::string_view Interner::name(const std::uint32_t id) const noexcept
+{
+  if (id >= m_count.load(std::memory_order_acquire))
+  {
+    return {};
+  }
+
+  const Entry* entries = m_blocks[static_cast<std::size_t>(id) >> kBlockBits].load(std::memory_order_acquire);
+  const Entry& entry   = entries[id & (kBlockSize - 1UL)];
+
+  return {entry.data, entry.size};
+}
+
+std::uint32_t Interner::size(void) const noexcept
+{
+  return m_count.load(std::memory_order_acquire);
+}
@@ -0,0 +1,199 @@
+#include "line_histogram.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  struct Function final
+  {
+    std::string_view                                  name;
+    const std::string*                                file{nullptr};
+    std::uint64_t                                     samples{0UL};
+    std::unordered_map<std::uint32_t, std::uint64_t> lines;
+  };
+
+  // Source files, read once each; an unreadable file stays empty.
+  class Sources final
+  {
+    std::unordered_map<std::string, std::vector<std::string>> m_files;
+
+  public:
+    std::string_view line(const std::string& file, const std::uint32_t line) noexcept
+    {
+      auto [it, inserted] = m_files.try_emplace(file);
+
+      if (inserted && !file.empty())
+      {
+        std::ifstream in(file);
+        std::string   text;
+
+        while (std::getline(in, text))
+        {
+          it->second.push_back(std::move(text));
+        }
+      }
+
+      const std::vector<std::string>& lines = it->second;
+
+      if (line == 0U || line > lines.size())
+      {
+        return {};
+      }
+
+      std::string_view text = lines[line - 1U];
+
+      while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+      {
+        text.remove_prefix(1UL);
+      }
+
+      while (!text.empty() && (text.back() == '\r' || text.back() == ' '))
+      {
+        text.remove_suffix(1UL);
+      }
+
+      return text;
+    }
+  };
+
+  double percent(const std::uint64_t part, const std::uint64_t whole) noexcept
+  {
+    return (whole > 0UL) ? (static_cast<double>(part) / static_cast<double>(whole)) * 100.0 : 0.0;
+  }
+} // namespace
+
+int LineHistogram::write(const std::string& path, const std::size_t top_lines) const noexcept
+{
+  Writer out(path);
+
+  if (!out.is_open())
+  {
+    return kIoError;
+  }
+
+  // Fold PCs onto (function, file) and then onto lines.
+  std::unordered_map<std::string, Function> by_function;
+
+  for (const auto& [pc, entry] : m_pcs)
+  {
+    const std::string_view name = entry.line.function.empty() ? std::string_view("<unknown>") : std::string_view(entry.line.function);
+
+    Function& function = by_function[std::string(name) + '\0' + entry.line.file];
+
+    function.file     = &entry.line.file;
+    function.samples += entry.samples;
+    function.lines[entry.line.line] += entry.samples;
+  }
+
+  std::vector<Function*> functions;
+
+  for (auto& [key, function] : by_function)
+  {
+    function.name = std::string_view(key.data(), key.find('\0'));
+    functions.push_back(&function);
+  }
+
+  std::sort(functions.begin(), functions.end(), [](const Function* a, const Function* b) noexcept
+  {
+    return (a->samples != b->samples) ? (a->samples > b->samples) : (a->name < b->name);
+  });
+
+  char row[96];
+
+  out.write("Line profile: ");
+  out.write_u64(m_samples);
+  out.write(" samples at ");
+  out.write_u64(m_pcs.size());
+  out.write(" distinct PCs\n");
+
+  Sources                                              sources;
+  std::vector<std::pair<std::uint32_t, std::uint64_t>> lines;
+
+  for (const Function* function : functions)
+  {
+    (void)std::snprintf(row, sizeof(row), " %llu samples (%.1f%%)", static_cast<unsigned long long>(function->samples),
+                        percent(function->samples, m_samples));
+
+    out.put('\n');
+    out.write(function->name);
+    out.write(row);
+
+    if (!function->file->empty())
+    {
+      out.write("  ");
+      out.write(*function->file);
+    }
+
+    out.write("\n        line    samples       %\n");
+
+    lines.assign(function->lines.begin(), function->lines.end());
+
+    std::sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) noexcept
+    {
+      return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+    });
+
+    std::uint64_t rest = 0UL;
+
+    for (std::size_t i = 0UL; i < lines.size(); i++)
+    {
+      const auto [line, samples] = lines[i];
+
+      if (i >= top_lines)
+      {
+        rest += samples;
+        continue;
+      }
+
+      if (line == 0U)
+      {
+        (void)std::snprintf(row, sizeof(row), "%12s %10llu %6.1f%%", "?", static_cast<unsigned long long>(samples), percent(samples, m_samples));
+      }
+      else
+      {
+        (void)std::snprintf(row, sizeof(row), "%12u %10llu %6.1f%%", line, static_cast<unsigned long long>(samples), percent(samples, m_samples));
+      }
+
+      out.write(row);
+
+      const std::string_view source = sources.line(*function->file, line);
+
+      if (!source.empty())
+      {
+        out.write("  ");
+        out.write(source);
+      }
+
+      out.put('\n');
+    }
+
+    if (rest > 0UL)
+    {
+      (void)std::snprintf(row, sizeof(row), "         ... %zu more lines, %llu samples\n", lines.size() - top_lines,
+                          static_cast<unsigned long long>(rest));
+      out.write(row);
+    }
+  }
+
+  return (out.close() == Writer::kOk) ? kOk : kIoError;
+}
+
+std::size_t LineHistogram::get_pcs(void) const noexcept
+{
+  return m_pcs.size();
+}
+
+std::uint64_t LineHistogram::get_samples(void) const noexcept
+{
+  return m_samples;
+}
@@ -0,0 +1,170 @@
+#include "pacer.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <mmsystem.h>
+
+  #ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+    #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+  #endif
+#endif
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  #include <time.h>
+#endif
+
+namespace
+{
+  constexpr std::uint64_t kNanosPerSecond = 1'000'000'000UL;
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  // How early the timer is set to fire: a high-resolution timer wakes
+  // within a few tens of microseconds, a plain one at 1 ms system timer
+  // resolution within a millisecond or so.
+  constexpr std::uint64_t kHighResolutionSpinNs = 200'000UL;
+  constexpr std::uint64_t kCoarseSpinNs         = 1'500'000UL;
+#endif
+} // namespace
+
+Pacer::Pacer(const double rate_hz) noexcept
+{
+  set_rate(rate_hz);
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  // Sleep and sleep_until round up to the 15.6 ms system tick, too coarse
+  // for rates of 100 Hz and more.
+  m_timer   = ::CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+  m_spin_ns = kHighResolutionSpinNs;
+
+  if (m_timer == nullptr)
+  {
+    // Before Windows 10 1803: a plain timer, with the system tick raised
+    // to 1 ms for as long as this Pacer lives.
+    m_raised_period = (::timeBeginPeriod(1U) == TIMERR_NOERROR);
+    m_timer         = ::CreateWaitableTimerExW(nullptr, nullptr, 0U, TIMER_ALL_ACCESS);
+    m_spin_ns       = kCoarseSpinNs;
+  }
+#endif
+}
+
+Pacer::~Pacer() noexcept
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+  if (m_timer != nullptr)
+  {
+    (void)::CloseHandle(m_timer);
+  }
+
+  if (m_raised_period)
+  {
+    (void)::timeEndPeriod(1U);
+  }
+#endif
+}
+
+std::uint64_t Pacer::m_now_ns(void) noexcept
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+#else
+  struct timespec ts;
+  (void)::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (static_cast<std::uint64_t>(ts.tv_sec) * kNanosPerSecond) + static_cast<std::uint64_t>(ts.tv_nsec);
+#endif
+}
+
+void Pacer::m_sleep_until_ns(const std::uint64_t deadline_ns) noexcept
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+  const std::uint64_t now = m_now_ns();
+
+  if (m_timer != nullptr && deadline_ns > now + m_spin_ns)
+  {
+    // Due times are relative (negative, in 100 ns units): absolute ones are
+    // UTC and move with clock adjustments. It is recomputed from the
+    // monotonic deadline on every wait, so the schedule still does not drift.
+    LARGE_INTEGER due;
+    due.QuadPart = -static_cast<LONGLONG>((deadline_ns - now - m_spin_ns) / 100UL);
+
+    if (::SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE) != FALSE)
+    {
+      (void)::WaitForSingleObject(m_timer, INFINITE);
+    }
+  }
+
+  while (m_now_ns() < deadline_ns)
+  {
+    YieldProcessor();
+  }
+#else
+  struct timespec ts;
+  ts.tv_sec  = static_cast<time_t>(deadline_ns / kNanosPerSecond);
+  ts.tv_nsec = static_cast<long>(deadline_ns % kNanosPerSecond);
+
+  while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+  {
+    // Absolute deadline: simply retry after a signal.
+  }
+#endif
+}
+
+void Pacer::start(void) noexcept
+{
+  m_deadline_ns = m_now_ns();
+  m_ticks       = 0UL;
+  m_missed      = 0UL;
+}
+
+void Pacer::wait(void) noexcept
+{
+  std::uint64_t next = m_deadline_ns + m_period_ns;
+  const std::uint64_t now = m_now_ns();
+
+  if (now >= next)
+  {
+    // Overran: run the most recent tick right away and drop the ones in
+    // between (like a timerfd expiration count).
+    const std::uint64_t late = (now - next) / m_period_ns;
+
+    m_missed     += late;
+    m_deadline_ns = next + (late * m_period_ns);
+    ++m_ticks;
+    return;
+  }
+
+  m_sleep_until_ns(next);
+
+  m_deadline_ns = next;
+  ++m_ticks;
+}
+
+void Pacer::set_rate(const double rate_hz) noexcept
+{
+  const double hz = (rate_hz > 0.0) ? rate_hz : 1.0;
+  const auto period = static_cast<std::uint64_t>(static_cast<double>(kNanosPerSecond) / hz);
+
+  m_period_ns = (period > 0UL) ? period : 1UL;
+}
+
+double Pacer::get_rate(void) const noexcept
+{
+  return static_cast<double>(kNanosPerSecond) / static_cast<double>(m_period_ns);
+}
+
+std::uint64_t Pacer::get_ticks(void) const noexcept
+{
+  return m_ticks;
+}
+
+std::uint64_t Pacer::get_missed(void) const noexcept
+{
+  return m_missed;
+}
@@ -0,0 +1,217 @@
+#include "deflate.hpp"
+#include "pprof.hpp"
+#include "protobuf.hpp"
+#include "writer.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // profile.proto field numbers.
+  namespace field
+  {
+    constexpr std::uint32_t kSampleType    = 1U;
+    constexpr std::uint32_t kSample        = 2U;
+    constexpr std::uint32_t kLocation      = 4U;
+    constexpr std::uint32_t kFunction      = 5U;
+    constexpr std::uint32_t kStringTable   = 6U;
+    constexpr std::uint32_t kTimeNanos     = 9U;
+    constexpr std::uint32_t kDurationNanos = 10U;
+    constexpr std::uint32_t kPeriodType    = 11U;
+    constexpr std::uint32_t kPeriod        = 12U;
+
+    constexpr std::uint32_t kValueTypeType = 1U;
+    constexpr std::uint32_t kValueTypeUnit = 2U;
+
+    constexpr std::uint32_t kSampleLocation = 1U;
+    constexpr std::uint32_t kSampleValue    = 2U;
+
+    constexpr std::uint32_t kLocationId   = 1U;
+    constexpr std::uint32_t kLocationLine = 4U;
+    constexpr std::uint32_t kLineFunction = 1U;
+
+    constexpr std::uint32_t kFunctionId         = 1U;
+    constexpr std::uint32_t kFunctionName       = 2U;
+    constexpr std::uint32_t kFunctionSystemName = 3U;
+  } // namespace field
+
+  // Fixed head of the string table; function names follow.
+  constexpr std::string_view kStrings[] = {"", "samples", "count", "wall", "nanoseconds"};
+
+  constexpr std::uint64_t kSamples     = 1UL;
+  constexpr std::uint64_t kCount       = 2UL;
+  constexpr std::uint64_t kWall        = 3UL;
+  constexpr std::uint64_t kNanoseconds = 4UL;
+  constexpr std::uint64_t kFirstName   = 5UL;
+
+  void value_type(protobuf::Encoder& out, protobuf::Encoder& scratch, const std::uint32_t at, const std::uint64_t type, const std::uint64_t unit) noexcept
+  {
+    scratch.clear();
+    scratch.varint(field::kValueTypeType, type);
+    scratch.varint(field::kValueTypeUnit, unit);
+    out.message(at, scratch);
+  }
+} // namespace
+
+namespace pprof
+{
+  void encode(const StackTable&               stacks,
+              const std::vector<std::string>& names,
+              const PprofInfo&                info,
+              std::vector<std::uint8_t>&      out) noexcept
+  {
+    protobuf::Encoder profile;
+    protobuf::Encoder scratch;
+    protobuf::Encoder line;
+
+    value_type(profile, scratch, field::kSampleType, kSamples, kCount);
+
+    if (info.period_ns > 0UL)
+    {
+      value_type(profile, scratch, field::kSampleType, kWall, kNanoseconds);
+    }
+
+    // Samples, innermost location first; remember which ids occur.
+    std::vector<bool>          used(names.size(), false);
+    std::vector<std::uint64_t> locations;
+
+    stacks.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+    {
+      locations.clear();
+
+      for (std::size_t i = depth; i > 0UL; i--)
+      {
+        const std::uint32_t id = stack[i - 1UL];
+
+        if (id >= used.size())
+        {
+          used.resize(static_cast<std::size_t>(id) + 1UL, false);
+        }
+
+        used[id] = true;
+        locations.push_back(static_cast<std::uint64_t>(id) + 1UL);
+      }
+
+      const std::uint64_t values[] = {count, count * info.period_ns};
+
+      scratch.clear();
+      scratch.packed(field::kSampleLocation, locations.data(), locations.size());
+      scratch.packed(field::kSampleValue, values, (info.period_ns > 0UL) ? 2UL : 1UL);
+      profile.message(field::kSample, scratch);
+    });
+
+    // One Location and one Function per id in use; the name's string index
+    // follows from its rank among them.
+    std::uint64_t next_string = kFirstName;
+
+    for (std::size_t id = 0UL; id < used.size(); id++)
+    {
+      if (!used[id])
+      {
+        continue;
+      }
+
+      line.clear();
+      line.varint(field::kLineFunction, id + 1UL);
+
+      scratch.clear();
+      scratch.varint(field::kLocationId, id + 1UL);
+      scratch.message(field::kLocationLine, line);
+      profile.message(field::kLocation, scratch);
+
+      scratch.clear();
+      scratch.varint(field::kFunctionId, id + 1UL);
+      scratch.varint(field::kFunctionName, next_string);
+      scratch.varint(field::kFunctionSystemName, next_string);
+      profile.message(field::kFunction, scratch);
+
+      ++next_string;
+    }
+
+    for (const std::string_view s : kStrings)
+    {
+      profile.bytes(field::kStringTable, s);
+    }
+
+    for (std::size_t id = 0UL; id < used.size(); id++)
+    {
+      if (used[id])
+      {
+        profile.bytes(field::kStringTable, (id < names.size() && !names[id].empty()) ? std::string_view(names[id]) : std::string_view("?"));
+      }
+    }
+
+    profile.varint(field::kTimeNanos, info.time_ns);
+    profile.varint(field::kDurationNanos, info.duration_ns);
+
+    if (info.period_ns > 0UL)
+    {
+      value_type(profile, scratch, field::kPeriodType, kWall, kNanoseconds);
+      profile.varint(field::kPeriod, info.period_ns);
+    }
+
+    const std::vector<std::uint8_t>& message = profile.data();
+
+    if (info.compress)
+    {
+      deflate::gzip(message.data(), message.size(), out);
+    }
+    else
+    {
+      out.insert(out.end(), message.begin(), message.end());
+    }
+  }
+
+  int write(const std::string&              path,
+            const StackTable&               stacks,
+            const std::vector<std::string>& names,
+            const PprofInfo&                info) noexcept
+  {
+    std::vector<std::uint8_t> bytes;
+
+    encode(stacks, names, info, bytes);
+
+    Writer out(path);
+
+    if (!out.is_open())
+    {
+      return kIoError;
+    }
+
+    out.write(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+
+    return (out.close() == Writer::kOk) ? kOk : kIoError;
+  }
+} // namespace pprof
+
+PprofWriter::PprofWriter(std::string path, const std::uint64_t nominal_period_ns, const bool compress) noexcept
+  : StackSink(std::move(path), "pprof", "pprof profile"),
+    m_nominal_period_ns(nominal_period_ns),
+    m_start_ns(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::system_clock::now().time_since_epoch()).count())),
+    m_compress(compress)
+{
+}
+
+void PprofWriter::finish(const std::uint64_t duration_ns, const std::uint64_t ticks) noexcept
+{
+  m_duration_ns = duration_ns;
+  m_ticks       = ticks;
+}
+
+bool PprofWriter::m_write(void) noexcept
+{
+  PprofInfo info;
+  info.time_ns     = m_start_ns;
+  info.period_ns   = (m_ticks > 0UL && m_duration_ns > 0UL) ? (m_duration_ns / m_ticks) : m_nominal_period_ns;
+  info.duration_ns = (m_duration_ns > 0UL) ? m_duration_ns : (m_stacks.get_samples() * info.period_ns);
+  info.compress    = m_compress;
+
+  return pprof::write(get_path(), m_stacks, m_get_names(), info) == pprof::kOk;
+}
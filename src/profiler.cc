@@ -1,14 +1,21 @@
+#include "chrome_trace.hpp"
 #include "clock.hpp"
 #include "common.hpp"
 #include "event.hpp"
+#include "histogram.hpp"
 #include "icontext.hpp"
+#include "interner.hpp"
+#include "isink.hpp"
+#include "metrics.hpp"
+#include "line_location.hpp"
 #include "profiler.hpp"
+#include "sample_profile.hpp"
 #include "snapshot.hpp"
 #include "stack.hpp"
-#include "trace.hpp"
 #include "trie.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
@@ -18,21 +25,55 @@
 #include <iterator>
 #include <string>
 #include <thread>
-#include <tuple>
 #include <vector>
 
-Profiler::Profiler() noexcept : m_num_captured_samples(0UL), m_previous_snapshot(), m_queue() {}
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
 
-void Profiler::finalize(void) noexcept
+Profiler::Profiler() noexcept : m_num_captured_samples(0UL),
+                                m_interner(),
+                                m_previous_ids(),
+                                m_current_ids(),
+                                m_log(),
+                                m_stacks(1UL)
+{
+  m_previous_ids.reserve(128UL);
+  m_current_ids.reserve(128UL);
+}
+
+void Profiler::finalize(const std::uint64_t ticks) noexcept
 {
   Clock& clock = Clock::get_instance();
-  const std::chrono::duration<float> elapsed_seconds = (clock.get_stop() - clock.get_start());
-  m_profile(elapsed_seconds.count(), {});
+
+  const std::uint64_t stop = clock.get_stop() - clock.get_start();
+
+  // Close what is still open on every thread; m_profile parks the current
+  // one as it switches, so decide which threads to visit up front.
+  std::vector<std::uint16_t> open{m_thread};
+
+  for (std::size_t thread = 0UL; thread < m_parked_ids.size(); thread++)
+  {
+    if (thread != m_thread && !m_parked_ids[thread].empty())
+    {
+      open.push_back(static_cast<std::uint16_t>(thread));
+    }
+  }
+
+  for (const std::uint16_t thread : open)
+  {
+    m_profile(thread, stop, 0UL, {});
+  }
+
+  for (ISink* sink : m_sinks)
+  {
+    sink->finish(clock.to_ns(stop), ticks);
+  }
 }
 
 void Profiler::profile(void) noexcept
 {
-  auto frame_buffer = *m_frame_buffer;
+  auto& frame_buffer = *m_frame_buffer;
   bool empty;
 
   for (;;)
@@ -54,13 +95,13 @@ void Profiler::profile(void) noexcept
       common::fatal_trap();
     }
 
-    m_profile(frame.timestamp, frame.snapshot);
+    m_profile(frame);
   }
 }
 
 void Profiler::profile_ERB(void) noexcept
 {
-  auto frame_buffer = *m_frame_buffer;
+  auto& frame_buffer = *m_frame_buffer;
   std::size_t size;
 
   if (frame_buffer.size(size))
@@ -84,7 +125,7 @@ void Profiler::profile_ERB(void) noexcept
       common::fatal_trap();
     }
 
-    m_profile(frame.timestamp, frame.snapshot);
+    m_profile(frame);
 
     if (frame_buffer.empty(empty))
     {
@@ -98,156 +139,413 @@ void Profiler::profile_ERB(void) noexcept
   }
 }
 
-void Profiler::m_profile(const float timestamp, Snapshot snapshot) noexcept
+void Profiler::m_profile(const Frame& frame) noexcept
 {
-  if (snapshot.empty())
+  if (m_trace != nullptr && !frame.thread_name.empty())
   {
-    if (m_previous_snapshot.empty() == false)
-    {
-      for (auto it = m_previous_snapshot.rbegin(); it != m_previous_snapshot.rend(); it++)
-      {
-        if (m_queue.emplace(EventType::END, timestamp, *it))
-        {
-          common::fatal_trap();
-        }
-      }
+    m_trace->thread_name(kTraceThread + frame.thread, frame.thread_name);
+  }
+
+  if (m_sample_profile != nullptr)
+  {
+    m_add_sample_profile(frame);
+  }
 
-      m_previous_snapshot.clear();
+  m_profile(frame.thread, frame.timestamp, frame.count, frame.snapshot);
+
+  // m_profile left this run's stack in m_previous_ids.
+  if (frame.off_cpu && !m_previous_ids.empty())
+  {
+    m_off_cpu_samples += frame.count;
+
+    if (frame.off_cpu_ticks > 0UL)
+    {
+      m_off_cpu.add(m_previous_ids.data(), m_previous_ids.size(), frame.off_cpu_ticks);
     }
+  }
+}
 
+void Profiler::m_switch_thread(const std::uint16_t thread) noexcept
+{
+  if (thread == m_thread)
+  {
     return;
   }
 
-  ++m_num_captured_samples;
+  // m_previous_ids always holds the current thread's stack; the others wait
+  // in m_parked_ids, so single-threaded runs never get here.
+  const std::size_t needed = static_cast<std::size_t>(std::max(thread, m_thread)) + 1UL;
+
+  if (m_parked_ids.size() < needed)
+  {
+    m_parked_ids.resize(needed);
+  }
+
+  m_parked_ids[m_thread].swap(m_previous_ids);
+  m_previous_ids.swap(m_parked_ids[thread]);
+  m_thread = thread;
+}
+
+// LLVM matches functions by linkage name, so the sample profile has ids of
+// its own: one per linkage name, or per display name for a frame without
+// one. A thread root is no function, so the profile starts below it.
+void Profiler::m_add_sample_profile(const Frame& frame) noexcept
+{
+  const std::size_t root  = frame.rooted ? 1UL : 0UL;
+  const std::size_t depth = frame.snapshot.size();
+
+  if (depth <= root || frame.lines.size() != depth)
+  {
+    return;
+  }
+
+  m_linkage_ids.clear();
+
+  for (std::size_t i = root; i < depth; i++)
+  {
+    const bool mangled = (i < frame.linkage.size()) && !frame.linkage[i].empty();
+
+    m_linkage_ids.push_back(m_linkage.intern(mangled ? frame.linkage[i] : frame.snapshot[i]));
+  }
+
+  for (; m_linkage_defined < m_linkage.size(); m_linkage_defined++)
+  {
+    m_sample_profile->define(m_linkage_defined, m_linkage.name(m_linkage_defined));
+  }
+
+  m_sample_profile->sample(frame.thread, frame.count, m_linkage_ids.data(), frame.lines.data() + root, depth - root);
+}
+
+void Profiler::m_profile(const std::uint16_t              thread,
+                         const std::uint64_t              timestamp,
+                         const std::uint64_t              count,
+                         const Snapshot&                  snapshot) noexcept
+{
+  const std::uint64_t begin = Clock::now_ns();
+
+  m_switch_thread(thread);
+
+  if (snapshot.empty() == false)
+  {
+    m_num_captured_samples += count;
+  }
+
+  // Both id buffers keep their capacity, so steady state never allocates.
+  m_current_ids.clear();
 
-  if (m_previous_snapshot.empty())
+  for (const auto& name : snapshot)
   {
-    for (const auto& start : snapshot)
+    m_current_ids.push_back(m_interner.intern(name));
+  }
+
+  const bool          streaming    = !m_sinks.empty() || (m_trace != nullptr);
+  const std::uint64_t timestamp_ns = streaming ? Clock::get_instance().to_ns(timestamp) : 0UL;
+
+  if (streaming)
+  {
+    for (; m_defined < m_interner.size(); m_defined++)
     {
-      if (m_queue.emplace(EventType::START, timestamp, start))
+      for (ISink* sink : m_sinks)
       {
-        common::fatal_trap();
+        sink->define(m_defined, m_interner.name(m_defined));
+      }
+
+      if (m_trace != nullptr)
+      {
+        m_trace->define(m_defined, m_interner.name(m_defined));
       }
     }
+  }
 
-    m_previous_snapshot = std::move(snapshot);
-    return;
+  if (!m_sinks.empty() && !m_current_ids.empty())
+  {
+    for (ISink* sink : m_sinks)
+    {
+      sink->sample(timestamp_ns, count, m_current_ids.data(), m_current_ids.size());
+    }
   }
 
-  const auto [starts, stops] = m_find_mismatches(snapshot);
+  // Everything below the longest common prefix ended (innermost first),
+  // then everything above it started (outermost first).
+  const std::size_t lcp = m_common_prefix();
 
-  for (const auto& start : starts)
+  for (std::size_t i = m_previous_ids.size(); i > lcp; i--)
   {
-    if (m_queue.emplace(EventType::START, timestamp, start))
+    if (m_log.emplace(EventType::END, timestamp, m_previous_ids[i - 1UL], thread))
     {
       common::fatal_trap();
     }
+
+    if (m_trace != nullptr)
+    {
+      m_trace->end(kTraceThread + thread, m_previous_ids[i - 1UL], timestamp_ns);
+    }
   }
 
-  for (const auto& stop : stops)
+  for (std::size_t i = lcp; i < m_current_ids.size(); i++)
   {
-    if (m_queue.emplace(EventType::END,   timestamp, stop))
+    if (m_log.emplace(EventType::START, timestamp, m_current_ids[i], thread))
     {
       common::fatal_trap();
     }
+
+    if (m_trace != nullptr)
+    {
+      m_trace->begin(kTraceThread + thread, m_current_ids[i], timestamp_ns);
+    }
   }
 
-  m_previous_snapshot = std::move(snapshot);
+  m_previous_ids.swap(m_current_ids);
+
+  if (m_metrics != nullptr)
+  {
+    m_metrics->profile.record(Clock::now_ns() - begin);
+  }
 }
 
 void Profiler::dump(void) noexcept
 {
   Clock& clock = Clock::get_instance();
-  const std::chrono::duration<double> elapsed_seconds = (clock.get_stop() - clock.get_start());
-  const double samples_pre_second = (elapsed_seconds.count() / static_cast<double>(m_num_captured_samples));
+  const double elapsed_seconds = clock.to_seconds(clock.get_stop() - clock.get_start());
+  const double achieved_rate = (elapsed_seconds > 0.0) ?
+                               (static_cast<double>(m_num_captured_samples) / elapsed_seconds) : 0.0;
+
+  const double overhead = (elapsed_seconds > 0.0) ?
+                          ((static_cast<double>(m_overhead_ns) / 1e9) / elapsed_seconds) * 100.0 : 0.0;
 
   std::cout << std::fixed << std::setprecision(2);
   std::cout << "Captured: " << m_num_captured_samples << " samples in " << elapsed_seconds << " seconds" << std::endl;
-  std::cout << "Sample rate: " << samples_pre_second << " samples/sec" << std::endl;
-  std::cout << "Sampling efficiency: 0.0%" << std::endl << std::endl;
+  std::cout << "Sample rate: " << achieved_rate << " samples/sec achieved, "
+            << m_requested_rate << " requested (" << m_num_missed_ticks << " ticks missed)" << std::endl;
+  std::cout << "Profiler overhead: " << overhead << "% of wall time";
+
+  if (m_overhead_budget > 0.0)
+  {
+    std::cout << " (budget " << (m_overhead_budget * 100.0) << "%, rate "
+              << m_governed_rate << " Hz after " << m_rate_adjustments << " adjustments)";
+  }
+
+  std::cout << std::endl;
+
+  m_dump_metrics(elapsed_seconds);
+
+  std::cout << std::endl;
   std::cout << "Profile Stats: " << std::endl;
   std::cout << "----------------------------------------------------------------------" << std::endl;
 
-  Stack<Event, 128> stack;
+  Event event;
 
-  for (;;)
+  // One line per event: let the stream buffer them and flush once.
+  while (next_event(event))
   {
-    Event old_event;
-    Event new_event;
+    sink(event);
+  }
 
-    bool empty;
+  std::cout << std::flush;
 
-    if (m_queue.empty(empty))
-    {
-      common::fatal_trap();
-    }
+  if (m_metrics != nullptr && m_metrics->events_unmatched > 0UL)
+  {
+    std::cout << "(" << m_metrics->events_unmatched << " events unmatched after queue overflow)" << std::endl;
+  }
 
-    if (empty)
-    {
-      break;
-    }
+  m_dump_off_cpu();
+}
+
+void Profiler::m_dump_off_cpu(void) const noexcept
+{
+  if (m_off_cpu_samples == 0UL)
+  {
+    return;
+  }
+
+  struct Entry final
+  {
+    const std::uint32_t* stack;
+    std::size_t          depth;
+    std::uint64_t        ticks;
+  };
+
+  std::vector<Entry> entries;
+  entries.reserve(m_off_cpu.size());
+
+  m_off_cpu.for_each([&entries](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t ticks) noexcept
+  {
+    entries.push_back(Entry{stack, depth, ticks});
+  });
+
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) noexcept
+  {
+    return a.ticks > b.ticks;
+  });
+
+  const Clock& clock = Clock::get_instance();
+  const double total = clock.to_seconds(m_off_cpu.get_samples());
+
+  std::cout << std::endl;
+  std::cout << "Off-CPU: " << total << " seconds blocked in " << m_off_cpu_samples << " samples, "
+            << entries.size() << " stacks" << std::endl;
+  std::cout << "----------------------------------------------------------------------" << std::endl;
+
+  const std::size_t shown = std::min(entries.size(), kOffCpuStacks);
+
+  for (std::size_t i = 0UL; i < shown; i++)
+  {
+    const double seconds = clock.to_seconds(entries[i].ticks);
+    const double share   = (total > 0.0) ? (seconds / total) * 100.0 : 0.0;
 
-    if (m_queue.pop(new_event))
+    std::cout << std::setw(10) << seconds << " s" << std::setw(8) << share << "%  ";
+
+    for (std::size_t j = 0UL; j < entries[i].depth; j++)
     {
-      common::fatal_trap();
+      std::cout << ((j > 0UL) ? ";" : "") << m_interner.name(entries[i].stack[j]);
     }
 
-    switch (new_event.type)
-    {
-      case EventType::START:
-        assert((stack.push(new_event) == Stack<Event, 32>::kOk));
-        break;
+    std::cout << '\n';
+  }
 
-      case EventType::END:
-        assert((stack.peek(old_event) == Stack<Event, 32>::kOk));
-        assert(new_event.name == old_event.name);
-        std::cout << new_event.name << " " << (new_event.timestamp - old_event.timestamp) << std::endl;
-        assert((stack.pop(old_event) == Stack<Event, 32>::kOk));
-        break;
+  if (entries.size() > shown)
+  {
+    std::cout << "... " << (entries.size() - shown) << " more stacks" << '\n';
+  }
 
-      default:
-        common::fatal_trap();
-    }
+  std::cout << std::flush;
+}
+
+void Profiler::profile(Frame frame) noexcept
+{
+  m_profile(frame);
+}
+
+bool Profiler::next_event(Event& event) noexcept
+{
+  bool empty;
+
+  if (m_log.empty(empty))
+  {
+    common::fatal_trap();
   }
+
+  if (empty)
+  {
+    return false;
+  }
+
+  if (m_log.pop(event))
+  {
+    common::fatal_trap();
+  }
+
+  return true;
 }
 
-Profiler::StartsNStopsTuple Profiler::m_find_mismatches(const Snapshot& snapshot) noexcept
+void Profiler::sink(const Event& event) noexcept
 {
-  auto p = m_previous_snapshot.begin();
-  auto c =            snapshot.begin();
+  using EventStack = Stack<Event, 128UL>;
 
-  std::vector<std::string> starts;
-  std::vector<std::string> stops;
+  EventStack& stack = m_stack_of(event.thread);
+  Event       start;
 
-  while (p != m_previous_snapshot.end() && c != snapshot.end())
+  switch (event.type)
   {
-    auto [mp, mc] = std::mismatch(p, m_previous_snapshot.end(),
-                                  c,            snapshot.end());
+    case EventType::START:
+      if (stack.push(event) != EventStack::kOk)
+      {
+        m_count_unmatched(1UL);
+      }
+      break;
 
-    if (mp == m_previous_snapshot.end()  ||
-        mc ==            snapshot.end())
-    {
+    case EventType::END:
+      if (stack.peek(start) == EventStack::kOk && start.name == event.name)
+      {
+        (void)stack.pop(start);
+        std::cout << m_interner.name(event.name) << " " << Clock::get_instance().to_seconds(event.timestamp - start.timestamp) << '\n';
+        break;
+      }
+
+      m_sink_unmatched(stack, event);
       break;
+
+    default:
+      common::fatal_trap();
+  }
+}
+
+Stack<Event, 128UL>& Profiler::m_stack_of(const std::uint16_t thread) noexcept
+{
+  if (thread >= m_stacks.size())
+  {
+    m_stacks.resize(static_cast<std::size_t>(thread) + 1UL);
+  }
+
+  return m_stacks[thread];
+}
+
+void Profiler::m_sink_unmatched(Stack<Event, 128UL>& stack, const Event& event) noexcept
+{
+  using EventStack = Stack<Event, 128UL>;
+
+  // Only reachable after a queue dropped events. If the END closes a frame
+  // deeper in the stack, the frames above it lost their ENDs: discard them.
+  // Otherwise its START was lost: discard the END and keep the stack.
+  std::vector<Event> above;
+  Event start;
+
+  while (stack.pop(start) == EventStack::kOk)
+  {
+    if (start.name == event.name)
+    {
+      m_count_unmatched(above.size());
+      std::cout << m_interner.name(event.name) << " " << Clock::get_instance().to_seconds(event.timestamp - start.timestamp) << '\n';
+      return;
     }
 
-     stops.push_back(*mp);
-    starts.push_back(*mc);
+    above.push_back(std::move(start));
+  }
 
-    p = std::next(mp);
-    c = std::next(mc);
+  for (auto it = above.rbegin(); it != above.rend(); it++)
+  {
+    (void)stack.push(*it);
   }
 
-  for (; p != m_previous_snapshot.end(); p++)
+  m_count_unmatched(1UL);
+}
+
+void Profiler::m_count_unmatched(const std::uint64_t n) noexcept
+{
+  if (m_metrics != nullptr)
   {
-    stops.push_back(*p);
+    m_metrics->events_unmatched += n;
   }
+}
 
-  for (; c != snapshot.end(); c++)
+std::size_t Profiler::m_common_prefix(void) const noexcept
+{
+  const std::size_t    n    = std::min(m_previous_ids.size(), m_current_ids.size());
+  const std::uint32_t* prev = m_previous_ids.data();
+  const std::uint32_t* curr = m_current_ids.data();
+  std::size_t i = 0UL;
+
+#if defined(__SSE2__)
+  // Four ids per compare; the first clear lane of the byte mask is the divergence.
+  for (; (i + 4UL) <= n; i += 4UL)
   {
-    starts.push_back(*c);
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(curr + i));
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)));
+
+    if (mask != 0xFFFFU)
+    {
+      return i + (static_cast<std::size_t>(std::countr_zero(~mask & 0xFFFFU)) / 4UL);
+    }
+  }
+#endif
+
+  while (i < n && prev[i] == curr[i])
+  {
+    ++i;
   }
 
-  return std::make_tuple(std::move(starts), std::move(stops));
+  return i;
 }
 
 void Profiler::set_context(IContext* context) noexcept
@@ -259,3 +557,133 @@ void Profiler::set_frame_buffer(Queue<Frame, 64UL>* frame_buffer) noexcept
 {
   m_frame_buffer = frame_buffer;
 }
+
+void Profiler::set_requested_rate(const double rate_hz) noexcept
+{
+  m_requested_rate = rate_hz;
+}
+
+void Profiler::set_missed_ticks(const std::uint64_t missed) noexcept
+{
+  m_num_missed_ticks = missed;
+}
+
+void Profiler::m_dump_metrics(const double elapsed_seconds) const noexcept
+{
+  if (m_metrics == nullptr)
+  {
+    return;
+  }
+
+  const Metrics& metrics = *m_metrics;
+
+  std::uint64_t frames_dropped = 0UL;
+  std::uint64_t events_dropped = 0UL;
+
+  if (m_frame_buffer != nullptr)
+  {
+    (void)m_frame_buffer->dropped(frames_dropped);
+  }
+
+  (void)m_log.dropped(events_dropped);
+
+  frames_dropped += metrics.frames_dropped;
+  events_dropped += metrics.events_dropped;
+
+  // Every scheduled tick either ran a capture or was skipped by the pacer.
+  const std::uint64_t scheduled = metrics.capture.get_count() + m_num_missed_ticks;
+  const std::uint64_t dropped   = m_num_missed_ticks + metrics.failed_captures;
+
+  const double efficiency = (scheduled > 0UL) ?
+                            (static_cast<double>(m_num_captured_samples) / static_cast<double>(scheduled)) * 100.0 : 0.0;
+
+  const double suspended = (elapsed_seconds > 0.0) ?
+                           ((static_cast<double>(metrics.suspend.get_sum()) / 1e9) / elapsed_seconds) * 100.0 : 0.0;
+
+  std::cout << "Sampling efficiency: " << efficiency << "% ("
+            << m_num_captured_samples << " of " << scheduled << " scheduled samples captured)" << std::endl;
+  std::cout << "Samples dropped: " << dropped << " (" << m_num_missed_ticks << " missed ticks, "
+            << metrics.failed_captures << " failed captures)" << std::endl;
+  if (metrics.off_cpu_samples > 0UL || metrics.off_cpu_skipped > 0UL)
+  {
+    std::cout << "Off-CPU samples: " << metrics.off_cpu_samples << " taken blocked, "
+              << metrics.off_cpu_skipped << " ticks skipped in CPU mode" << std::endl;
+  }
+
+  std::cout << "Queue overflow: " << frames_dropped << " frame runs, " << events_dropped
+            << " events dropped" << std::endl;
+  std::cout << "Event log: " << m_log.get_chunks() << " chunks of "
+            << m_log.get_records_per_chunk() << " events, " << m_interner.size() << " names interned" << std::endl;
+  std::cout << "Target suspended: " << suspended << "% of wall time" << std::endl << std::endl;
+
+  const struct
+  {
+    const char*      name;
+    const Histogram& histogram;
+  } rows[] = {
+    {"scan",      metrics.scan},
+    {"capture",   metrics.capture},
+    {"suspend",   metrics.suspend},
+    {"symbolize", metrics.symbolize},
+    {"profile",   metrics.profile},
+  };
+
+  std::cout << std::left  << std::setw(12) << "Latency (us)"
+            << std::right << std::setw(12) << "count"
+            << std::setw(12) << "p50"
+            << std::setw(12) << "p99"
+            << std::setw(12) << "max" << std::endl;
+
+  for (const auto& row : rows)
+  {
+    std::cout << std::left  << std::setw(12) << row.name
+              << std::right << std::setw(12) << row.histogram.get_count()
+              << std::setw(12) << (static_cast<double>(row.histogram.percentile(50.0)) / 1e3)
+              << std::setw(12) << (static_cast<double>(row.histogram.percentile(99.0)) / 1e3)
+              << std::setw(12) << (static_cast<double>(row.histogram.get_max())        / 1e3) << std::endl;
+  }
+}
+
+void Profiler::set_overhead(const std::uint64_t cost_ns,
+                            const double        budget,
+                            const double        rate_hz,
+                            const std::uint64_t adjustments) noexcept
+{
+  m_overhead_ns      = cost_ns;
+  m_overhead_budget  = budget;
+  m_governed_rate    = rate_hz;
+  m_rate_adjustments = adjustments;
+}
+
+void Profiler::set_metrics(Metrics* metrics) noexcept
+{
+  m_metrics = metrics;
+}
+
+void Profiler::set_overflow_policy(const OverflowPolicy policy) noexcept
+{
+  m_log.set_policy(policy);
+}
+
+void Profiler::set_event_budget(const std::size_t max_chunks) noexcept
+{
+  m_log.set_max_chunks(max_chunks);
+}
+
+void Profiler::set_trace(ChromeTraceWriter* trace) noexcept
+{
+  m_trace = trace;
+}
+
+void Profiler::set_sample_profile(SampleProfileWriter* sample_profile) noexcept
+{
+  m_sample_profile = sample_profile;
+}
+
+void Profiler::add_sink(ISink* sink) noexcept
+{
+  if (sink != nullptr)
+  {
+    m_sinks.push_back(sink);
+  }
+}
@@ -0,0 +1,276 @@
+#include "codec.hpp"
+#include "sample_log.hpp"
+#include "segment.hpp"
+#include "varint.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  inline std::uint32_t load_u32(const std::uint8_t* p) noexcept
+  {
+    return  static_cast<std::uint32_t>(p[0])        |
+           (static_cast<std::uint32_t>(p[1]) << 8)  |
+           (static_cast<std::uint32_t>(p[2]) << 16) |
+           (static_cast<std::uint32_t>(p[3]) << 24);
+  }
+} // namespace
+
+SampleLogWriter::SampleLogWriter(std::string path, const std::size_t segment_bytes) noexcept
+  : m_segments(std::move(path), segment_bytes, kVersion),
+    m_scratch()
+{
+  m_scratch.reserve(1024UL);
+}
+
+bool SampleLogWriter::is_open(void) const noexcept
+{
+  return m_segments.is_open();
+}
+
+void SampleLogWriter::m_put(const std::uint64_t v) noexcept
+{
+  std::uint8_t bytes[varint::kMaxBytes];
+  const std::size_t n = varint::encode(v, bytes);
+  m_scratch.insert(m_scratch.end(), bytes, bytes + n);
+}
+
+void SampleLogWriter::m_emit(const SampleLogRecord tag) noexcept
+{
+  const std::size_t n = (1UL + m_scratch.size());
+  std::uint8_t* out = m_segments.reserve(n);
+
+  if (out == nullptr)
+  {
+    ++m_failed;
+    return;
+  }
+
+  // Body first, tag last: a record cut short by a crash still reads as the
+  // zero end marker.
+  std::memcpy(out + 1, m_scratch.data(), m_scratch.size());
+  std::atomic_ref<std::uint8_t>(out[0]).store(static_cast<std::uint8_t>(tag), std::memory_order_release);
+
+  m_segments.commit(n);
+}
+
+void SampleLogWriter::define(const std::uint32_t id, std::string_view name) noexcept
+{
+  m_scratch.clear();
+
+  m_put(id);
+  m_put(name.size());
+  m_scratch.insert(m_scratch.end(), name.begin(), name.end());
+
+  m_emit(SampleLogRecord::NAME);
+}
+
+void SampleLogWriter::sample(const std::uint64_t  timestamp_ns,
+                             const std::uint64_t  count,
+                             const std::uint32_t* stack,
+                             const std::size_t    depth) noexcept
+{
+  // Encode straight into the mapping; only the bytes used are committed.
+  std::uint8_t* out = m_segments.reserve(1UL + codec::StackEncoder::max_bytes(depth));
+
+  if (out == nullptr)
+  {
+    ++m_failed;
+    return;
+  }
+
+  if (m_segments.get_segments() != m_segment)
+  {
+    // First sample of a fresh segment: restart the deltas from an empty stack.
+    m_segment = m_segments.get_segments();
+    m_encoder.reset();
+  }
+
+  const std::uint8_t* last = m_encoder.encode(out + 1, timestamp_ns, count, stack, depth);
+
+  std::atomic_ref<std::uint8_t>(out[0]).store(static_cast<std::uint8_t>(SampleLogRecord::SAMPLE),
+                                              std::memory_order_release);
+
+  m_segments.commit(static_cast<std::size_t>(last - out));
+
+  m_samples += count;
+}
+
+void SampleLogWriter::flush(void) noexcept
+{
+  m_segments.flush();
+}
+
+std::uint32_t SampleLogWriter::get_segments(void) const noexcept
+{
+  return m_segments.get_segments();
+}
+
+std::uint64_t SampleLogWriter::get_bytes(void) const noexcept
+{
+  return m_segments.get_bytes();
+}
+
+std::uint64_t SampleLogWriter::get_samples(void) const noexcept
+{
+  return m_samples;
+}
+
+std::uint64_t SampleLogWriter::get_failed(void) const noexcept
+{
+  return m_failed;
+}
+
+SampleLogReader::SampleLogReader(std::string path) noexcept : SampleLogReader(std::move(path), 0U, 1U) {}
+
+SampleLogReader::SampleLogReader(std::string path, const std::uint32_t first, const std::uint32_t stride) noexcept
+  : m_base(std::move(path)),
+    m_index(first),
+    m_stride((stride == 0U) ? 1U : stride)
+{
+  (void)m_open_next();
+}
+
+bool SampleLogReader::m_open_next(void) noexcept
+{
+  m_file.reset();
+  m_cursor = nullptr;
+  m_end    = nullptr;
+
+  auto file = std::make_unique<MappedFile>(SegmentWriter::segment_path(m_base, m_index));
+
+  if (!file->is_open())
+  {
+    return false;
+  }
+
+  const std::uint8_t* data = file->data();
+
+  if (file->size() < SegmentWriter::kHeaderBytes                                      ||
+      std::memcmp(data, SegmentWriter::kMagic, sizeof(SegmentWriter::kMagic)) != 0    ||
+      load_u32(data + 8)  != SampleLogWriter::kVersion                                ||
+      load_u32(data + 12) != m_index)
+  {
+    m_corrupt = true;
+    return false;
+  }
+
+  m_cursor = data + SegmentWriter::kHeaderBytes;
+  m_end    = data + file->size();
+  m_file   = std::move(file);
+
+  m_decoder.reset();
+
+  m_index += m_stride;
+  ++m_opened;
+
+  return true;
+}
+
+bool SampleLogReader::m_read_name(void) noexcept
+{
+  std::uint64_t id  = 0UL;
+  std::uint64_t len = 0UL;
+
+  const std::uint8_t* p = varint::decode(m_cursor, m_end, id);
+  p = (p != nullptr) ? varint::decode(p, m_end, len) : nullptr;
+
+  if (p == nullptr || len > static_cast<std::uint64_t>(m_end - p) || id > 0xFFFFFFFFUL)
+  {
+    return false;
+  }
+
+  if (id >= m_names.size())
+  {
+    m_names.resize(static_cast<std::size_t>(id) + 1UL);
+  }
+
+  m_names[id].assign(reinterpret_cast<const char*>(p), static_cast<std::size_t>(len));
+  m_cursor = p + len;
+
+  return true;
+}
+
+bool SampleLogReader::m_read_sample(Sample& out) noexcept
+{
+  const std::uint8_t* p = m_decoder.decode(m_cursor, m_end, out.timestamp_ns, out.count);
+
+  if (p == nullptr)
+  {
+    return false;
+  }
+
+  out.stack.assign(m_decoder.stack().begin(), m_decoder.stack().end());
+  out.shared = m_decoder.kept();
+  m_cursor   = p;
+
+  return true;
+}
+
+bool SampleLogReader::next(Sample& out) noexcept
+{
+  while (m_cursor != nullptr && !m_corrupt)
+  {
+    if (m_cursor >= m_end || *m_cursor == static_cast<std::uint8_t>(SampleLogRecord::END))
+    {
+      if (!m_open_next())
+      {
+        return false;
+      }
+
+      continue;
+    }
+
+    const auto tag = static_cast<SampleLogRecord>(*m_cursor++);
+
+    switch (tag)
+    {
+      case SampleLogRecord::NAME:
+        m_corrupt = !m_read_name();
+        break;
+
+      case SampleLogRecord::SAMPLE:
+        if (m_read_sample(out))
+        {
+          return true;
+        }
+
+        m_corrupt = true;
+        break;
+
+      default:
+        m_corrupt = true;
+        break;
+    }
+  }
+
+  return false;
+}
+
+std::string_view SampleLogReader::name(const std::uint32_t id) const noexcept
+{
+  return (id < m_names.size()) ? std::string_view(m_names[id]) : std::string_view();
+}
+
+const std::vector<std::string>& SampleLogReader::get_names(void) const noexcept
+{
+  return m_names;
+}
+
+bool SampleLogReader::is_corrupt(void) const noexcept
+{
+  return m_corrupt;
+}
+
+std::uint32_t SampleLogReader::get_segments(void) const noexcept
+{
+  return m_opened;
+}
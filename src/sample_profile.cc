@@ -0,0 +1,235 @@
+#include "line_location.hpp"
+#include "sample_profile.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  bool has_space(std::string_view name) noexcept
+  {
+    return std::any_of(name.begin(), name.end(), [](const char c) noexcept
+    {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    });
+  }
+} // namespace
+
+void SampleProfile::add(const std::uint16_t  thread,
+                        const std::uint32_t* stack,
+                        const LineLocation*  lines,
+                        const std::size_t    depth,
+                        const std::uint64_t  count) noexcept
+{
+  if (thread >= m_previous.size())
+  {
+    m_previous.resize(static_cast<std::size_t>(thread) + 1UL);
+  }
+
+  Previous& previous = m_previous[thread];
+
+  // Frames still on the stack since this thread's previous call: same
+  // function at the same depth, reached through the same call sites.
+  const std::size_t common = std::min(depth, previous.stack.size());
+  std::size_t       same   = 0UL;
+
+  while (same < common && stack[same] == previous.stack[same] && (same == 0UL || lines[same - 1UL] == previous.lines[same - 1UL]))
+  {
+    ++same;
+  }
+
+  for (std::size_t i = 0UL; i < depth; i++)
+  {
+    const std::uint32_t id = stack[i];
+
+    if (id >= m_functions.size())
+    {
+      m_functions.resize(static_cast<std::size_t>(id) + 1UL);
+    }
+
+    Function& function = m_functions[id];
+
+    function.total += count;
+
+    if (i >= same)
+    {
+      ++function.head;
+    }
+
+    if (lines[i].offset == LineLocation::kNoLine)
+    {
+      continue;
+    }
+
+    Line& line = function.lines[(static_cast<std::uint64_t>(lines[i].offset) << 32) | lines[i].discriminator];
+
+    line.samples += count;
+
+    if ((i + 1UL) < depth)
+    {
+      line.targets[stack[i + 1UL]] += count;
+    }
+  }
+
+  previous.stack.assign(stack, stack + depth);
+  previous.lines.assign(lines, lines + depth);
+  m_samples += count;
+}
+
+int SampleProfile::write(const std::string& path, const std::vector<std::string>& names) const noexcept
+{
+  Writer out(path);
+
+  if (!out.is_open())
+  {
+    return kIoError;
+  }
+
+  auto name_of = [&names](const std::uint32_t id) noexcept -> std::string_view
+  {
+    return (id < names.size()) ? std::string_view(names[id]) : std::string_view();
+  };
+
+  std::vector<std::uint32_t> order;
+
+  for (std::uint32_t id = 0U; id < m_functions.size(); id++)
+  {
+    if (m_functions[id].total > 0UL && !name_of(id).empty())
+    {
+      order.push_back(id);
+    }
+  }
+
+  std::sort(order.begin(), order.end(), [&](const std::uint32_t a, const std::uint32_t b) noexcept
+  {
+    if (m_functions[a].total != m_functions[b].total)
+    {
+      return m_functions[a].total > m_functions[b].total;
+    }
+
+    return name_of(a) < name_of(b);
+  });
+
+  std::vector<std::pair<std::uint64_t, const Line*>>   lines;
+  std::vector<std::pair<std::uint32_t, std::uint64_t>> targets;
+
+  for (const std::uint32_t id : order)
+  {
+    const Function& function = m_functions[id];
+
+    out.write(name_of(id));
+    out.put(':');
+    out.write_u64(function.total);
+    out.put(':');
+    out.write_u64(function.head);
+    out.put('\n');
+
+    lines.clear();
+
+    for (const auto& [key, line] : function.lines)
+    {
+      lines.emplace_back(key, &line);
+    }
+
+    std::sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) noexcept { return a.first < b.first; });
+
+    for (const auto& [key, line] : lines)
+    {
+      const std::uint64_t discriminator = key & 0xFFFFFFFFUL;
+
+      out.put(' ');
+      out.write_u64(key >> 32);
+
+      if (discriminator != 0UL)
+      {
+        out.put('.');
+        out.write_u64(discriminator);
+      }
+
+      out.write(": ");
+      out.write_u64(line->samples);
+
+      targets.clear();
+
+      for (const auto& [callee, samples] : line->targets)
+      {
+        if (!name_of(callee).empty() && !has_space(name_of(callee)))
+        {
+          targets.emplace_back(callee, samples);
+        }
+      }
+
+      std::sort(targets.begin(), targets.end(), [&](const auto& a, const auto& b) noexcept
+      {
+        return (a.second != b.second) ? (a.second > b.second) : (name_of(a.first) < name_of(b.first));
+      });
+
+      for (const auto& [callee, samples] : targets)
+      {
+        out.put(' ');
+        out.write(name_of(callee));
+        out.put(':');
+        out.write_u64(samples);
+      }
+
+      out.put('\n');
+    }
+  }
+
+  return (out.close() == Writer::kOk) ? kOk : kIoError;
+}
+
+std::size_t SampleProfile::get_functions(void) const noexcept
+{
+  return static_cast<std::size_t>(std::count_if(m_functions.begin(), m_functions.end(), [](const Function& function) noexcept
+  {
+    return function.total > 0UL;
+  }));
+}
+
+std::uint64_t SampleProfile::get_samples(void) const noexcept
+{
+  return m_samples;
+}
+
+SampleProfileWriter::SampleProfileWriter(std::string path) noexcept
+  : FileSink(std::move(path), "sample_profile", "Sample profile"),
+    m_profile()
+{
+}
+
+bool SampleProfileWriter::m_write(void) noexcept
+{
+  return m_profile.write(get_path(), m_get_names()) == SampleProfile::kOk;
+}
+
+void SampleProfileWriter::m_describe(std::ostream& out) const noexcept
+{
+  out << m_profile.get_functions() << " functions, " << m_profile.get_samples() << " samples";
+}
+
+void SampleProfileWriter::sample(const std::uint16_t  thread,
+                                 const std::uint64_t  count,
+                                 const std::uint32_t* stack,
+                                 const LineLocation*  lines,
+                                 const std::size_t    depth) noexcept
+{
+  m_profile.add(thread, stack, lines, depth, count);
+}
+
+std::size_t SampleProfileWriter::get_functions(void) const noexcept
+{
+  return m_profile.get_functions();
+}
+
+std::uint64_t SampleProfileWriter::get_samples(void) const noexcept
+{
+  return m_profile.get_samples();
+}
@@ -1,14 +1,25 @@
 #include "clock.hpp"
 #include "common.hpp"
+#include "line_histogram.hpp"
+#include "line_location.hpp"
 #include "queue.hpp"
 #include "scan.hpp"
+#include "threads.hpp"
+
+#include "xxhash.h"
 
 #include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #if defined(_WIN32) || defined(__CYGWIN__)
   #include <windows.h>
@@ -20,6 +31,14 @@ Scanner::~Scanner() noexcept
 
 #if defined(_WIN32) || defined(__CYGWIN__)
   ::CloseHandle(m_th);
+
+  for (std::size_t i = 1UL; i < m_threads.size(); i++)
+  {
+    if (m_threads[i].handle != nullptr)
+    {
+      ::CloseHandle(m_threads[i].handle);
+    }
+  }
 #endif
 }
 
@@ -29,30 +48,393 @@ bool Scanner::scan(const std::size_t skip, const std::size_t max_frames) noexcep
 
   if (m_done.wait_for(0s) == std::future_status::ready)
   {
-    return true;
+    return m_flush_runs(kFlushBatch);
+  }
+
+  const std::uint64_t scan_begin = Clock::now_ns();
+
+  std::size_t index = 0UL;
+
+  if (m_all_threads)
+  {
+    if (m_stale || m_ignored_changed.exchange(false) || (m_scans % kRefreshScans) == 0UL)
+    {
+      m_refresh_threads();
+    }
+
+    index = m_next_thread();
+
+    // One exited thread's last run per scan, so many threads exiting at
+    // once cannot overflow the frame buffer.
+    if (!m_exited.empty())
+    {
+      m_flush_run(m_threads[m_exited.back()]);
+      m_exited.pop_back();
+    }
+  }
+
+  ++m_scans;
+
+  Thread& thread = m_threads[index];
+
+  double        share  = 1.0;
+  const bool    known  = m_cpu_share(thread, share);
+  std::uint64_t weight = 1UL;
+
+  // A thread busy a quarter of the time is captured every fourth check;
+  // the fraction left over carries to the next one. A thread whose CPU
+  // time cannot be measured is captured every check, as in WALL mode.
+  if (m_sample_mode == SampleMode::CPU)
+  {
+    thread.cpu_credit += known ? share : 1.0;
+
+    if (thread.cpu_credit < 1.0)
+    {
+      if (m_metrics != nullptr)
+      {
+        ++m_metrics->off_cpu_skipped;
+      }
+
+      m_record_scan(scan_begin);
+      return false;
+    }
+
+    weight             = static_cast<std::uint64_t>(thread.cpu_credit);
+    thread.cpu_credit -= static_cast<double>(weight);
+  }
+
+  const std::uint32_t flags = (m_line_offsets ? pace::WindowsTrace::CaptureFlags::LineOffsets : 0U) |
+                              (m_linkage_names ? pace::WindowsTrace::CaptureFlags::LinkageNames : 0U);
+
+  auto frames = m_trace->capture(thread.handle, skip, max_frames, flags);
+
+  if (m_metrics != nullptr)
+  {
+    const auto& stats = m_trace->get_last_stats();
+
+    m_metrics->capture.record(Clock::now_ns() - scan_begin);
+    m_metrics->suspend.record(stats.suspend_ns);
+    m_metrics->symbolize.record(stats.symbolize_ns);
+
+    if (frames.empty())
+    {
+      ++m_metrics->failed_captures;
+    }
+  }
+
+  // The thread may have exited since the last enumeration.
+  m_stale = m_stale || (frames.empty() && index > 0UL);
+
+  // frames are innermost first: the leaf is what was executing.
+  if (m_line_histogram != nullptr && !frames.empty())
+  {
+    m_line_histogram->add(frames.front().pc);
+  }
+
+  const std::uint64_t timestamp = Clock::get_instance().elapsed();
+  const bool          rooted    = m_all_threads && m_thread_roots && !frames.empty();
+  const bool          off_cpu   = m_sample_mode == SampleMode::WALL && known && share < kBlockedShare && !frames.empty();
+  const std::uint64_t interval  = (thread.sampled_at > 0UL) ? (timestamp - thread.sampled_at) : 0UL;
+
+  // Only the part of the interval the thread spent off a CPU was waiting.
+  const std::uint64_t waited = off_cpu ? static_cast<std::uint64_t>((1.0 - share) * static_cast<double>(interval)) : 0UL;
+
+  thread.sampled_at = timestamp;
+
+  if (off_cpu && m_metrics != nullptr)
+  {
+    ++m_metrics->off_cpu_samples;
+  }
+
+  // Hash the stack outermost-first before building anything; in steady
+  // loops the sample only extends the pending run. Runs are per thread, so
+  // the root frame needs no hashing; the CPU state does, as a run is all
+  // on-CPU or all off-CPU.
+  std::uint64_t hash = static_cast<std::uint64_t>(frames.size()) ^ (off_cpu ? (1ULL << 63) : 0ULL);
+
+  std::vector<LineLocation> lines;
+
+  if (m_line_offsets)
+  {
+    lines.reserve(frames.size() + 1UL);
+
+    if (rooted)
+    {
+      lines.emplace_back();
+    }
+  }
+
+  for (auto it = frames.rbegin(); it != frames.rend(); it++)
+  {
+    // Overloads can share a display name; their linkage names differ.
+    const std::string& name = (m_linkage_names && !it->linkage.empty()) ? it->linkage : it->function;
+
+    hash = static_cast<std::uint64_t>(::XXH3_64bits_withSeed(name.data(), name.size(), hash));
+
+    if (m_line_offsets)
+    {
+      lines.push_back(m_line_location(*it));
+      hash = static_cast<std::uint64_t>(::XXH3_64bits_withSeed(&lines.back(), sizeof(LineLocation), hash));
+    }
+  }
+
+  if (thread.has_run && thread.run.hash == hash)
+  {
+    thread.run.count += weight;
+    thread.run.last_timestamp = timestamp;
+    thread.run.off_cpu_ticks += waited;
+    m_record_scan(scan_begin);
+    return false;
   }
 
-  auto frames = m_trace->capture(m_th, skip, max_frames);
-  Clock& clock = Clock::get_instance();
-  const auto now = std::chrono::steady_clock::now();
-  const std::chrono::duration<float> elapsed_seconds = (now - clock.get_start());
   Snapshot snapshot;
+  snapshot.reserve(frames.size() + 1UL);
 
-  for (const auto& frame : frames)
+  if (rooted)
   {
-    snapshot.push_back(frame.function);
+    snapshot.push_back("[" + thread.name + "]");
   }
 
-  std::reverse(snapshot.begin(), snapshot.end());
+  Snapshot linkage;
 
-  if (m_frame_buffer.emplace(elapsed_seconds.count(), std::move(snapshot)))
+  if (m_linkage_names)
   {
-    common::fatal_trap();
+    linkage.reserve(frames.size() + 1UL);
+    linkage.resize(snapshot.size());  // a thread root has none
+  }
+
+  for (auto it = frames.rbegin(); it != frames.rend(); it++)
+  {
+    snapshot.push_back(std::move(it->function));
+
+    if (m_linkage_names)
+    {
+      linkage.push_back(std::move(it->linkage));
+    }
+  }
+
+  m_flush_run(thread);
+
+  thread.run        = Frame(timestamp, hash, std::move(snapshot), std::move(lines));
+  thread.run.count  = weight;
+  thread.run.thread = static_cast<std::uint16_t>(index);
+  thread.run.rooted = rooted;
+  thread.has_run    = true;
+
+  thread.run.linkage       = std::move(linkage);
+  thread.run.off_cpu       = off_cpu;
+  thread.run.off_cpu_ticks = waited;
+
+  if (!thread.named)
+  {
+    thread.run.thread_name = thread.name;
+    thread.named           = true;
   }
 
+  m_record_scan(scan_begin);
   return false;
 }
 
+void Scanner::m_refresh_threads(void) noexcept
+{
+  m_stale = false;
+
+  const std::vector<pace::ThreadInfo> live = pace::list_threads();
+  const std::uint32_t                 self = pace::current_thread_id();
+
+  std::vector<std::uint32_t> ignored;
+
+  {
+    std::lock_guard<std::mutex> lock(m_ignored_mutex);
+    ignored = m_ignored;
+  }
+
+  std::vector<bool> seen(m_threads.size(), false);
+
+  seen[0] = true;
+
+  for (const pace::ThreadInfo& info : live)
+  {
+    if (info.id == self || info.id == m_owner || info.id == m_threads[0].id ||
+        std::find(ignored.begin(), ignored.end(), info.id) != ignored.end())
+    {
+      continue;
+    }
+
+    const auto it = m_thread_index.find(info.id);
+
+    if (it != m_thread_index.end())
+    {
+      seen[it->second] = true;
+      continue;
+    }
+
+    if (m_threads.size() >= kMaxThreads)
+    {
+      continue;
+    }
+
+    Thread thread;
+    thread.id   = info.id;
+    thread.name = info.name.empty() ? ("thread " + std::to_string(info.id)) : info.name;
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+    thread.handle = ::OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE,
+                                 static_cast<DWORD>(info.id));
+#endif
+
+    if (thread.handle == nullptr)
+    {
+      continue;
+    }
+
+    // Start the CPU time baseline now, so the first check of the thread
+    // measures a real interval.
+    double share = 0.0;
+    (void)m_cpu_share(thread, share);
+
+    m_thread_index.emplace(info.id, m_threads.size());
+    m_threads.push_back(std::move(thread));
+  }
+
+  // Gone (or now ignored): keep the slot so indices that already went
+  // downstream stay unique; the pending run is finished by a later scan.
+  for (std::size_t i = 1UL; i < seen.size(); i++)
+  {
+    Thread& thread = m_threads[i];
+
+    if (seen[i] || !thread.alive)
+    {
+      continue;
+    }
+
+    if (thread.has_run)
+    {
+      m_exited.push_back(i);
+    }
+
+    m_thread_index.erase(thread.id);
+
+    // Before the handle goes: until then the id cannot name a new thread.
+    m_trace->forget_thread(thread.id);
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+    ::CloseHandle(thread.handle);
+#endif
+
+    thread.handle = nullptr;
+    thread.alive  = false;
+  }
+}
+
+bool Scanner::m_cpu_share(Thread& thread, double& share) noexcept
+{
+  std::uint64_t       cpu = 0UL;
+  const std::uint64_t now = Clock::now_ns();
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+  const bool read = pace::thread_cpu_time(thread.handle, cpu);
+#else
+  const bool read = pace::thread_cpu_time(thread.id, cpu);
+#endif
+
+  if (!read)
+  {
+    return false;
+  }
+
+  const bool          known = thread.cpu_known;
+  const std::uint64_t used  = cpu - thread.cpu;
+  const std::uint64_t wall  = now - thread.cpu_checked_ns;
+
+  thread.cpu            = cpu;
+  thread.cpu_checked_ns = now;
+  thread.cpu_known      = true;
+
+  if (!known || m_cpu_per_ns <= 0.0 || wall == 0UL)
+  {
+    return false;
+  }
+
+  share = std::min(1.0, static_cast<double>(used) / (m_cpu_per_ns * static_cast<double>(wall)));
+  return true;
+}
+
+std::size_t Scanner::m_next_thread(void) noexcept
+{
+  for (std::size_t n = 0UL; n < m_threads.size(); n++)
+  {
+    const std::size_t index = m_cursor++ % m_threads.size();
+
+    if (m_threads[index].alive)
+    {
+      return index;
+    }
+  }
+
+  return 0UL;
+}
+
+LineLocation Scanner::m_line_location(const pace::Frame& frame) noexcept
+{
+  LineLocation location;
+
+  // Sample profiles only hold offsets below 0xFFFF; anything else (no line
+  // info, or a line before the function's own, as inlined code can be) has
+  // no usable offset.
+  if (frame.line != 0U && frame.function_line != 0U && frame.line >= frame.function_line &&
+      (frame.line - frame.function_line) < 0xFFFFU)
+  {
+    location.offset = frame.line - frame.function_line;
+  }
+
+  return location;
+}
+
+void Scanner::m_record_scan(const std::uint64_t begin) const noexcept
+{
+  if (m_metrics != nullptr)
+  {
+    m_metrics->scan.record(Clock::now_ns() - begin);
+  }
+}
+
+void Scanner::m_flush_run(Thread& thread) noexcept
+{
+  if (!thread.has_run)
+  {
+    return;
+  }
+
+  if (m_frame_buffer.push(thread.run))
+  {
+    common::fatal_trap();
+  }
+
+  thread.has_run = false;
+}
+
+bool Scanner::m_flush_runs(const std::size_t limit) noexcept
+{
+  std::size_t flushed = 0UL;
+
+  for (Thread& thread : m_threads)
+  {
+    if (thread.has_run)
+    {
+      if (flushed == limit)
+      {
+        return false;
+      }
+
+      m_flush_run(thread);
+      ++flushed;
+    }
+  }
+
+  return true;
+}
+
 Queue<Frame, 64UL>* Scanner::get_frame_buffer(void) noexcept
 {
   return &m_frame_buffer;
@@ -62,3 +444,78 @@ void Scanner::set_context(IContext* context) noexcept
 {
   m_context = context;
 }
+
+void Scanner::set_metrics(Metrics* metrics) noexcept
+{
+  m_metrics = metrics;
+}
+
+void Scanner::set_line_offsets(const bool enabled) noexcept
+{
+  m_line_offsets = enabled;
+}
+
+void Scanner::set_linkage_names(const bool enabled) noexcept
+{
+  m_linkage_names = enabled;
+}
+
+void Scanner::set_line_histogram(LineHistogram* histogram) noexcept
+{
+  m_line_histogram = histogram;
+}
+
+void Scanner::set_all_threads(const bool enabled, const bool thread_roots) noexcept
+{
+  m_all_threads  = enabled;
+  m_thread_roots = thread_roots;
+}
+
+void Scanner::ignore_current_thread(void) noexcept
+{
+  std::lock_guard<std::mutex> lock(m_ignored_mutex);
+  m_ignored.push_back(pace::current_thread_id());
+  m_ignored_changed = true;
+}
+
+void Scanner::set_sample_mode(const SampleMode mode) noexcept
+{
+  m_sample_mode = mode;
+}
+
+void Scanner::set_stack_copy(const std::size_t bytes) noexcept
+{
+  if (!m_trace->set_stack_copy(bytes) && bytes > 0UL)
+  {
+    std::cerr << "[scan] stack copies not supported, unwinding in place\n";
+  }
+}
+
+std::size_t Scanner::get_threads(void) const noexcept
+{
+  return m_threads.size();
+}
+
+void Scanner::resolve_lines(void) noexcept
+{
+  if (m_line_histogram == nullptr)
+  {
+    return;
+  }
+
+  m_line_histogram->resolve([this](const std::uintptr_t pc, SourceLine& out) noexcept
+  {
+    pace::Frame frame;
+
+    if (!m_trace->symbolize(pc, frame))
+    {
+      return false;
+    }
+
+    out.function = std::move(frame.function);
+    out.file     = std::move(frame.file);
+    out.line     = frame.line;
+
+    return true;
+  });
+}
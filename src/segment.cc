@@ -0,0 +1,311 @@
+#include "segment.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace
+{
+  inline void store_u32(std::uint8_t* p, const std::uint32_t v) noexcept
+  {
+    p[0] = static_cast<std::uint8_t>(v);
+    p[1] = static_cast<std::uint8_t>(v >> 8);
+    p[2] = static_cast<std::uint8_t>(v >> 16);
+    p[3] = static_cast<std::uint8_t>(v >> 24);
+  }
+} // namespace
+
+SegmentWriter::SegmentWriter(std::string base, const std::size_t segment_bytes, const std::uint32_t version) noexcept
+  : m_base(std::move(base)),
+    m_segment_bytes(segment_bytes),
+    m_version(version)
+{
+  if (m_segment_bytes > kHeaderBytes)
+  {
+    (void)m_open_next();
+  }
+}
+
+SegmentWriter::~SegmentWriter() noexcept
+{
+  m_close_current();
+}
+
+std::string SegmentWriter::segment_path(const std::string& base, const std::uint32_t index) noexcept
+{
+  char suffix[16];
+  (void)std::snprintf(suffix, sizeof(suffix), ".%04u", static_cast<unsigned>(index));
+  return base + suffix;
+}
+
+bool SegmentWriter::m_open_next(void) noexcept
+{
+  const std::string path = segment_path(m_base, m_index);
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  m_file = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                         nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  const DWORD64 size = static_cast<DWORD64>(m_segment_bytes);
+
+  m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+  if (m_mapping == nullptr)
+  {
+    ::CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+    return false;
+  }
+
+  m_data = static_cast<std::uint8_t*>(::MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, m_segment_bytes));
+  if (m_data == nullptr)
+  {
+    ::CloseHandle(m_mapping);
+    ::CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file    = INVALID_HANDLE_VALUE;
+    return false;
+  }
+#else
+  m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0)
+  {
+    return false;
+  }
+
+  if (::ftruncate(m_fd, static_cast<off_t>(m_segment_bytes)) != 0)
+  {
+    ::close(m_fd);
+    m_fd = -1;
+    return false;
+  }
+
+  void* map = ::mmap(nullptr, m_segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED)
+  {
+    ::close(m_fd);
+    m_fd = -1;
+    return false;
+  }
+
+  m_data = static_cast<std::uint8_t*>(map);
+#endif
+
+  std::memcpy(m_data, kMagic, sizeof(kMagic));
+  store_u32(m_data + 8,  m_version);
+  store_u32(m_data + 12, m_index);
+
+  m_used   = kHeaderBytes;
+  m_total += kHeaderBytes;
+
+  ++m_index;
+
+  return true;
+}
+
+void SegmentWriter::m_close_current(void) noexcept
+{
+  if (m_data == nullptr)
+  {
+    return;
+  }
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  (void)::FlushViewOfFile(m_data, m_used);
+  (void)::UnmapViewOfFile(m_data);
+  (void)::CloseHandle(m_mapping);
+
+  LARGE_INTEGER end;
+  end.QuadPart = static_cast<LONGLONG>(m_used);
+
+  if (::SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN))
+  {
+    (void)::SetEndOfFile(m_file);
+  }
+
+  (void)::CloseHandle(m_file);
+
+  m_mapping = nullptr;
+  m_file    = INVALID_HANDLE_VALUE;
+#else
+  (void)::munmap(m_data, m_segment_bytes);
+  (void)::ftruncate(m_fd, static_cast<off_t>(m_used));
+  (void)::close(m_fd);
+
+  m_fd = -1;
+#endif
+
+  m_data = nullptr;
+  m_used = 0UL;
+}
+
+bool SegmentWriter::is_open(void) const noexcept
+{
+  return (m_data != nullptr);
+}
+
+std::uint8_t* SegmentWriter::reserve(const std::size_t n) noexcept
+{
+  if (n > (m_segment_bytes - kHeaderBytes))
+  {
+    return nullptr;
+  }
+
+  if (m_data != nullptr && (m_used + n) <= m_segment_bytes)
+  {
+    return m_data + m_used;
+  }
+
+  m_close_current();
+
+  if (!m_open_next())
+  {
+    return nullptr;
+  }
+
+  return m_data + m_used;
+}
+
+void SegmentWriter::commit(const std::size_t n) noexcept
+{
+  m_used  += n;
+  m_total += n;
+}
+
+void SegmentWriter::flush(void) noexcept
+{
+  if (m_data == nullptr)
+  {
+    return;
+  }
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  (void)::FlushViewOfFile(m_data, m_used);
+#else
+  (void)::msync(m_data, m_segment_bytes, MS_ASYNC);
+#endif
+}
+
+std::uint32_t SegmentWriter::get_segments(void) const noexcept
+{
+  return m_index;
+}
+
+std::uint64_t SegmentWriter::get_bytes(void) const noexcept
+{
+  return m_total;
+}
+
+MappedFile::MappedFile(const std::string& path) noexcept
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  m_file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                         nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE)
+  {
+    return;
+  }
+
+  LARGE_INTEGER size;
+
+  if (!::GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+  {
+    return;
+  }
+
+  m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mapping == nullptr)
+  {
+    return;
+  }
+
+  m_data = static_cast<const std::uint8_t*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  m_size = (m_data != nullptr) ? static_cast<std::size_t>(size.QuadPart) : 0UL;
+#else
+  m_fd = ::open(path.c_str(), O_RDONLY);
+  if (m_fd < 0)
+  {
+    return;
+  }
+
+  struct stat st;
+
+  if (::fstat(m_fd, &st) != 0 || st.st_size == 0)
+  {
+    return;
+  }
+
+  void* map = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+  if (map == MAP_FAILED)
+  {
+    return;
+  }
+
+  // Records are decoded front to back exactly once.
+  (void)::madvise(map, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+  m_data = static_cast<const std::uint8_t*>(map);
+  m_size = static_cast<std::size_t>(st.st_size);
+#endif
+}
+
+MappedFile::~MappedFile() noexcept
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  if (m_data != nullptr)
+  {
+    (void)::UnmapViewOfFile(m_data);
+  }
+
+  if (m_mapping != nullptr)
+  {
+    (void)::CloseHandle(m_mapping);
+  }
+
+  if (m_file != INVALID_HANDLE_VALUE)
+  {
+    (void)::CloseHandle(m_file);
+  }
+#else
+  if (m_data != nullptr)
+  {
+    (void)::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+  }
+
+  if (m_fd >= 0)
+  {
+    (void)::close(m_fd);
+  }
+#endif
+}
+
+bool MappedFile::is_open(void) const noexcept
+{
+  return (m_data != nullptr);
+}
+
+const std::uint8_t* MappedFile::data(void) const noexcept
+{
+  return m_data;
+}
+
+std::size_t MappedFile::size(void) const noexcept
+{
+  return m_size;
+}
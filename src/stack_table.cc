@@ -0,0 +1,145 @@
+#include "stack_table.hpp"
+
+#include "xxhash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+  constexpr std::size_t kInitialSlots = 1024UL;
+} // namespace
+
+StackTable::StackTable() noexcept : m_slots(kInitialSlots, Slot{{0UL, 0UL}, 0UL, 0UL, 0UL}) {}
+
+StackTable::Hash StackTable::m_hash(const std::uint32_t* stack, const std::size_t depth) noexcept
+{
+  const XXH128_hash_t digest = ::XXH3_128bits(stack, depth * sizeof(std::uint32_t));
+  return {static_cast<std::uint64_t>(digest.low64), static_cast<std::uint64_t>(digest.high64)};
+}
+
+void StackTable::m_grow(void) noexcept
+{
+  std::vector<Slot> slots(m_slots.size() * 2UL, Slot{{0UL, 0UL}, 0UL, 0UL, 0UL});
+  const std::size_t mask = slots.size() - 1UL;
+
+  // Stacks are distinct by construction: only an empty slot is needed.
+  for (const Slot& slot : m_slots)
+  {
+    if (slot.count == 0UL)
+    {
+      continue;
+    }
+
+    std::size_t i = static_cast<std::size_t>(slot.hash.low) & mask;
+
+    while (slots[i].count != 0UL)
+    {
+      i = (i + 1UL) & mask;
+    }
+
+    slots[i] = slot;
+  }
+
+  m_slots.swap(slots);
+}
+
+void StackTable::add(const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+{
+  if (count == 0UL)
+  {
+    return;
+  }
+
+  const Hash hash = m_hash(stack, depth);
+
+  // Keep the load factor at or under one half.
+  if ((m_size + 1UL) * 2UL > m_slots.size())
+  {
+    m_grow();
+  }
+
+  const std::size_t mask = m_slots.size() - 1UL;
+
+  m_samples += count;
+
+  for (std::size_t i = static_cast<std::size_t>(hash.low) & mask;; i = (i + 1UL) & mask)
+  {
+    Slot& slot = m_slots[i];
+
+    if (slot.count == 0UL)
+    {
+      slot = {hash, count, m_frames.size(), depth};
+      m_frames.insert(m_frames.end(), stack, stack + depth);
+
+      ++m_size;
+      m_last = i;
+      return;
+    }
+
+    if (slot.hash.low == hash.low && slot.hash.high == hash.high && slot.depth == depth)
+    {
+      slot.count += count;
+      m_last      = i;
+      return;
+    }
+  }
+}
+
+void StackTable::repeat(const std::uint64_t count) noexcept
+{
+  if (m_slots[m_last].count > 0UL)
+  {
+    m_slots[m_last].count += count;
+    m_samples             += count;
+  }
+}
+
+std::uint64_t StackTable::count(const std::uint32_t* stack, const std::size_t depth) const noexcept
+{
+  const Hash        hash = m_hash(stack, depth);
+  const std::size_t mask = m_slots.size() - 1UL;
+
+  for (std::size_t i = static_cast<std::size_t>(hash.low) & mask;; i = (i + 1UL) & mask)
+  {
+    const Slot& slot = m_slots[i];
+
+    if (slot.count == 0UL)
+    {
+      return 0UL;
+    }
+
+    if (slot.hash.low == hash.low && slot.hash.high == hash.high && slot.depth == depth)
+    {
+      return slot.count;
+    }
+  }
+}
+
+void StackTable::merge(const StackTable& other) noexcept
+{
+  other.for_each([this](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    add(stack, depth, count);
+  });
+}
+
+void StackTable::clear(void) noexcept
+{
+  m_slots.assign(kInitialSlots, Slot{{0UL, 0UL}, 0UL, 0UL, 0UL});
+  m_frames.clear();
+  m_size    = 0UL;
+  m_last    = 0UL;
+  m_samples = 0UL;
+}
+
+std::size_t StackTable::size(void) const noexcept
+{
+  return m_size;
+}
+
+std::uint64_t StackTable::get_samples(void) const noexcept
+{
+  return m_samples;
+}
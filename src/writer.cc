@@ -0,0 +1,58 @@
+#include "writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+Writer::Writer(const std::string& path, const std::size_t buffer_bytes) noexcept
+  : m_file(std::fopen(path.c_str(), "wb")),
+    m_buffer((buffer_bytes > 0UL) ? buffer_bytes : 1UL)
+{
+  if (m_file != nullptr)
+  {
+    (void)std::setvbuf(m_file, nullptr, _IONBF, 0UL);
+  }
+}
+
+Writer::~Writer() noexcept
+{
+  (void)close();
+}
+
+void Writer::m_drain(void) noexcept
+{
+  if (m_used == 0UL)
+  {
+    return;
+  }
+
+  m_failed = m_failed || (m_file == nullptr) || (std::fwrite(m_buffer.data(), 1UL, m_used, m_file) != m_used);
+  m_bytes += m_used;
+  m_used   = 0UL;
+}
+
+bool Writer::is_open(void) const noexcept
+{
+  return m_file != nullptr;
+}
+
+int Writer::close(void) noexcept
+{
+  if (m_file == nullptr)
+  {
+    return kIoError;
+  }
+
+  m_drain();
+
+  const bool closed = (std::fclose(m_file) == 0);
+  m_file = nullptr;
+
+  return (closed && !m_failed) ? kOk : kIoError;
+}
+
+std::uint64_t Writer::get_bytes(void) const noexcept
+{
+  return m_bytes + m_used;
+}
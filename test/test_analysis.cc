@@ -0,0 +1,300 @@
+#include "analysis.hpp"
+#include "sample_log.hpp"
+#include "segment.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::string kPath = "test_analysis.tmp";
+
+  void remove_segments(void) noexcept
+  {
+    for (std::uint32_t i = 0U; i < 256U; i++)
+    {
+      (void)std::remove(SegmentWriter::segment_path(kPath, i).c_str());
+    }
+  }
+
+  // main -> a -> leaf (x6), main -> b -> leaf (x3), main -> a (x1),
+  // recursive main -> r -> r -> r (x2), repeated `rounds` times.
+  void write_log(const std::size_t segment_bytes, const std::uint64_t rounds) noexcept
+  {
+    SampleLogWriter writer(kPath, segment_bytes);
+
+    assert(writer.is_open());
+
+    writer.define(0U, "main");
+    writer.define(1U, "a");
+    writer.define(2U, "b");
+    writer.define(3U, "leaf");
+    writer.define(4U, "r");
+
+    const std::uint32_t a_leaf[] = {0U, 1U, 3U};
+    const std::uint32_t b_leaf[] = {0U, 2U, 3U};
+    const std::uint32_t a[]      = {0U, 1U};
+    const std::uint32_t r[]      = {0U, 4U, 4U, 4U};
+
+    std::uint64_t t = 0UL;
+
+    for (std::uint64_t i = 0UL; i < rounds; i++)
+    {
+      writer.sample(t += 10UL, 6UL, a_leaf, 3UL);
+      writer.sample(t += 10UL, 3UL, b_leaf, 3UL);
+      writer.sample(t += 10UL, 1UL, a, 2UL);
+      writer.sample(t += 10UL, 2UL, r, 4UL);
+    }
+  }
+
+  FunctionCost cost_of(const std::vector<FunctionCost>& costs, const std::uint32_t id) noexcept
+  {
+    for (const FunctionCost& cost : costs)
+    {
+      if (cost.id == id)
+      {
+        return cost;
+      }
+    }
+
+    return {};
+  }
+} // namespace
+
+void test_stack_table_merge(void)
+{
+  StackTable x, y;
+
+  const std::uint32_t s1[] = {1U, 2U, 3U};
+  const std::uint32_t s2[] = {1U, 2U};
+
+  x.add(s1, 3UL, 2UL);
+  x.add(s2, 2UL, 1UL);
+  y.add(s1, 3UL, 5UL);
+
+  // Enough distinct stacks to force several rehashes.
+  for (std::uint32_t i = 0U; i < 5000U; i++)
+  {
+    const std::uint32_t s[] = {i, i + 1U, 1000000U};
+    y.add(s, 3UL, 1UL);
+  }
+
+  x.merge(y);
+
+  assert(x.get_samples() == 8UL + 5000UL);
+  assert(x.size() == 5002UL);
+
+  std::uint64_t s1_count = 0UL;
+
+  x.for_each([&](const std::uint32_t* stack, const std::size_t depth, const std::uint64_t count) noexcept
+  {
+    if (depth == 3UL && stack[0] == 1U && stack[1] == 2U && stack[2] == 3U)
+    {
+      s1_count = count;
+    }
+  });
+
+  assert(s1_count == 7UL);
+}
+
+void test_analysis_views(void)
+{
+  remove_segments();
+  write_log(SampleLogWriter::kDefaultSegmentBytes, 1UL);
+
+  Profile profile;
+
+  assert(profile.load(kPath, 1U) == Profile::kOk);
+  assert(profile.get_samples() == 12UL);
+  assert(profile.get_stacks().size() == 4UL);
+  assert(profile.get_duration_ns() == 30UL);
+
+  const auto costs = profile.flat();
+
+  assert(costs.front().id == 3U && costs.front().self == 9UL);
+  assert(cost_of(costs, 0U).total == 12UL && cost_of(costs, 0U).self == 0UL);
+  assert(cost_of(costs, 1U).total == 7UL  && cost_of(costs, 1U).self == 1UL);
+  // Recursion counts once per sample.
+  assert(cost_of(costs, 4U).total == 2UL  && cost_of(costs, 4U).self == 2UL);
+
+  const auto paths = profile.hot_paths(2UL);
+
+  assert(paths.size() == 2UL);
+  assert((paths[0].stack == std::vector<std::uint32_t>{0U, 1U, 3U}) && paths[0].count == 6UL);
+  assert(paths[1].count == 3UL);
+
+  const auto callers = profile.callers(profile.find("leaf"));
+
+  assert(callers.size() == 2UL);
+  assert(callers[0].caller == 1U && callers[0].count == 6UL);
+  assert(callers[1].caller == 2U && callers[1].count == 3UL);
+
+  const auto callees = profile.callees(profile.find("main"));
+
+  assert(callees.size() == 3UL && callees[0].callee == 1U && callees[0].count == 7UL);
+
+  const auto self_calls = profile.callees(profile.find("r"));
+
+  assert(self_calls.size() == 1UL && self_calls[0].callee == 4U && self_calls[0].count == 2UL);
+  assert(profile.find("missing") == Profile::kNotFound);
+
+  remove_segments();
+}
+
+void test_analysis_parallel_matches_serial(void)
+{
+  remove_segments();
+
+  // Small segments spread the log over many files and shards.
+  write_log(512UL, 500UL);
+
+  Profile serial, parallel;
+
+  assert(serial.load(kPath, 1U)   == Profile::kOk);
+  assert(parallel.load(kPath, 4U) == Profile::kOk);
+
+  assert(serial.get_segments() > 4U);
+  assert(parallel.get_segments() == serial.get_segments());
+  assert(serial.get_samples()    == 6000UL);
+  assert(parallel.get_samples()  == serial.get_samples());
+
+  const auto a = serial.flat();
+  const auto b = parallel.flat();
+
+  assert(a.size() == b.size());
+
+  for (std::size_t i = 0UL; i < a.size(); i++)
+  {
+    assert(a[i].id == b[i].id && a[i].self == b[i].self && a[i].total == b[i].total);
+  }
+
+  assert(parallel.name(3U) == "leaf");
+
+  remove_segments();
+}
+
+void test_analysis_diff(void)
+{
+  const std::string base_path = kPath + ".base";
+
+  for (std::uint32_t i = 0U; i < 4U; i++)
+  {
+    (void)std::remove(SegmentWriter::segment_path(base_path, i).c_str());
+  }
+
+  {
+    // Baseline: main;work 500 and main;idle 500, with ids in another order.
+    SampleLogWriter writer(base_path);
+
+    writer.define(7U, "idle");
+    writer.define(3U, "main");
+    writer.define(5U, "work");
+
+    const std::uint32_t work[] = {3U, 5U};
+    const std::uint32_t idle[] = {3U, 7U};
+
+    writer.sample(0UL,          500UL, work, 2UL);
+    writer.sample(1000000000UL, 500UL, idle, 2UL);
+  }
+
+  remove_segments();
+
+  {
+    // Candidate: work grew to 800 of 1000, and a new function appears.
+    SampleLogWriter writer(kPath);
+
+    writer.define(0U, "main");
+    writer.define(1U, "work");
+    writer.define(2U, "idle");
+    writer.define(3U, "fresh");
+
+    const std::uint32_t work[]  = {0U, 1U};
+    const std::uint32_t idle[]  = {0U, 2U};
+    const std::uint32_t fresh[] = {0U, 3U};
+
+    writer.sample(0UL,          800UL, work,  2UL);
+    writer.sample(500000000UL,  190UL, idle,  2UL);
+    writer.sample(1000000000UL, 10UL,  fresh, 2UL);
+  }
+
+  Profile baseline, candidate;
+
+  assert(baseline.load(base_path, 1U) == Profile::kOk);
+  assert(candidate.load(kPath, 2U)    == Profile::kOk);
+
+  const ProfileDiff diff(baseline, candidate);
+  const auto deltas = diff.functions();
+
+  assert(deltas.size() == 4UL);
+  assert(diff.name(deltas.front().id) == "work");
+  assert(deltas.front().base_self == 0.5 && deltas.front().cand_self == 0.8);
+  assert(deltas.front().self_z > 10.0);
+  assert(diff.name(deltas.back().id) == "idle" && deltas.back().self_z < -10.0);
+
+  for (const FunctionDelta& d : deltas)
+  {
+    if (diff.name(d.id) == "main")
+    {
+      assert(d.base_total == 1.0 && d.cand_total == 1.0 && d.total_z == 0.0);
+    }
+
+    if (diff.name(d.id) == "fresh")
+    {
+      assert(d.base_self == 0.0 && d.cand_self == 0.01);
+    }
+  }
+
+  const auto regressed = diff.regressions(1UL);
+
+  assert(regressed.size() == 1UL && regressed[0].base == 500UL && regressed[0].cand == 800UL);
+
+  const auto improved = diff.improvements(5UL);
+
+  assert(improved.size() == 1UL && diff.name(improved[0].stack.back()) == "idle");
+
+  const std::string folded = kPath + ".folded";
+
+  assert(diff.write_folded(folded) == ProfileDiff::kOk);
+
+  std::FILE* file = std::fopen(folded.c_str(), "rb");
+  assert(file != nullptr);
+
+  char buffer[256] = {};
+  const std::size_t n = std::fread(buffer, 1UL, sizeof(buffer) - 1UL, file);
+  (void)std::fclose(file);
+
+  const std::string text(buffer, n);
+
+  assert(text.find("main;work 500 800\n")  != std::string::npos);
+  assert(text.find("main;idle 500 190\n")  != std::string::npos);
+  assert(text.find("main;fresh 0 10\n")    != std::string::npos);
+
+  (void)std::remove(folded.c_str());
+  (void)std::remove(SegmentWriter::segment_path(base_path, 0U).c_str());
+  remove_segments();
+}
+
+void test_analysis_missing_log(void)
+{
+  remove_segments();
+
+  Profile profile;
+
+  assert(profile.load(kPath, 2U) == Profile::kMissing);
+  assert(profile.get_samples() == 0UL);
+}
+
+int main(void)
+{
+  test_stack_table_merge();
+  test_analysis_views();
+  test_analysis_parallel_matches_serial();
+  test_analysis_diff();
+  test_analysis_missing_log();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+#include "bqueue.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+void test_bqueue_push_pop(void)
+{
+  BlockingQueue<std::uint32_t, 4UL> queue;
+
+  assert(queue.push(1) == 0);
+  assert(queue.push(2) == 0);
+  assert(queue.push(3) == 0);
+  assert(queue.push(4) == 0);
+
+  assert(queue.try_push(5) == (-1));
+
+  std::size_t size = 0UL;
+
+  assert(queue.size(size) == 0 && size == 4UL);
+
+  std::uint32_t element = 0U;
+
+  assert(queue.pop(element) == 0 && element == 1U);
+  assert(queue.pop(element) == 0 && element == 2U);
+  assert(queue.pop(element) == 0 && element == 3U);
+  assert(queue.pop(element) == 0 && element == 4U);
+
+  assert(queue.try_pop(element) == (-2));
+}
+
+void test_bqueue_close(void)
+{
+  BlockingQueue<std::uint32_t, 4UL> queue;
+
+  assert(queue.push(1) == 0);
+
+  queue.close();
+
+  assert(queue.push(2)     == (-3));
+  assert(queue.try_push(2) == (-3));
+
+  std::uint32_t element = 0U;
+
+  // Elements queued before close() are still delivered.
+  assert(queue.pop(element) == 0 && element == 1U);
+  assert(queue.pop(element)     == (-3));
+  assert(queue.try_pop(element) == (-3));
+}
+
+void test_bqueue_backpressure(void)
+{
+  BlockingQueue<std::uint64_t, 4UL> queue;
+
+  // The producer outruns the 4-slot queue and must block until the consumer
+  // catches up; order and totals must survive.
+  std::thread producer([&]
+  {
+    for (std::uint64_t i = 1UL; i <= 10000UL; i++)
+    {
+      assert(queue.push(i) == 0);
+    }
+
+    queue.close();
+  });
+
+  std::uint64_t expected = 1UL;
+  std::uint64_t element  = 0UL;
+
+  while (queue.pop(element) == 0)
+  {
+    assert(element == expected);
+    ++expected;
+  }
+
+  producer.join();
+
+  assert(expected == 10001UL);
+}
+
+void test_bqueue_drop_policies(void)
+{
+  BlockingQueue<std::uint32_t, 4UL> newest(OverflowPolicy::DROP_NEWEST);
+  BlockingQueue<std::uint32_t, 4UL> oldest(OverflowPolicy::DROP_OLDEST);
+  BlockingQueue<std::uint32_t, 4UL> reject(OverflowPolicy::REJECT);
+
+  for (std::uint32_t i = 1U; i <= 6U; i++)
+  {
+    assert(newest.push(i) == 0);
+    assert(oldest.push(i) == 0);
+  }
+
+  for (std::uint32_t i = 1U; i <= 4U; i++)
+  {
+    assert(reject.push(i) == 0);
+  }
+
+  assert(reject.push(5U) == (-1));
+
+  std::uint64_t dropped = 0UL;
+
+  assert(newest.dropped(dropped) == 0 && dropped == 2UL);
+  assert(oldest.dropped(dropped) == 0 && dropped == 2UL);
+  assert(reject.dropped(dropped) == 0 && dropped == 0UL);
+
+  std::uint32_t element = 0U;
+
+  assert(newest.pop(element) == 0 && element == 1U);
+  assert(oldest.pop(element) == 0 && element == 3U);
+}
+
+void test_bqueue_block_timeout(void)
+{
+  BlockingQueue<std::uint32_t, 2UL> queue(OverflowPolicy::BLOCK, std::chrono::milliseconds(5));
+
+  assert(queue.push(1U) == 0);
+  assert(queue.push(2U) == 0);
+
+  // Nobody drains: the push gives up after the timeout and counts the loss.
+  const auto begin = std::chrono::steady_clock::now();
+
+  assert(queue.push(3U) == 0);
+
+  assert((std::chrono::steady_clock::now() - begin) >= std::chrono::milliseconds(5));
+
+  std::uint64_t dropped = 0UL;
+
+  assert(queue.dropped(dropped) == 0 && dropped == 1UL);
+
+  std::uint32_t element = 0U;
+
+  assert(queue.pop(element) == 0 && element == 1U);
+  assert(queue.push(4U) == 0);
+  assert(queue.dropped(dropped) == 0 && dropped == 1UL);
+}
+
+int main(void)
+{
+  test_bqueue_push_pop();
+  test_bqueue_close();
+  test_bqueue_backpressure();
+  test_bqueue_drop_policies();
+  test_bqueue_block_timeout();
+
+  return EXIT_SUCCESS;
+}
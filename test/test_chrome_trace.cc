@@ -0,0 +1,80 @@
+#include "chrome_trace.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+  const std::string kPath = "test_chrome_trace.tmp";
+
+  std::string read_file(const std::string& path) noexcept
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  }
+} // namespace
+
+void test_chrome_trace_events(void)
+{
+  ChromeTraceWriter trace(kPath, 16UL);  // a tiny buffer forces many flushes
+
+  assert(trace.is_open());
+
+  trace.define(0U, "main");
+  trace.define(2U, "say \"hi\"\\\n");
+  trace.thread_name(1U, "target");
+  trace.begin(1U, 0U, 1500UL);
+  trace.begin(1U, 2U, 2000007UL);
+  trace.end(1U, 2U, 3000000UL);
+  trace.end(1U, 1U, 3000000UL);  // never defined
+
+  assert(trace.get_events() == 5UL);
+  assert(trace.close() == ChromeTraceWriter::kOk);
+
+  // Ignored once closed.
+  trace.begin(1U, 0U, 4000000UL);
+  assert(trace.get_events() == 5UL);
+
+  const std::string expected =
+    "[\n"
+    "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"target\"}},\n"
+    "{\"ph\":\"B\",\"name\":\"main\",\"ts\":1.500,\"pid\":1,\"tid\":1},\n"
+    "{\"ph\":\"B\",\"name\":\"say \\\"hi\\\"\\\\\\u000a\",\"ts\":2000.007,\"pid\":1,\"tid\":1},\n"
+    "{\"ph\":\"E\",\"name\":\"say \\\"hi\\\"\\\\\\u000a\",\"ts\":3000.000,\"pid\":1,\"tid\":1},\n"
+    "{\"ph\":\"E\",\"name\":\"?\",\"ts\":3000.000,\"pid\":1,\"tid\":1}\n"
+    "]\n";
+
+  assert(read_file(kPath) == expected);
+  assert(trace.get_bytes() == expected.size());
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_chrome_trace_unclosed(void)
+{
+  {
+    ChromeTraceWriter trace(kPath);
+  }
+
+  // The destructor still terminates the array.
+  assert(read_file(kPath) == "[\n]\n");
+
+  (void)std::remove(kPath.c_str());
+
+  ChromeTraceWriter trace("no/such/directory/file");
+
+  assert(!trace.is_open());
+  assert(trace.close() == ChromeTraceWriter::kIoError);
+}
+
+int main(void)
+{
+  test_chrome_trace_events();
+  test_chrome_trace_unclosed();
+
+  return EXIT_SUCCESS;
+}
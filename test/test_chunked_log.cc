@@ -0,0 +1,136 @@
+#include "chunked_log.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+  // Room for a 16-byte chunk header and four 8-byte records.
+  constexpr std::size_t kChunkSize = 48UL;
+
+  using Log = ChunkedLog<std::uint64_t>;
+} // namespace
+
+void test_chunked_log_fifo_across_chunks(void)
+{
+  Log log(/*max_chunks=*/16UL, OverflowPolicy::REJECT, kChunkSize);
+
+  assert(log.get_records_per_chunk() == 4UL);
+
+  for (std::uint64_t i = 0UL; i < 10UL; i++)
+  {
+    assert(log.push(i) == 0);
+  }
+
+  std::size_t size = 0UL;
+
+  assert(log.size(size) == 0 && size == 10UL);
+  assert(log.get_chunks() == 3UL);
+
+  std::uint64_t expected = 0UL;
+
+  log.for_each([&](const std::uint64_t v) { assert(v == expected++); });
+
+  assert(expected == 10UL);
+
+  std::uint64_t element = 0UL;
+
+  for (std::uint64_t i = 0UL; i < 10UL; i++)
+  {
+    assert(log.pop(element) == 0 && element == i);
+  }
+
+  assert(log.pop(element) == (-2));
+}
+
+void test_chunked_log_reuses_drained_chunks(void)
+{
+  Log log(/*max_chunks=*/2UL, OverflowPolicy::REJECT, kChunkSize);
+
+  std::uint64_t element = 0UL;
+
+  // Interleaved produce/consume never needs more than the budget.
+  for (std::uint64_t i = 0UL; i < 1000UL; i++)
+  {
+    assert(log.push(i) == 0);
+    assert(log.pop(element) == 0 && element == i);
+  }
+
+  for (std::uint64_t i = 0UL; i < 8UL; i++)
+  {
+    assert(log.push(i) == 0);
+  }
+
+  assert(log.get_chunks() == 2UL);
+}
+
+void test_chunked_log_budget_reject(void)
+{
+  Log log(/*max_chunks=*/2UL, OverflowPolicy::REJECT, kChunkSize);
+
+  for (std::uint64_t i = 0UL; i < 8UL; i++)
+  {
+    assert(log.push(i) == 0);
+  }
+
+  assert(log.push(8UL) == (-1));
+
+  std::uint64_t dropped = 0UL;
+
+  assert(log.dropped(dropped) == 0 && dropped == 0UL);
+}
+
+void test_chunked_log_budget_drop_newest(void)
+{
+  Log log(/*max_chunks=*/2UL, OverflowPolicy::DROP_NEWEST, kChunkSize);
+
+  for (std::uint64_t i = 0UL; i < 10UL; i++)
+  {
+    assert(log.push(i) == 0);
+  }
+
+  std::uint64_t dropped = 0UL;
+  std::uint64_t element = 0UL;
+
+  assert(log.dropped(dropped) == 0 && dropped == 2UL);
+  assert(log.pop(element) == 0 && element == 0UL);
+}
+
+void test_chunked_log_budget_drop_oldest(void)
+{
+  Log log(/*max_chunks=*/2UL, OverflowPolicy::DROP_OLDEST, kChunkSize);
+
+  for (std::uint64_t i = 0UL; i < 10UL; i++)
+  {
+    assert(log.push(i) == 0);
+  }
+
+  // The first chunk (0..3) was evicted to make room for 8 and 9.
+  std::uint64_t dropped = 0UL;
+  std::size_t   size    = 0UL;
+
+  assert(log.dropped(dropped) == 0 && dropped == 4UL);
+  assert(log.size(size)       == 0 && size    == 6UL);
+
+  std::uint64_t element = 0UL;
+
+  for (std::uint64_t i = 4UL; i < 10UL; i++)
+  {
+    assert(log.pop(element) == 0 && element == i);
+  }
+
+  assert(log.get_chunks() == 2UL);
+}
+
+int main(void)
+{
+  test_chunked_log_fifo_across_chunks();
+  test_chunked_log_reuses_drained_chunks();
+  test_chunked_log_budget_reject();
+  test_chunked_log_budget_drop_newest();
+  test_chunked_log_budget_drop_oldest();
+
+  return EXIT_SUCCESS;
+}
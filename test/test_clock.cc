@@ -0,0 +1,69 @@
+#include "clock.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+void test_clock_monotonic(void)
+{
+  Clock& clock = Clock::get_instance();
+
+  clock.start();
+
+  std::uint64_t previous = clock.elapsed();
+
+  for (int i = 0; i < 100000; i++)
+  {
+    const std::uint64_t now = clock.elapsed();
+    assert(now >= previous);
+    previous = now;
+  }
+}
+
+void test_clock_matches_monotonic(void)
+{
+  Clock& clock = Clock::get_instance();
+
+  clock.start();
+
+  const std::uint64_t ns0 = Clock::now_ns();
+  const std::uint64_t t0  = clock.now();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  const std::uint64_t ns1 = Clock::now_ns();
+  const std::uint64_t t1  = clock.now();
+
+  // Calibrated ticks must agree with CLOCK_MONOTONIC to within 2%.
+  const double truth    = static_cast<double>(ns1 - ns0);
+  const double measured = static_cast<double>(clock.to_ns(t1 - t0));
+
+  assert(measured > truth * 0.98);
+  assert(measured < truth * 1.02);
+  assert(clock.to_seconds(t1 - t0) > 0.049);
+}
+
+void test_clock_start_stop(void)
+{
+  Clock& clock = Clock::get_instance();
+
+  clock.start();
+  assert(clock.get_stop() == clock.get_start());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  clock.stop();
+
+  assert(clock.get_stop() > clock.get_start());
+  assert(clock.to_seconds(clock.get_stop() - clock.get_start()) >= 0.004);
+}
+
+int main(void)
+{
+  test_clock_monotonic();
+  test_clock_matches_monotonic();
+  test_clock_start_stop();
+
+  return EXIT_SUCCESS;
+}
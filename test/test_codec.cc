@@ -0,0 +1,169 @@
+#include "codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+void test_codec_varint_round_trip(void)
+{
+  const std::uint64_t values[] = {0UL, 1UL, 127UL, 128UL, 16383UL, 16384UL,
+                                  0xFFFFFFFFUL, 0xFFFFFFFFFFFFFFFFUL};
+
+  std::array<std::uint8_t, varint::kMaxBytes> buffer{};
+
+  for (const std::uint64_t v : values)
+  {
+    std::uint8_t* end = codec::put(buffer.data(), v);
+
+    std::uint64_t out = 0UL;
+
+    assert(codec::get(buffer.data(), end, out) == end);
+    assert(out == v);
+
+    // One byte short is always rejected.
+    assert(codec::get(buffer.data(), end - 1, out) == nullptr);
+  }
+
+  assert(codec::put(buffer.data(), 127UL)   == buffer.data() + 1);
+  assert(codec::put(buffer.data(), 16383UL) == buffer.data() + 2);
+}
+
+void test_codec_stack_deltas(void)
+{
+  codec::StackEncoder encoder;
+  codec::StackDecoder decoder;
+
+  std::vector<std::uint8_t> buffer(4096UL);
+
+  const std::vector<std::vector<std::uint32_t>> stacks = {
+    {0U, 1U, 2U},
+    {0U, 1U, 2U},
+    {0U, 1U, 3U},
+    {0U},
+    {},
+    {5U, 6U, 7U, 8U},
+  };
+
+  std::uint8_t* out = buffer.data();
+
+  for (std::size_t i = 0UL; i < stacks.size(); i++)
+  {
+    out = encoder.encode(out, (i + 1UL) * 1000UL, i + 1UL, stacks[i].data(), stacks[i].size());
+  }
+
+  const std::uint8_t* p = buffer.data();
+
+  for (std::size_t i = 0UL; i < stacks.size(); i++)
+  {
+    std::uint64_t timestamp = 0UL;
+    std::uint64_t count     = 0UL;
+
+    p = decoder.decode(p, out, timestamp, count);
+
+    assert(p != nullptr);
+    assert(timestamp == (i + 1UL) * 1000UL);
+    assert(count     == i + 1UL);
+    assert(decoder.stack() == stacks[i]);
+  }
+
+  assert(p == out);
+}
+
+void test_codec_leaf_change_is_small(void)
+{
+  codec::StackEncoder encoder;
+
+  std::vector<std::uint32_t> stack(64UL);
+
+  for (std::size_t i = 0UL; i < stack.size(); i++)
+  {
+    stack[i] = static_cast<std::uint32_t>(i);
+  }
+
+  std::array<std::uint8_t, codec::StackEncoder::max_bytes(64UL)> buffer{};
+
+  (void)encoder.encode(buffer.data(), 0UL, 1UL, stack.data(), stack.size());
+
+  stack.back() = 1000U;
+
+  // 64 frames deep, one changed leaf: delta, count, pop 1, push 1, id.
+  const std::uint8_t* end = encoder.encode(buffer.data(), 10000UL, 1UL, stack.data(), stack.size());
+
+  assert(end - buffer.data() <= 7);
+}
+
+void test_codec_rejects_bad_pop(void)
+{
+  codec::StackDecoder decoder;
+
+  // pop 3 frames off an empty stack.
+  const std::uint8_t bytes[] = {0x00U, 0x01U, 0x03U, 0x00U};
+
+  std::uint64_t timestamp = 0UL;
+  std::uint64_t count     = 0UL;
+
+  assert(decoder.decode(bytes, bytes + sizeof(bytes), timestamp, count) == nullptr);
+}
+
+void test_codec_random_round_trip(void)
+{
+  std::mt19937_64 rng(42UL);
+  std::uniform_int_distribution<std::size_t>   depth_dist(0UL, 48UL);
+  std::uniform_int_distribution<std::uint32_t> id_dist(0U, 100000U);
+
+  codec::StackEncoder encoder;
+  codec::StackDecoder decoder;
+
+  std::vector<std::vector<std::uint32_t>> stacks;
+  std::vector<std::uint32_t> stack;
+
+  for (int i = 0; i < 2000; i++)
+  {
+    stack.resize(depth_dist(rng));
+
+    // Keep half the shared prefix of the previous sample, like a real profile.
+    const std::size_t keep = stacks.empty() ? 0UL : std::min(stacks.back().size(), stack.size()) / 2UL;
+
+    for (std::size_t d = 0UL; d < stack.size(); d++)
+    {
+      stack[d] = (d < keep) ? stacks.back()[d] : id_dist(rng);
+    }
+
+    stacks.push_back(stack);
+  }
+
+  std::vector<std::uint8_t> buffer(stacks.size() * codec::StackEncoder::max_bytes(48UL));
+  std::uint8_t* out = buffer.data();
+
+  for (std::size_t i = 0UL; i < stacks.size(); i++)
+  {
+    out = encoder.encode(out, i * 7919UL, 1UL, stacks[i].data(), stacks[i].size());
+  }
+
+  const std::uint8_t* p = buffer.data();
+
+  for (std::size_t i = 0UL; i < stacks.size(); i++)
+  {
+    std::uint64_t timestamp = 0UL;
+    std::uint64_t count     = 0UL;
+
+    p = decoder.decode(p, out, timestamp, count);
+
+    assert(p != nullptr && timestamp == i * 7919UL && decoder.stack() == stacks[i]);
+  }
+}
+
+int main(void)
+{
+  test_codec_varint_round_trip();
+  test_codec_stack_deltas();
+  test_codec_leaf_change_is_small();
+  test_codec_rejects_bad_pop();
+  test_codec_random_round_trip();
+
+  return EXIT_SUCCESS;
+}
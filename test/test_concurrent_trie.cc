@@ -0,0 +1,212 @@
+#include "concurrent_trie.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  template <std::size_t BucketCapacity = 64UL>
+  class MockConcurrentTrie : public ConcurrentHATTrie<BucketCapacity>
+  {
+  public:
+    MockConcurrentTrie() noexcept : ConcurrentHATTrie<BucketCapacity>() {}
+
+    bool root_is_bucket(void) const noexcept
+    {
+      return (this->m_root.load()->bucket.load() != nullptr);
+    }
+  };
+
+  static inline void insert_words(MockConcurrentTrie<>& trie) noexcept
+  {
+    trie.insert("foo");
+    trie.insert("far");
+    trie.insert("bar");
+    trie.insert("car");
+  }
+
+  static inline std::string make_key(std::uint64_t i) noexcept
+  {
+    std::string s = "a";
+    s += std::to_string(static_cast<unsigned long long>(i));
+    return s;
+  }
+} // namespace
+
+void test_concurrent_trie_insert_and_contains(void)
+{
+  MockConcurrentTrie<> trie;
+
+  insert_words(trie);
+
+  assert(trie.contains("foo") == true);
+  assert(trie.contains("far") == true);
+  assert(trie.contains("bar") == true);
+  assert(trie.contains("car") == true);
+
+  assert(trie.contains("fo")  == false);
+  assert(trie.contains("f")   == false);
+  assert(trie.contains("tar") == false);
+}
+
+void test_concurrent_trie_prefix(void)
+{
+  MockConcurrentTrie<> trie;
+
+  insert_words(trie);
+
+  assert(trie.has_prefix("fo")  == true);
+  assert(trie.has_prefix("c")   == true);
+  assert(trie.has_prefix("ko")  == false);
+
+  assert(trie.matches_prefix("foobar")      == true);
+  assert(trie.matches_prefix("fo")          == false);
+  assert(trie.matches_substring("xxcarxx")  == true);
+  assert(trie.matches_substring("xxcaxx")   == false);
+}
+
+void test_concurrent_trie_clear(void)
+{
+  MockConcurrentTrie<> trie;
+
+  insert_words(trie);
+  trie.clear();
+
+  assert(trie.root_is_bucket() == true);
+  assert(trie.contains("foo")  == false);
+  assert(trie.has_prefix("f")  == false);
+}
+
+void test_concurrent_trie_promote(void)
+{
+  MockConcurrentTrie<8UL> trie;
+
+  for (std::uint64_t i = 0UL; i < 64UL; i++)
+  {
+    trie.insert(make_key(i));
+  }
+
+  assert(trie.root_is_bucket() == false);
+
+  for (std::uint64_t i = 0UL; i < 64UL; i++)
+  {
+    assert(trie.contains(make_key(i)) == true);
+  }
+
+  assert(trie.has_prefix("a") == true);
+  assert(trie.has_prefix("b") == false);
+}
+
+void test_concurrent_trie_readers_during_writes(void)
+{
+  // Keys published before the readers start must stay visible through every
+  // copy-on-write bucket swap and promotion the writer performs.
+  MockConcurrentTrie<8UL> trie;
+
+  for (std::uint64_t i = 0UL; i < 32UL; i++)
+  {
+    trie.insert(make_key(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> misses{0UL};
+  std::vector<std::thread> readers;
+
+  for (unsigned t = 0U; t < 4U; t++)
+  {
+    readers.emplace_back([&]
+    {
+      while (!done.load(std::memory_order_acquire))
+      {
+        for (std::uint64_t i = 0UL; i < 32UL; i++)
+        {
+          if (!trie.contains(make_key(i)))
+          {
+            misses.fetch_add(1UL);
+          }
+        }
+      }
+    });
+  }
+
+  for (std::uint64_t i = 32UL; i < 4096UL; i++)
+  {
+    trie.insert(make_key(i));
+  }
+
+  done.store(true, std::memory_order_release);
+
+  for (auto& th : readers)
+  {
+    th.join();
+  }
+
+  assert(misses.load() == 0UL);
+
+  for (std::uint64_t i = 0UL; i < 4096UL; i++)
+  {
+    assert(trie.contains(make_key(i)) == true);
+  }
+
+  Epoch<>::get_instance().synchronize();
+}
+
+void test_concurrent_trie_many_readers(void)
+{
+  // More reader threads than the epoch domain has slots, all alive at once:
+  // each takes a slot only while it is inside a lookup.
+  constexpr unsigned kReaders = 160U;
+
+  MockConcurrentTrie<> trie;
+  insert_words(trie);
+
+  std::atomic<unsigned> arrived{0U};
+  std::atomic<std::uint64_t> misses{0UL};
+  std::vector<std::thread> readers;
+
+  for (unsigned t = 0U; t < kReaders; t++)
+  {
+    readers.emplace_back([&]
+    {
+      if (!trie.contains("foo"))
+      {
+        misses.fetch_add(1UL);
+      }
+
+      arrived.fetch_add(1U);
+
+      while (arrived.load() < kReaders)
+      {
+        std::this_thread::yield();
+      }
+
+      if (!trie.contains("car"))
+      {
+        misses.fetch_add(1UL);
+      }
+    });
+  }
+
+  for (auto& th : readers)
+  {
+    th.join();
+  }
+
+  assert(misses.load() == 0UL);
+}
+
+int main(void)
+{
+  test_concurrent_trie_insert_and_contains();
+  test_concurrent_trie_prefix();
+  test_concurrent_trie_clear();
+  test_concurrent_trie_promote();
+  test_concurrent_trie_readers_during_writes();
+  test_concurrent_trie_many_readers();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,248 @@
+#include "deflate.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Just enough of an inflater to read back what compress() writes: stored
+  // and fixed-Huffman blocks.
+  class Inflater final
+  {
+    const std::vector<std::uint8_t>& m_in;
+    std::size_t                      m_bit{0UL};
+
+    std::uint32_t m_bits(const unsigned n) noexcept
+    {
+      std::uint32_t v = 0U;
+
+      for (unsigned i = 0U; i < n; i++, m_bit++)
+      {
+        v |= static_cast<std::uint32_t>((m_in[m_bit >> 3] >> (m_bit & 7UL)) & 1U) << i;
+      }
+
+      return v;
+    }
+
+    // Reads a Huffman code MSB first.
+    std::uint32_t m_code(const unsigned n, std::uint32_t prefix, const unsigned have) noexcept
+    {
+      for (unsigned i = have; i < n; i++)
+      {
+        prefix = (prefix << 1) | m_bits(1U);
+      }
+
+      return prefix;
+    }
+
+    unsigned m_symbol(void) noexcept
+    {
+      const std::uint32_t c7 = m_code(7U, 0U, 0U);
+
+      if (c7 <= 0x17U)
+      {
+        return 256U + c7;
+      }
+
+      const std::uint32_t c8 = m_code(8U, c7, 7U);
+
+      if (c8 >= 0x30U && c8 <= 0xBFU)
+      {
+        return c8 - 0x30U;
+      }
+
+      if (c8 >= 0xC0U && c8 <= 0xC7U)
+      {
+        return 280U + (c8 - 0xC0U);
+      }
+
+      return 144U + (m_code(9U, c8, 8U) - 0x190U);
+    }
+
+  public:
+    explicit Inflater(const std::vector<std::uint8_t>& in, const std::size_t offset) noexcept
+      : m_in(in), m_bit(offset * 8UL) {}
+
+    bool run(std::vector<std::uint8_t>& out) noexcept
+    {
+      static constexpr std::uint16_t kLengthBase[]    = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+      static constexpr std::uint8_t  kLengthExtra[]   = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+      static constexpr std::uint16_t kDistanceBase[]  = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+      static constexpr std::uint8_t  kDistanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+      for (bool final = false; !final;)
+      {
+        final = (m_bits(1U) == 1U);
+
+        const std::uint32_t type = m_bits(2U);
+
+        if (type == 0U)
+        {
+          m_bit = (m_bit + 7UL) & ~7UL;
+
+          const std::size_t at  = m_bit >> 3;
+          const std::size_t len = m_in[at] | (static_cast<std::size_t>(m_in[at + 1UL]) << 8);
+
+          if ((len ^ 0xFFFFUL) != (m_in[at + 2UL] | (static_cast<std::size_t>(m_in[at + 3UL]) << 8)))
+          {
+            return false;
+          }
+
+          out.insert(out.end(), m_in.begin() + static_cast<std::ptrdiff_t>(at + 4UL), m_in.begin() + static_cast<std::ptrdiff_t>(at + 4UL + len));
+          m_bit = (at + 4UL + len) * 8UL;
+          continue;
+        }
+
+        if (type != 1U)
+        {
+          return false;
+        }
+
+        for (;;)
+        {
+          const unsigned symbol = m_symbol();
+
+          if (symbol < 256U)
+          {
+            out.push_back(static_cast<std::uint8_t>(symbol));
+            continue;
+          }
+
+          if (symbol == 256U)
+          {
+            break;
+          }
+
+          const unsigned    l        = symbol - 257U;
+          const std::size_t length   = kLengthBase[l] + m_bits(kLengthExtra[l]);
+          const unsigned    d        = m_code(5U, 0U, 0U);
+          const std::size_t distance = kDistanceBase[d] + m_bits(kDistanceExtra[d]);
+
+          if (distance > out.size())
+          {
+            return false;
+          }
+
+          for (std::size_t i = 0UL; i < length; i++)
+          {
+            out.push_back(out[out.size() - distance]);
+          }
+        }
+      }
+
+      return true;
+    }
+
+    std::size_t get_offset(void) const noexcept
+    {
+      return (m_bit + 7UL) >> 3;
+    }
+  };
+
+  std::vector<std::uint8_t> bytes_of(const std::string& s) noexcept
+  {
+    return std::vector<std::uint8_t>(s.begin(), s.end());
+  }
+
+  std::uint32_t load_u32(const std::vector<std::uint8_t>& v, const std::size_t at) noexcept
+  {
+    return v[at] | (static_cast<std::uint32_t>(v[at + 1UL]) << 8) |
+           (static_cast<std::uint32_t>(v[at + 2UL]) << 16) | (static_cast<std::uint32_t>(v[at + 3UL]) << 24);
+  }
+
+  void round_trip(const std::vector<std::uint8_t>& input, const deflate::Level level) noexcept
+  {
+    std::vector<std::uint8_t> packed;
+    std::vector<std::uint8_t> unpacked;
+
+    deflate::gzip(input.data(), input.size(), packed, level);
+
+    assert(packed.size() >= 18UL);
+    assert(packed[0] == 0x1FU && packed[1] == 0x8BU && packed[2] == 0x08U);
+
+    Inflater inflater(packed, 10UL);
+
+    assert(inflater.run(unpacked));
+    assert(unpacked == input);
+    assert(inflater.get_offset() + 8UL == packed.size());
+    assert(load_u32(packed, packed.size() - 8UL) == deflate::crc32(input.data(), input.size()));
+    assert(load_u32(packed, packed.size() - 4UL) == input.size());
+  }
+} // namespace
+
+void test_deflate_crc32(void)
+{
+  const std::vector<std::uint8_t> check = bytes_of("123456789");
+
+  assert(deflate::crc32(check.data(), check.size()) == 0xCBF43926U);
+  assert(deflate::crc32(nullptr, 0UL) == 0U);
+
+  // Continuing a CRC over a split buffer matches one pass.
+  const std::uint32_t head = deflate::crc32(check.data(), 4UL);
+  assert(deflate::crc32(check.data() + 4UL, 5UL, head) == 0xCBF43926U);
+}
+
+void test_deflate_stored(void)
+{
+  round_trip({}, deflate::Level::STORE);
+  round_trip(bytes_of("hello"), deflate::Level::STORE);
+
+  // More than one stored block.
+  std::vector<std::uint8_t> big(150000UL);
+
+  for (std::size_t i = 0UL; i < big.size(); i++)
+  {
+    big[i] = static_cast<std::uint8_t>(i * 7UL);
+  }
+
+  round_trip(big, deflate::Level::STORE);
+}
+
+void test_deflate_fast(void)
+{
+  round_trip({}, deflate::Level::FAST);
+  round_trip(bytes_of("a"), deflate::Level::FAST);
+  round_trip(bytes_of("abcabcabcabcabcabcabcabcabcabcabcabcabcabc"), deflate::Level::FAST);
+
+  // Repetitive text shrinks; every literal, length and distance range is hit.
+  std::string text;
+
+  for (std::uint32_t i = 0U; text.size() < 200000UL; i++)
+  {
+    text += "frame_" + std::to_string(i % 97U) + ";main;" + std::string(i % 300U, 'x') + "\n";
+    text += static_cast<char>(i & 0xFFU);
+  }
+
+  const std::vector<std::uint8_t> input = bytes_of(text);
+  std::vector<std::uint8_t>       packed;
+
+  deflate::gzip(input.data(), input.size(), packed, deflate::Level::FAST);
+  assert(packed.size() * 4UL < input.size());
+
+  round_trip(input, deflate::Level::FAST);
+
+  // Incompressible input still round-trips.
+  std::vector<std::uint8_t> noise(70000UL);
+  std::uint32_t state = 12345U;
+
+  for (std::uint8_t& byte : noise)
+  {
+    state = (state * 1103515245U) + 12345U;
+    byte  = static_cast<std::uint8_t>(state >> 24);
+  }
+
+  round_trip(noise, deflate::Level::FAST);
+}
+
+int main(void)
+{
+  test_deflate_crc32();
+  test_deflate_stored();
+  test_deflate_fast();
+
+  return EXIT_SUCCESS;
+}
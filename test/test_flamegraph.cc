@@ -0,0 +1,189 @@
+#include "flamegraph.hpp"
+#include "stack_table.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::string kPath = "test_flamegraph.tmp";
+
+  std::string read_file(void) noexcept
+  {
+    std::ifstream in(kPath, std::ios::binary);
+    std::stringstream ss;
+
+    ss << in.rdbuf();
+    return ss.str();
+  }
+
+  std::size_t occurrences(const std::string& text, const std::string& needle) noexcept
+  {
+    std::size_t n = 0UL;
+
+    for (std::size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1UL))
+    {
+      ++n;
+    }
+
+    return n;
+  }
+
+  const std::vector<std::string> kNames = {"main", "parse", "eval", "alloc"};
+
+  StackTable sample_table(void) noexcept
+  {
+    StackTable table;
+
+    const std::uint32_t a[] = {0U, 1U, 3U};  // main;parse;alloc
+    const std::uint32_t b[] = {0U, 2U, 3U};  // main;eval;alloc
+    const std::uint32_t c[] = {0U, 2U};      // main;eval
+
+    table.add(a, 3UL, 2UL);
+    table.add(b, 3UL, 5UL);
+    table.add(c, 2UL, 3UL);
+
+    return table;
+  }
+} // namespace
+
+void test_flamegraph_merges_prefixes(void)
+{
+  const StackTable table = sample_table();
+  const FlameGraph graph(table, kNames);
+
+  // all, main, parse, alloc, eval, alloc
+  assert(graph.get_nodes() == 6UL);
+  assert(graph.get_samples() == 10UL);
+
+  assert(graph.write_svg(kPath) == FlameGraph::kOk);
+
+  const std::string svg = read_file();
+
+  assert(svg.find("<svg") != std::string::npos && svg.find("</svg>") != std::string::npos);
+  assert(svg.find("<script") != std::string::npos);
+  assert(svg.find("http://") == svg.find("http://www.w3.org/2000/svg"));  // nothing external
+  assert(occurrences(svg, "<g class=\"f\"") == 6UL);
+  assert(svg.find("<title>all (10 samples, 100.00%)</title>") != std::string::npos);
+  assert(svg.find("<title>main (10 samples, 100.00%)</title>") != std::string::npos);
+  assert(svg.find("<title>eval (8 samples, 80.00%)</title>") != std::string::npos);
+  assert(svg.find("<title>alloc (5 samples, 50.00%)</title>") != std::string::npos);
+
+  // Siblings are alphabetical: eval starts at the left edge, parse after it.
+  assert(svg.find("data-x=\"0\" data-w=\"8\" data-d=\"2\"><title>eval") != std::string::npos);
+  assert(svg.find("data-x=\"8\" data-w=\"2\" data-d=\"2\"><title>parse") != std::string::npos);
+  assert(svg.find("data-x=\"8\" data-w=\"2\" data-d=\"3\"><title>alloc") != std::string::npos);
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_flamegraph_reversed(void)
+{
+  const StackTable table = sample_table();
+  const FlameGraph graph(table, kNames, FlameLayout::REVERSED);
+
+  // all, alloc, eval, main, parse, main, eval, main
+  assert(graph.get_nodes() == 8UL);
+  assert(graph.write_svg(kPath) == FlameGraph::kOk);
+
+  const std::string svg = read_file();
+
+  assert(svg.find("data-x=\"0\" data-w=\"7\" data-d=\"1\"><title>alloc") != std::string::npos);
+  assert(svg.find("data-x=\"7\" data-w=\"3\" data-d=\"1\"><title>eval") != std::string::npos);
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_flamegraph_prunes_narrow_frames(void)
+{
+  StackTable table;
+
+  const std::uint32_t hot[]  = {0U, 1U};
+  const std::uint32_t cold[] = {0U, 2U, 3U};
+
+  table.add(hot, 2UL, 1000000UL);
+  table.add(cold, 3UL, 1UL);
+
+  const FlameGraph graph(table, kNames);
+
+  FlameGraphStyle style;
+  style.min_width = 1.0;
+
+  assert(graph.write_svg(kPath, style) == FlameGraph::kOk);
+
+  // eval is a thousandth of a pixel wide: it and alloc above it are dropped.
+  const std::string svg = read_file();
+
+  assert(occurrences(svg, "<g class=\"f\"") == 3UL);
+  assert(svg.find("<title>eval") == std::string::npos);
+  assert(svg.find("<title>alloc") == std::string::npos);
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_flamegraph_escapes_names(void)
+{
+  StackTable table;
+
+  const std::uint32_t stack[] = {0U, 1U, 7U};
+
+  table.add(stack, 3UL, 1UL);
+
+  const FlameGraph graph(table, {"main", "vector<int>::push_back&"});
+
+  FlameGraphStyle style;
+  style.title = "a < b";
+
+  assert(graph.write_svg(kPath, style) == FlameGraph::kOk);
+
+  const std::string svg = read_file();
+
+  assert(svg.find("vector&lt;int&gt;::push_back&amp; (1 samples") != std::string::npos);
+  assert(svg.find("a &lt; b") != std::string::npos);
+  assert(svg.find("<title>? (1 samples") != std::string::npos);  // unnamed id
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_flamegraph_writer(void)
+{
+  FlameGraphWriter sink(kPath, FlameLayout::ICICLE);
+
+  const std::uint32_t stack[] = {0U, 1U};
+
+  sink.define(0U, "main");
+  sink.define(1U, "work");
+  sink.sample(1UL, 2UL, stack, 2UL);
+  sink.sample(2UL, 1UL, stack, 2UL);
+  sink.flush();
+
+  assert(!sink.is_failed());
+  assert(sink.get_stacks() == 1UL);
+  assert(sink.get_samples() == 3UL);
+  assert(read_file().find("<title>work (3 samples, 100.00%)</title>") != std::string::npos);
+
+  (void)std::remove(kPath.c_str());
+
+  FlameGraphWriter unwritable("no/such/directory/file");
+
+  unwritable.flush();
+  assert(unwritable.is_failed());
+}
+
+int main(void)
+{
+  test_flamegraph_merges_prefixes();
+  test_flamegraph_reversed();
+  test_flamegraph_prunes_narrow_frames();
+  test_flamegraph_escapes_names();
+  test_flamegraph_writer();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+#include "folded.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::string kPath = "test_folded.tmp";
+
+  std::string read_file(void) noexcept
+  {
+    std::ifstream in(kPath, std::ios::binary);
+    std::stringstream ss;
+
+    ss << in.rdbuf();
+    return ss.str();
+  }
+
+  std::vector<std::string> read_lines(void) noexcept
+  {
+    std::vector<std::string> lines;
+    std::istringstream in(read_file());
+
+    for (std::string line; std::getline(in, line);)
+    {
+      lines.push_back(line);
+    }
+
+    std::sort(lines.begin(), lines.end());
+    return lines;
+  }
+} // namespace
+
+void test_writer_spans_buffer(void)
+{
+  {
+    Writer out(kPath, 8UL);
+
+    assert(out.is_open());
+
+    out.write("abc");
+    out.write("defghi");           // crosses the buffer end
+    out.write("0123456789ABCDEF"); // larger than the whole buffer
+    out.put('!');
+
+    assert(out.close() == Writer::kOk);
+    assert(out.get_bytes() == 26UL);
+  }
+
+  assert(read_file() == "abcdefghi0123456789ABCDEF!");
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_writer_u64(void)
+{
+  {
+    Writer out(kPath);
+
+    out.write_u64(0UL);
+    out.put(' ');
+    out.write_u64(42UL);
+    out.put(' ');
+    out.write_u64(UINT64_MAX);
+
+    assert(out.close() == Writer::kOk);
+  }
+
+  assert(read_file() == "0 42 18446744073709551615");
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_writer_unopened(void)
+{
+  Writer out("no/such/directory/file");
+
+  assert(!out.is_open());
+
+  out.write("lost");
+  assert(out.close() == Writer::kIoError);
+}
+
+void test_folded_aggregates(void)
+{
+  FoldedWriter sink(kPath);
+
+  const std::uint32_t a[] = {0U, 1U, 2U};
+  const std::uint32_t b[] = {0U, 1U};
+
+  sink.define(0U, "main");
+  sink.define(1U, "mid");
+  sink.define(2U, "leaf");
+
+  sink.sample(1UL, 3UL, a, 3UL);
+  sink.sample(2UL, 1UL, b, 2UL);
+  sink.sample(3UL, 2UL, a, 3UL);
+  sink.flush();
+
+  assert(!sink.is_failed());
+  assert(sink.get_stacks() == 2UL);
+  assert(sink.get_samples() == 6UL);
+  assert((read_lines() == std::vector<std::string>{"main;mid 1", "main;mid;leaf 5"}));
+  assert(sink.get_bytes() == read_file().size());
+
+  // A later flush() rewrites the file with the longer profile.
+  sink.sample(4UL, 1UL, b, 2UL);
+  sink.flush();
+
+  assert((read_lines() == std::vector<std::string>{"main;mid 2", "main;mid;leaf 5"}));
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_folded_sanitizes_names(void)
+{
+  FoldedWriter sink(kPath);
+
+  const std::uint32_t a[] = {0U, 1U, 5U};
+
+  sink.define(0U, "main");
+  sink.define(1U, "a;b");
+  sink.sample(1UL, 1UL, a, 3UL);
+  sink.flush();
+
+  // ';' inside a name would split the frame; an undefined id is "?".
+  assert((read_lines() == std::vector<std::string>{"main;a:b;? 1"}));
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_folded_unwritable(void)
+{
+  FoldedWriter sink("no/such/directory/file");
+
+  const std::uint32_t a[] = {0U};
+
+  sink.define(0U, "main");
+  sink.sample(1UL, 1UL, a, 1UL);
+  sink.flush();
+
+  assert(sink.is_failed());
+}
+
+int main(void)
+{
+  test_writer_spans_buffer();
+  test_writer_u64();
+  test_writer_unopened();
+  test_folded_aggregates();
+  test_folded_sanitizes_names();
+  test_folded_unwritable();
+
+  return EXIT_SUCCESS;
+}
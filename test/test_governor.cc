@@ -0,0 +1,116 @@
+#include "governor.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+  // Closes n samples of the given cost; returns how many changed the rate.
+  int run(Governor& governor, const std::uint64_t cost_ns, const int n) noexcept
+  {
+    int changes = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+      governor.charge(cost_ns);
+      changes += governor.update() ? 1 : 0;
+    }
+
+    return changes;
+  }
+} // namespace
+
+void test_governor_disabled(void)
+{
+  Governor governor(0.0, 1000.0);
+
+  assert(!governor.is_enabled());
+  assert(run(governor, 1'000'000UL, 256) == 0);
+  assert(governor.get_rate() == 1000.0);
+  assert(governor.get_adjustments() == 0UL);
+
+  // Cost is still tracked for the report.
+  assert(governor.get_total_cost_ns() == 256UL * 1'000'000UL);
+  assert(governor.get_avg_cost_ns() == 1'000'000.0);
+}
+
+void test_governor_moving_average(void)
+{
+  Governor governor(0.01, 1000.0);
+
+  // The first sample seeds the average; later ones move it by 1/64 of
+  // their difference.
+  governor.charge(600UL);
+  governor.charge(400UL);
+  assert(governor.get_total_cost_ns() == 1000UL);
+  (void)governor.update();
+  assert(governor.get_avg_cost_ns() == 1000.0);
+
+  governor.charge(1064UL);
+  (void)governor.update();
+  assert(governor.get_avg_cost_ns() == 1001.0);
+  assert(governor.get_total_cost_ns() == 2064UL);
+}
+
+void test_governor_control_interval(void)
+{
+  // 100 us per sample against a 1% budget allows 100 Hz.
+  Governor governor(0.01, 1000.0);
+
+  assert(run(governor, 100'000UL, 63) == 0);
+  assert(governor.get_rate() == 1000.0);
+
+  assert(run(governor, 100'000UL, 1) == 1);
+  assert(governor.get_rate() == 100.0);
+  assert(governor.get_adjustments() == 1UL);
+
+  // A steady cost keeps the rate.
+  assert(run(governor, 100'000UL, 640) == 0);
+  assert(governor.get_rate() == 100.0);
+}
+
+void test_governor_hysteresis(void)
+{
+  Governor governor(0.01, 1000.0);
+
+  assert(run(governor, 100'000UL, 64) == 1);
+
+  // 110 us moves the target to about 91 Hz, within 25% of the rate.
+  assert(run(governor, 110'000UL, 64 * 64) == 0);
+  assert(governor.get_rate() == 100.0);
+
+  // 200 us moves it in steps of at least 25% towards 50 Hz.
+  assert(run(governor, 200'000UL, 64 * 64) >= 1);
+  assert(governor.get_rate() >= 50.0 && governor.get_rate() <= 75.0);
+}
+
+void test_governor_clamped(void)
+{
+  // Never below 1 Hz however expensive a sample is...
+  Governor slow(0.01, 1000.0);
+
+  assert(run(slow, 1'000'000'000UL, 64) == 1);
+  assert(slow.get_rate() == 1.0);
+
+  // ...and never above the requested rate, so cheap samples change nothing.
+  Governor fast(0.01, 1000.0);
+
+  assert(run(fast, 1'000UL, 64 * 16) == 0);
+  assert(fast.get_rate() == 1000.0);
+
+  // Once the cost falls again the rate climbs back towards the maximum.
+  assert(run(slow, 1'000UL, 64 * 16) >= 1);
+  assert(slow.get_rate() > 750.0 && slow.get_rate() <= 1000.0);
+}
+
+int main(void)
+{
+  test_governor_disabled();
+  test_governor_moving_average();
+  test_governor_control_interval();
+  test_governor_hysteresis();
+  test_governor_clamped();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include "histogram.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+void test_histogram_empty(void)
+{
+  Histogram histogram;
+
+  assert(histogram.get_count()      == 0UL);
+  assert(histogram.get_min()        == 0UL);
+  assert(histogram.get_max()        == 0UL);
+  assert(histogram.percentile(50.0) == 0UL);
+}
+
+void test_histogram_small_values_are_exact(void)
+{
+  Histogram histogram;
+
+  for (std::uint64_t i = 1UL; i <= 10UL; i++)
+  {
+    histogram.record(i);
+  }
+
+  assert(histogram.get_count()       == 10UL);
+  assert(histogram.get_sum()         == 55UL);
+  assert(histogram.get_min()         == 1UL);
+  assert(histogram.get_max()         == 10UL);
+  assert(histogram.percentile(50.0)  == 5UL);
+  assert(histogram.percentile(100.0) == 10UL);
+  assert(histogram.percentile(0.0)   == 1UL);
+}
+
+void test_histogram_relative_error(void)
+{
+  Histogram histogram;
+
+  // 1..100000 uniformly: every percentile must land within 1/16 of the truth.
+  for (std::uint64_t i = 1UL; i <= 100000UL; i++)
+  {
+    histogram.record(i);
+  }
+
+  const double qs[] = {50.0, 90.0, 99.0, 99.9};
+
+  for (const double q : qs)
+  {
+    const double truth = q * 1000.0;
+    const double value = static_cast<double>(histogram.percentile(q));
+
+    assert(value >= truth);
+    assert(value <= truth * (1.0 + 1.0 / 16.0));
+  }
+
+  assert(histogram.percentile(100.0) == 100000UL);
+}
+
+void test_histogram_extremes(void)
+{
+  Histogram histogram;
+
+  histogram.record(0UL);
+  histogram.record(std::numeric_limits<std::uint64_t>::max());
+
+  assert(histogram.get_min()         == 0UL);
+  assert(histogram.get_max()         == std::numeric_limits<std::uint64_t>::max());
+  assert(histogram.percentile(50.0)  == 0UL);
+  assert(histogram.percentile(100.0) == std::numeric_limits<std::uint64_t>::max());
+}
+
+void test_histogram_merge(void)
+{
+  Histogram a;
+  Histogram b;
+
+  for (std::uint64_t i = 0UL; i < 99UL; i++)
+  {
+    a.record(100UL);
+  }
+
+  b.record(1000000UL);
+
+  a.merge(b);
+
+  assert(a.get_count()       == 100UL);
+  assert(a.get_max()         == 1000000UL);
+  assert(a.percentile(50.0)  <= 103UL);
+  assert(a.percentile(100.0) == 1000000UL);
+
+  a.reset();
+
+  assert(a.get_count() == 0UL);
+}
+
+int main(void)
+{
+  test_histogram_empty();
+  test_histogram_small_values_are_exact();
+  test_histogram_relative_error();
+  test_histogram_extremes();
+  test_histogram_merge();
+
+  return EXIT_SUCCESS;
+}
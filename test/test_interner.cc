@@ -0,0 +1,77 @@
+#include "interner.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+void test_interner_ids_are_dense_and_stable(void)
+{
+  Interner interner;
+
+  assert(interner.intern("main") == 0U);
+  assert(interner.intern("leaf") == 1U);
+  assert(interner.intern("main") == 0U);
+
+  assert(interner.size()   == 2U);
+  assert(interner.name(0U) == "main");
+  assert(interner.name(1U) == "leaf");
+  assert(interner.name(2U).empty());
+}
+
+void test_interner_oversized_name(void)
+{
+  Interner interner;
+
+  const std::string big(200000UL, 'x');
+
+  const std::uint32_t id = interner.intern(big);
+
+  assert(interner.name(id) == big);
+  assert(interner.intern(big) == id);
+}
+
+void test_interner_concurrent_readers(void)
+{
+  Interner interner;
+
+  std::atomic<std::uint32_t> published{0U};
+  std::atomic<bool>          done{false};
+
+  // Readers only look up ids the writer has handed over; names must never
+  // move underneath them while the tables grow.
+  std::thread reader([&]
+  {
+    while (!done.load(std::memory_order_acquire))
+    {
+      const std::uint32_t n = published.load(std::memory_order_acquire);
+
+      for (std::uint32_t id = 0U; id < n; id += 97U)
+      {
+        assert(interner.name(id) == ("f" + std::to_string(id)));
+      }
+    }
+  });
+
+  for (std::uint32_t i = 0U; i < 20000U; i++)
+  {
+    assert(interner.intern("f" + std::to_string(i)) == i);
+    published.store(i + 1U, std::memory_order_release);
+  }
+
+  done.store(true, std::memory_order_release);
+  reader.join();
+
+  assert(interner.size() == 20000U);
+}
+
+int main(void)
+{
+  test_interner_ids_are_dense_and_stable();
+  test_interner_oversized_name();
+  test_interner_concurrent_readers();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "line_histogram.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+  const std::string kPath   = "test_line_histogram.tmp";
+  const std::string kSource = "test_line_histogram_src.tmp";
+
+  std::string read_file(const std::string& path) noexcept
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  }
+} // namespace
+
+void test_line_histogram_listing(void)
+{
+  {
+    std::ofstream source(kSource, std::ios::binary);
+    source << "int main() {\n  for (;;) x += y;  \n\treturn x;\n";
+  }
+
+  LineHistogram histogram;
+
+  histogram.add(0x10U, 5UL);
+  histogram.add(0x11U);
+  histogram.add(0x12U, 2UL);
+  histogram.add(0x13U);
+  histogram.add(0x20U);
+  histogram.add(0x30U);
+
+  assert(histogram.get_pcs() == 6UL && histogram.get_samples() == 11UL);
+
+  std::size_t calls = 0UL;
+
+  auto resolve = [&calls](const std::uintptr_t pc, SourceLine& out) noexcept
+  {
+    ++calls;
+
+    if (pc == 0x30U)
+    {
+      return false;
+    }
+
+    out.function = (pc == 0x20U) ? "main" : "work";
+    out.file     = kSource;
+    out.line     = (pc == 0x20U) ? 1U : (pc == 0x12U) ? 3U : (pc == 0x13U) ? 0U : 2U;
+
+    return true;
+  };
+
+  histogram.resolve(resolve);
+  assert(calls == 6UL);
+
+  // Only new PCs are looked up again.
+  histogram.add(0x10U);
+  histogram.resolve(resolve);
+  assert(calls == 6UL && histogram.get_samples() == 12UL);
+
+  assert(histogram.write(kPath, 2UL) == LineHistogram::kOk);
+
+  const std::string expected =
+    "Line profile: 12 samples at 6 distinct PCs\n"
+    "\n"
+    "work 10 samples (83.3%)  " + kSource + "\n"
+    "        line    samples       %\n"
+    "           2          7   58.3%  for (;;) x += y;\n"
+    "           3          2   16.7%  return x;\n"
+    "         ... 1 more lines, 1 samples\n"
+    "\n"
+    "<unknown> 1 samples (8.3%)\n"
+    "        line    samples       %\n"
+    "           ?          1    8.3%\n"
+    "\n"
+    "main 1 samples (8.3%)  " + kSource + "\n"
+    "        line    samples       %\n"
+    "           1          1    8.3%  int main() {\n";
+
+  assert(read_file(kPath) == expected);
+
+  (void)std::remove(kPath.c_str());
+  (void)std::remove(kSource.c_str());
+
+  assert(histogram.write("no/such/directory/file") == LineHistogram::kIoError);
+}
+
+int main(void)
+{
+  test_line_histogram_listing();
+
+  return EXIT_SUCCESS;
+}
@@ -81,6 +81,28 @@ void test_map_get(void)
   assert(map.get(out, "ran") == (-1) && out == "");
 }
 
+void test_map_set_unique(void)
+{
+  using MockMapDef = MockMap<std::string, std::string, 4UL>;
+  MockMapDef map;
+
+  assert(map.set_unique("foo", "bar")                          == 0);
+  assert(map.set_unique("fragile", "tar")                      == 0);
+  assert(map.set_unique("Hello, World!", "How are you today?") == 0);
+  assert(map.set_unique("Hello, Again!", "I-am-well-and-you?") == 0);
+
+  assert(map.set_unique("toy", "car") == (-1));
+
+  std::string out = "";
+
+  assert(map.get(out, "foo")           == 0 && out == "bar");
+  assert(map.get(out, "Hello, Again!") == 0 && out == "I-am-well-and-you?");
+
+  out = "";
+
+  assert(map.get(out, "toy") == (-1) && out == "");
+}
+
 void test_map_del(void)
 {
   using MockMapDef = MockMap<std::string, std::string, 4UL>;
@@ -110,6 +132,7 @@ int main(void)
   test_map_init();
   test_map_set();
   test_map_get();
+  test_map_set_unique();
   test_map_del();
 
   return 0;
@@ -0,0 +1,93 @@
+#include "pacer.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+  double seconds_since(const std::chrono::steady_clock::time_point t0) noexcept
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  }
+} // namespace
+
+void test_pacer_rate(void)
+{
+  Pacer pacer(1000.0);
+  assert(pacer.get_rate() == 1000.0);
+
+  pacer.set_rate(250.0);
+  assert(pacer.get_rate() == 250.0);
+
+  // Non-positive rates fall back to 1 Hz; the period never reaches zero.
+  pacer.set_rate(0.0);
+  assert(pacer.get_rate() == 1.0);
+
+  pacer.set_rate(1e12);
+  assert(pacer.get_rate() == 1e9);
+}
+
+void test_pacer_deadlines(void)
+{
+  Pacer pacer(200.0);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  pacer.start();
+
+  for (int i = 0; i < 20; i++)
+  {
+    pacer.wait();
+  }
+
+  // Tick k returns no earlier than start + k * 5 ms.
+  const double elapsed = seconds_since(t0);
+
+  assert(elapsed >= 0.0999);
+  assert(elapsed < 0.5);
+  assert(pacer.get_ticks() == 20UL);
+}
+
+void test_pacer_missed_ticks(void)
+{
+  Pacer pacer(100.0);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  pacer.start();
+
+  // Overrun five and a half periods: the wait returns at once for the
+  // latest passed tick and counts the four before it as missed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(55));
+
+  const auto before = std::chrono::steady_clock::now();
+  pacer.wait();
+
+  assert(seconds_since(before) < 0.005);
+  assert(pacer.get_ticks() == 1UL);
+  assert(pacer.get_missed() >= 4UL);
+
+  // The schedule stays on the grid: the next tick is at 60 ms, not 10 ms
+  // after the overrun.
+  const std::uint64_t missed = pacer.get_missed();
+
+  pacer.wait();
+
+  assert(pacer.get_ticks() == 2UL);
+  assert(seconds_since(t0) >= 0.0599);
+  assert(pacer.get_missed() == missed || seconds_since(t0) >= 0.07);
+
+  // start() resets the counts.
+  pacer.start();
+  assert(pacer.get_ticks() == 0UL && pacer.get_missed() == 0UL);
+}
+
+int main(void)
+{
+  test_pacer_rate();
+  test_pacer_deadlines();
+  test_pacer_missed_ticks();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+#include "deflate.hpp"
+#include "pprof.hpp"
+#include "protobuf.hpp"
+#include "stack_table.hpp"
+#include "varint.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::string kPath = "test_pprof.tmp";
+
+  struct Field final
+  {
+    std::uint32_t             number;
+    std::uint64_t             value;  // varint fields
+    std::vector<std::uint8_t> bytes;  // length-delimited fields
+  };
+
+  std::vector<Field> parse(const std::vector<std::uint8_t>& message) noexcept
+  {
+    std::vector<Field>  fields;
+    const std::uint8_t* p   = message.data();
+    const std::uint8_t* end = p + message.size();
+
+    while (p < end)
+    {
+      std::uint64_t tag = 0UL;
+      Field         field{};
+
+      p = varint::decode(p, end, tag);
+      assert(p != nullptr);
+
+      field.number = static_cast<std::uint32_t>(tag >> 3);
+
+      if ((tag & 7UL) == 0UL)
+      {
+        p = varint::decode(p, end, field.value);
+        assert(p != nullptr);
+      }
+      else
+      {
+        std::uint64_t size = 0UL;
+
+        assert((tag & 7UL) == 2UL);
+        p = varint::decode(p, end, size);
+        assert(p != nullptr && size <= static_cast<std::uint64_t>(end - p));
+
+        field.bytes.assign(p, p + size);
+        p += size;
+      }
+
+      fields.push_back(field);
+    }
+
+    return fields;
+  }
+
+  std::vector<std::uint64_t> unpack(const std::vector<std::uint8_t>& bytes) noexcept
+  {
+    std::vector<std::uint64_t> values;
+    const std::uint8_t*        p   = bytes.data();
+    const std::uint8_t*        end = p + bytes.size();
+
+    while (p < end)
+    {
+      std::uint64_t v = 0UL;
+
+      p = varint::decode(p, end, v);
+      assert(p != nullptr);
+      values.push_back(v);
+    }
+
+    return values;
+  }
+
+  std::vector<Field> with_number(const std::vector<Field>& fields, const std::uint32_t number) noexcept
+  {
+    std::vector<Field> out;
+
+    for (const Field& field : fields)
+    {
+      if (field.number == number)
+      {
+        out.push_back(field);
+      }
+    }
+
+    return out;
+  }
+
+  std::string text(const Field& field) noexcept
+  {
+    return std::string(field.bytes.begin(), field.bytes.end());
+  }
+
+  std::vector<std::uint8_t> read_file(void) noexcept
+  {
+    std::ifstream in(kPath, std::ios::binary);
+
+    return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  }
+} // namespace
+
+void test_protobuf_encoder(void)
+{
+  protobuf::Encoder nested;
+  protobuf::Encoder outer;
+
+  const std::uint32_t values[] = {1U, 300U};
+
+  nested.varint(1U, 150UL);
+  outer.message(3U, nested);
+  outer.varint(2U, 0UL);  // default: omitted
+  outer.bytes(4U, "");
+  outer.packed(5U, values, 2UL);
+
+  // The canonical examples from the encoding guide.
+  const std::vector<std::uint8_t> expected = {0x1AU, 0x03U, 0x08U, 0x96U, 0x01U, 0x22U, 0x00U, 0x2AU, 0x03U, 0x01U, 0xACU, 0x02U};
+
+  assert(outer.data() == expected);
+}
+
+void test_pprof_profile(void)
+{
+  StackTable table;
+
+  const std::uint32_t a[] = {0U, 1U, 3U};  // main;parse;alloc
+  const std::uint32_t b[] = {0U, 1U};      // main;parse
+
+  table.add(a, 3UL, 4UL);
+  table.add(b, 2UL, 1UL);
+
+  PprofInfo info;
+  info.time_ns     = 1700000000000000000UL;
+  info.duration_ns = 5000000UL;
+  info.period_ns   = 1000000UL;
+  info.compress    = false;
+
+  std::vector<std::uint8_t> bytes;
+  pprof::encode(table, {"main", "parse", "unused", "alloc"}, info, bytes);
+
+  const std::vector<Field> profile = parse(bytes);
+
+  // String table: "" first, then the type strings, then the names in use.
+  const std::vector<Field> strings = with_number(profile, 6U);
+
+  assert(strings.size() == 8UL);
+  assert(text(strings[0]).empty());
+  assert(text(strings[1]) == "samples" && text(strings[2]) == "count");
+  assert(text(strings[5]) == "main" && text(strings[6]) == "parse" && text(strings[7]) == "alloc");
+
+  // [samples/count, wall/nanoseconds]
+  const std::vector<Field> types = with_number(profile, 1U);
+
+  assert(types.size() == 2UL);
+  assert(parse(types[1].bytes)[0].value == 3UL);
+
+  // One sample per distinct stack, leaf first, values scaled by the period.
+  const std::vector<Field> samples = with_number(profile, 2UL);
+
+  assert(samples.size() == 2UL);
+
+  bool seen_deep = false;
+
+  for (const Field& sample : samples)
+  {
+    const std::vector<Field>         fields    = parse(sample.bytes);
+    const std::vector<std::uint64_t> locations = unpack(fields[0].bytes);
+    const std::vector<std::uint64_t> values    = unpack(fields[1].bytes);
+
+    if (locations.size() == 3UL)
+    {
+      assert((locations == std::vector<std::uint64_t>{4UL, 2UL, 1UL}));
+      assert((values == std::vector<std::uint64_t>{4UL, 4000000UL}));
+      seen_deep = true;
+    }
+    else
+    {
+      assert((locations == std::vector<std::uint64_t>{2UL, 1UL}));
+      assert((values == std::vector<std::uint64_t>{1UL, 1000000UL}));
+    }
+  }
+
+  assert(seen_deep);
+
+  // Locations and functions only for ids in use; alloc's name is string 7.
+  const std::vector<Field> locations = with_number(profile, 4U);
+  const std::vector<Field> functions = with_number(profile, 5U);
+
+  assert(locations.size() == 3UL && functions.size() == 3UL);
+  assert(parse(locations[2].bytes)[0].value == 4UL);
+  assert(parse(functions[2].bytes)[0].value == 4UL);
+  assert(parse(functions[2].bytes)[1].value == 7UL);
+
+  assert(with_number(profile, 9U)[0].value  == info.time_ns);
+  assert(with_number(profile, 10U)[0].value == info.duration_ns);
+  assert(with_number(profile, 12U)[0].value == info.period_ns);
+}
+
+void test_pprof_gzip_file(void)
+{
+  StackTable table;
+
+  const std::uint32_t stack[] = {0U};
+
+  table.add(stack, 1UL, 1UL);
+
+  PprofInfo info;
+
+  assert(pprof::write(kPath, table, {"main"}, info) == pprof::kOk);
+
+  std::ifstream             in(kPath, std::ios::binary);
+  std::vector<std::uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  info.compress = false;
+
+  std::vector<std::uint8_t> bare;
+  pprof::encode(table, {"main"}, info, bare);
+
+  assert(file.size() > 18UL && file[0] == 0x1FU && file[1] == 0x8BU);
+
+  // The gzip trailer carries the CRC and size of the bare message.
+  const std::size_t   n   = file.size();
+  const std::uint32_t crc = file[n - 8UL] | (static_cast<std::uint32_t>(file[n - 7UL]) << 8) |
+                            (static_cast<std::uint32_t>(file[n - 6UL]) << 16) | (static_cast<std::uint32_t>(file[n - 5UL]) << 24);
+
+  assert(crc == deflate::crc32(bare.data(), bare.size()));
+  assert(file[n - 4UL] == bare.size());
+
+  (void)std::remove(kPath.c_str());
+
+  assert(pprof::write("no/such/directory/file", table, {"main"}, info) == pprof::kIoError);
+}
+
+void test_pprof_writer(void)
+{
+  PprofWriter sink(kPath, 25000000UL, false);
+
+  const std::uint32_t stack[] = {0U, 1U};
+
+  sink.define(0U, "main");
+  sink.define(1U, "work");
+  sink.sample(1000UL, 2UL, stack, 2UL);
+  sink.sample(21000UL, 1UL, stack, 2UL);
+  sink.flush();
+
+  assert(!sink.is_failed());
+  assert(sink.get_stacks() == 1UL && sink.get_samples() == 3UL);
+
+  // Before finish() each sample stands for the nominal period.
+  std::vector<Field> profile = parse(read_file());
+
+  assert(with_number(profile, 12U)[0].value == 25000000UL);
+  assert(with_number(profile, 10U)[0].value == 75000000UL);
+
+  // 60 us over 4 ticks, one of which found nothing to sample.
+  sink.finish(60000UL, 4UL);
+  sink.flush();
+
+  profile = parse(read_file());
+
+  assert(with_number(profile, 12U)[0].value == 15000UL);
+  assert(with_number(profile, 10U)[0].value == 60000UL);
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_pprof_writer_threads(void)
+{
+  PprofWriter sink(kPath, 0UL, false);
+
+  const std::uint32_t stack[] = {0U};
+
+  sink.define(0U, "idle");
+
+  // Four idle threads sampled round-robin at 1 kHz for a second: one run of
+  // 250 samples each, opened on the first four ticks and flushed by
+  // finalize() in thread order, which here is the reverse of time order.
+  for (std::uint64_t thread = 4UL; thread-- > 0UL;)
+  {
+    sink.sample(thread * 1000000UL, 250UL, stack, 1UL);
+  }
+
+  sink.finish(1000000000UL, 1000UL);
+  sink.flush();
+
+  assert(!sink.is_failed());
+  assert(sink.get_samples() == 1000UL);
+
+  const std::vector<Field> profile = parse(read_file());
+
+  assert(with_number(profile, 12U)[0].value == 1000000UL);
+  assert(with_number(profile, 10U)[0].value == 1000000000UL);
+
+  const std::vector<Field> samples = with_number(profile, 2U);
+
+  assert(samples.size() == 1UL);
+  assert((unpack(parse(samples[0].bytes)[1].bytes) == std::vector<std::uint64_t>{1000UL, 1000000000UL}));
+
+  (void)std::remove(kPath.c_str());
+}
+
+int main(void)
+{
+  test_protobuf_encoder();
+  test_pprof_profile();
+  test_pprof_gzip_file();
+  test_pprof_writer();
+  test_pprof_writer_threads();
+
+  return EXIT_SUCCESS;
+}
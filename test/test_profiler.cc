@@ -0,0 +1,178 @@
+#include "clock.hpp"
+#include "event.hpp"
+#include "frame.hpp"
+#include "isink.hpp"
+#include "profiler.hpp"
+#include "snapshot.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  class RecordingSink final : public ISink
+  {
+  public:
+    std::vector<std::string> names;
+    std::uint64_t            samples{0UL};
+    std::uint64_t            duration_ns{0UL};
+    std::uint64_t            ticks{0UL};
+    bool                     finished{false};
+
+    void define(const std::uint32_t id, std::string_view name) noexcept override
+    {
+      assert(id == names.size());
+      names.emplace_back(name);
+    }
+
+    void sample(const std::uint64_t,
+                const std::uint64_t  count,
+                const std::uint32_t* stack,
+                const std::size_t    depth) noexcept override
+    {
+      for (std::size_t i = 0UL; i < depth; i++)
+      {
+        assert(stack[i] < names.size());
+      }
+
+      samples += count;
+    }
+
+    void flush(void) noexcept override {}
+
+    void finish(const std::uint64_t duration_ns_, const std::uint64_t ticks_) noexcept override
+    {
+      assert(!finished);
+      duration_ns = duration_ns_;
+      ticks       = ticks_;
+      finished    = true;
+    }
+  };
+
+  Frame run(const std::uint16_t thread, Snapshot snapshot) noexcept
+  {
+    Frame frame(Clock::get_instance().elapsed(), 0UL, std::move(snapshot));
+    frame.thread = thread;
+    frame.rooted = (thread > 0U);
+    return frame;
+  }
+} // namespace
+
+void test_profiler_threads(void)
+{
+  Clock& clock = Clock::get_instance();
+  clock.start();
+
+  Profiler      profiler;
+  RecordingSink sink;
+  profiler.add_sink(&sink);
+
+  // Runs of three threads interleave, as set_all_threads() delivers them.
+  profiler.profile(run(0U, {"main", "work"}));
+  profiler.profile(run(1U, {"[pool]", "loop"}));
+  profiler.profile(run(0U, {"main", "idle"}));
+  profiler.profile(run(1U, {"[pool]", "loop", "wait"}));
+  profiler.profile(run(2U, {"[io]", "read"}));
+  profiler.profile(run(0U, {"main", "idle", "work"}));
+
+  clock.stop();
+  profiler.finalize(6UL);
+
+  // Replay each thread's events on a stack of its own: every END closes
+  // the innermost frame its thread has open, and nothing stays open.
+  std::vector<std::vector<std::uint32_t>> open(3UL);
+  std::vector<std::size_t>                starts(3UL, 0UL);
+  Event                                   event;
+
+  while (profiler.next_event(event))
+  {
+    assert(event.thread < open.size());
+
+    std::vector<std::uint32_t>& stack = open[event.thread];
+
+    if (event.type == EventType::START)
+    {
+      stack.push_back(event.name);
+      ++starts[event.thread];
+      continue;
+    }
+
+    assert(!stack.empty() && stack.back() == event.name);
+    stack.pop_back();
+  }
+
+  for (const auto& stack : open)
+  {
+    assert(stack.empty());
+  }
+
+  // main, work, idle, work | [pool], loop, wait | [io], read
+  assert(starts[0] == 4UL && starts[1] == 3UL && starts[2] == 2UL);
+
+  assert(sink.names.size() == 8UL);
+  assert(sink.samples == 6UL);
+  assert(sink.finished && sink.ticks == 6UL);
+  assert(sink.duration_ns == clock.to_ns(clock.get_stop() - clock.get_start()));
+}
+
+void test_profiler_off_cpu(void)
+{
+  Clock& clock = Clock::get_instance();
+  clock.start();
+
+  Profiler profiler;
+
+  // kOffCpuStacks + 1 blocked stacks, each deeper in the wait than the
+  // last, between on-CPU runs that add nothing to the table.
+  for (std::size_t i = 0UL; i <= Profiler::kOffCpuStacks; i++)
+  {
+    Frame blocked = run(0U, {"main", "wait" + std::to_string(i)});
+    blocked.count         = 2UL;
+    blocked.off_cpu       = true;
+    blocked.off_cpu_ticks = 1000UL * (i + 1UL);
+
+    profiler.profile(std::move(blocked));
+    profiler.profile(run(0U, {"main", "work"}));
+  }
+
+  clock.stop();
+  profiler.finalize(0UL);
+
+  std::ostringstream out;
+  std::streambuf*    saved = std::cout.rdbuf(out.rdbuf());
+
+  profiler.dump();
+
+  std::cout.rdbuf(saved);
+
+  const std::string text = out.str();
+  const std::size_t off  = text.find("Off-CPU: ");
+
+  assert(off != std::string::npos);
+  assert(text.find(" blocked in 22 samples, 11 stacks", off) != std::string::npos);
+
+  // Longest wait first; the eleventh stack is only counted.
+  const std::size_t first = text.find("main;wait10\n", off);
+  const std::size_t next  = text.find("main;wait9\n", off);
+
+  assert(first != std::string::npos && next != std::string::npos && first < next);
+  assert(text.find("main;wait0\n", off) == std::string::npos);
+  assert(text.find("... 1 more stacks", off) != std::string::npos);
+  assert(text.find("main;work", off) == std::string::npos);
+}
+
+int main(void)
+{
+  test_profiler_threads();
+  test_profiler_off_cpu();
+
+  return EXIT_SUCCESS;
+}
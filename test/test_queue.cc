@@ -13,6 +13,8 @@ namespace
   public:
     MockQueue() noexcept : Queue<T, N>() {}
 
+    explicit MockQueue(const OverflowPolicy policy) noexcept : Queue<T, N>(policy) {}
+
     const std::array<T, N>& get_data(void) const noexcept
     {
       return this->m_data;
@@ -129,6 +131,68 @@ void test_queue_pop(void)
   assert(queue.pop(element) == (-2));
 }
 
+void test_queue_drop_newest(void)
+{
+  MockQueue<std::uint32_t, 4UL> queue(OverflowPolicy::DROP_NEWEST);
+
+  for (std::uint32_t i = 1U; i <= 6U; i++)
+  {
+    assert(queue.push(i) == 0);
+  }
+
+  assert(queue.emplace(7U) == 0);
+
+  std::uint64_t dropped = 0UL;
+
+  assert(queue.dropped(dropped) == 0 && dropped == 3UL);
+  assert(queue.get_size() == 4UL);
+
+  std::uint32_t element = 0U;
+
+  assert(queue.pop(element) == 0 && element == 1U);
+  assert(queue.pop(element) == 0 && element == 2U);
+  assert(queue.pop(element) == 0 && element == 3U);
+  assert(queue.pop(element) == 0 && element == 4U);
+}
+
+void test_queue_drop_oldest(void)
+{
+  MockQueue<std::uint32_t, 4UL> queue(OverflowPolicy::DROP_OLDEST);
+
+  for (std::uint32_t i = 1U; i <= 6U; i++)
+  {
+    assert(queue.push(i) == 0);
+  }
+
+  std::uint64_t dropped = 0UL;
+
+  assert(queue.dropped(dropped) == 0 && dropped == 2UL);
+  assert(queue.get_size() == 4UL);
+
+  std::uint32_t element = 0U;
+
+  assert(queue.pop(element) == 0 && element == 3U);
+  assert(queue.pop(element) == 0 && element == 4U);
+  assert(queue.pop(element) == 0 && element == 5U);
+  assert(queue.pop(element) == 0 && element == 6U);
+}
+
+void test_queue_reject_does_not_count(void)
+{
+  MockQueue<std::uint32_t, 4UL> queue;
+
+  for (std::uint32_t i = 1U; i <= 4U; i++)
+  {
+    assert(queue.push(i) == 0);
+  }
+
+  assert(queue.push(5U) == (-1));
+
+  std::uint64_t dropped = 0UL;
+
+  assert(queue.dropped(dropped) == 0 && dropped == 0UL);
+}
+
 int main(void)
 {
   test_queue_init();
@@ -137,6 +201,9 @@ int main(void)
   test_queue_size();
   test_queue_peek();
   test_queue_pop();
+  test_queue_drop_newest();
+  test_queue_drop_oldest();
+  test_queue_reject_does_not_count();
 
   return EXIT_SUCCESS;
 }
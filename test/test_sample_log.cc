@@ -0,0 +1,196 @@
+#include "sample_log.hpp"
+#include "segment.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::string kPath = "test_sample_log.tmp";
+
+  void remove_segments(void) noexcept
+  {
+    for (std::uint32_t i = 0U; i < 64U; i++)
+    {
+      (void)std::remove(SegmentWriter::segment_path(kPath, i).c_str());
+    }
+  }
+} // namespace
+
+void test_sample_log_round_trip(void)
+{
+  remove_segments();
+
+  {
+    SampleLogWriter writer(kPath);
+
+    assert(writer.is_open());
+
+    const std::uint32_t a[] = {0U, 1U, 2U};
+    const std::uint32_t b[] = {0U, 1U};
+
+    writer.define(0U, "main");
+    writer.define(1U, "mid");
+    writer.define(2U, "leaf");
+    writer.sample(1000UL, 3UL, a, 3UL);
+    writer.sample(5000UL, 1UL, b, 2UL);
+
+    assert(writer.get_samples() == 4UL);
+  }
+
+  SampleLogReader reader(kPath);
+  Sample sample;
+
+  assert(reader.next(sample));
+  assert(sample.timestamp_ns == 1000UL && sample.count == 3UL);
+  assert((sample.stack == std::vector<std::uint32_t>{0U, 1U, 2U}));
+  assert(reader.name(2U) == "leaf");
+
+  assert(reader.next(sample));
+  assert(sample.timestamp_ns == 5000UL && sample.count == 1UL);
+  assert((sample.stack == std::vector<std::uint32_t>{0U, 1U}));
+
+  assert(!reader.next(sample));
+  assert(!reader.is_corrupt());
+
+  remove_segments();
+}
+
+void test_sample_log_rolls_segments(void)
+{
+  remove_segments();
+
+  std::vector<std::uint32_t> stack(16UL);
+
+  {
+    // 256-byte segments hold only a handful of records each.
+    SampleLogWriter writer(kPath, 256UL);
+
+    writer.define(0U, "root");
+
+    for (std::uint64_t i = 0UL; i < 200UL; i++)
+    {
+      for (std::size_t d = 0UL; d < stack.size(); d++)
+      {
+        stack[d] = static_cast<std::uint32_t>((i + d) % 300UL);
+      }
+
+      writer.sample(i * 25000000UL, 1UL, stack.data(), stack.size());
+    }
+
+    assert(writer.get_segments() > 10U);
+    assert(writer.get_failed()   == 0UL);
+  }
+
+  SampleLogReader reader(kPath);
+  Sample sample;
+  std::uint64_t n = 0UL;
+
+  while (reader.next(sample))
+  {
+    assert(sample.timestamp_ns == n * 25000000UL);
+    assert(sample.stack.size() == 16UL);
+    assert(sample.stack[15] == static_cast<std::uint32_t>((n + 15UL) % 300UL));
+    ++n;
+  }
+
+  assert(n == 200UL);
+  assert(!reader.is_corrupt());
+  assert(reader.name(0U) == "root");
+
+  remove_segments();
+}
+
+void test_sample_log_strided_readers(void)
+{
+  remove_segments();
+
+  const std::uint32_t deep[]    = {0U, 1U, 2U, 3U};
+  const std::uint32_t shallow[] = {0U, 1U, 4U};
+
+  {
+    SampleLogWriter writer(kPath, 256UL);
+
+    for (std::uint64_t i = 0UL; i < 300UL; i++)
+    {
+      if ((i % 3UL) == 0UL)
+      {
+        writer.sample(i, 1UL, shallow, 3UL);
+      }
+      else
+      {
+        writer.sample(i, 1UL, deep, 4UL);
+      }
+    }
+
+    assert(writer.get_segments() > 4U);
+  }
+
+  // Two readers taking alternate segments see every sample exactly once.
+  std::uint64_t n        = 0UL;
+  std::uint32_t segments = 0U;
+
+  for (std::uint32_t first = 0U; first < 2U; first++)
+  {
+    SampleLogReader reader(kPath, first, 2U);
+    Sample sample;
+    std::uint64_t previous = 0UL;
+    bool          started  = false;
+
+    while (reader.next(sample))
+    {
+      const bool is_shallow = ((sample.timestamp_ns % 3UL) == 0UL);
+
+      assert(sample.stack.size() == (is_shallow ? 3UL : 4UL));
+      assert(sample.shared <= sample.stack.size());
+
+      // Consecutive deep samples share the whole stack; any switch keeps {0, 1}.
+      if (started && sample.timestamp_ns == previous + 1UL)
+      {
+        assert(sample.shared == ((!is_shallow && (previous % 3UL) != 0UL) ? 4UL : 2UL));
+      }
+
+      previous = sample.timestamp_ns;
+      started  = true;
+      ++n;
+    }
+
+    assert(!reader.is_corrupt());
+    segments += reader.get_segments();
+  }
+
+  SampleLogReader all(kPath);
+  Sample sample;
+
+  while (all.next(sample)) {}
+
+  assert(n == 300UL);
+  assert(segments == all.get_segments());
+
+  remove_segments();
+}
+
+void test_sample_log_missing(void)
+{
+  remove_segments();
+
+  SampleLogReader reader(kPath);
+  Sample sample;
+
+  assert(!reader.next(sample));
+  assert(!reader.is_corrupt());
+}
+
+int main(void)
+{
+  test_sample_log_round_trip();
+  test_sample_log_rolls_segments();
+  test_sample_log_strided_readers();
+  test_sample_log_missing();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "line_location.hpp"
+#include "sample_profile.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::string kPath = "test_sample_profile.tmp";
+
+  std::string read_file(const std::string& path) noexcept
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  }
+
+  LineLocation at(const std::uint32_t offset, const std::uint32_t discriminator = 0U) noexcept
+  {
+    LineLocation location;
+    location.offset        = offset;
+    location.discriminator = discriminator;
+    return location;
+  }
+} // namespace
+
+void test_sample_profile_text(void)
+{
+  SampleProfile profile;
+
+  const std::uint32_t a[]       = {0U, 1U};
+  const LineLocation  a_lines[] = {at(3U), at(5U)};
+  const std::uint32_t b[]       = {0U, 1U, 2U};
+  const LineLocation  b_lines[] = {at(3U), at(7U, 2U), at(1U)};
+  const LineLocation  c_lines[] = {at(4U), LineLocation{}};
+  const std::uint32_t d[]       = {0U, 3U};
+  const LineLocation  d_lines[] = {at(4U), at(0U)};
+
+  profile.add(0U, a, a_lines, 2UL, 4UL);
+  profile.add(0U, b, b_lines, 3UL, 2UL);  // work still running: no new entry
+  profile.add(0U, a, c_lines, 2UL, 1UL);  // called again from another line
+  profile.add(0U, d, d_lines, 2UL, 1UL);
+
+  assert(profile.get_functions() == 4UL);
+  assert(profile.get_samples() == 8UL);
+  assert(profile.write(kPath, {"main", "work", "leaf", "operator new"}) == SampleProfile::kOk);
+
+  // Hottest first; the callee with a space in its name is no call target.
+  const std::string expected =
+    "main:8:1\n"
+    " 3: 6 work:6\n"
+    " 4: 2 work:1\n"
+    "work:7:2\n"
+    " 5: 4\n"
+    " 7.2: 2 leaf:2\n"
+    "leaf:2:1\n"
+    " 1: 2\n"
+    "operator new:1:1\n"
+    " 0: 1\n";
+
+  assert(read_file(kPath) == expected);
+
+  (void)std::remove(kPath.c_str());
+
+  assert(profile.write("no/such/directory/file", {}) == SampleProfile::kIoError);
+}
+
+void test_sample_profile_writer(void)
+{
+  SampleProfileWriter writer(kPath);
+
+  const std::uint32_t stack[] = {0U, 1U};
+  const LineLocation  lines[] = {at(2U), at(0U)};
+
+  writer.define(0U, "main");
+  writer.define(1U, "spin");
+  writer.sample(0U, 3UL, stack, lines, 2UL);
+  writer.sample(0U, 3UL, stack, lines, 2UL);
+  writer.flush();
+
+  assert(!writer.is_failed());
+  assert(writer.get_functions() == 2UL && writer.get_samples() == 6UL);
+  assert(read_file(kPath) == "main:6:1\n 2: 6 spin:6\nspin:6:1\n 0: 6\n");
+
+  (void)std::remove(kPath.c_str());
+}
+
+void test_sample_profile_threads(void)
+{
+  SampleProfile profile;
+
+  const std::uint32_t a[]       = {0U, 1U};
+  const std::uint32_t b[]       = {0U, 2U};
+  const LineLocation  a_lines[] = {at(1U), at(0U)};
+  const LineLocation  b_lines[] = {at(2U), at(0U)};
+
+  // Two threads each stay in one call while their samples interleave:
+  // every function is entered once per thread, not at every switch.
+  for (int i = 0; i < 3; i++)
+  {
+    profile.add(0U, a, a_lines, 2UL, 1UL);
+    profile.add(1U, b, b_lines, 2UL, 1UL);
+  }
+
+  assert(profile.write(kPath, {"run", "left", "right"}) == SampleProfile::kOk);
+  assert(read_file(kPath) == "run:6:2\n 1: 3 left:3\n 2: 3 right:3\nleft:3:1\n 0: 3\nright:3:1\n 0: 3\n");
+
+  (void)std::remove(kPath.c_str());
+}
+
+int main(void)
+{
+  test_sample_profile_text();
+  test_sample_profile_writer();
+  test_sample_profile_threads();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+#include "clock.hpp"
+#include "frame.hpp"
+#include "queue.hpp"
+#include "sample_mode.hpp"
+#include "scan.hpp"
+#include "threads.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  struct Seen final
+  {
+    std::vector<std::uint64_t> samples;  // by thread index
+    std::vector<std::uint64_t> off_cpu;  // samples tagged off-CPU
+    std::vector<std::uint64_t> off_cpu_ticks;
+    std::vector<std::string>   names;
+  };
+
+  void drain(Scanner& scanner, Seen& seen) noexcept
+  {
+    auto& buffer = *scanner.get_frame_buffer();
+    Frame frame;
+
+    while (buffer.pop(frame) == Queue<Frame, 64UL>::kOk)
+    {
+      if (frame.thread >= seen.samples.size())
+      {
+        seen.samples.resize(static_cast<std::size_t>(frame.thread) + 1UL, 0UL);
+        seen.off_cpu.resize(static_cast<std::size_t>(frame.thread) + 1UL, 0UL);
+        seen.off_cpu_ticks.resize(static_cast<std::size_t>(frame.thread) + 1UL, 0UL);
+        seen.names.resize(static_cast<std::size_t>(frame.thread) + 1UL);
+      }
+
+      seen.samples[frame.thread] += frame.count;
+
+      if (frame.off_cpu)
+      {
+        seen.off_cpu[frame.thread]       += frame.count;
+        seen.off_cpu_ticks[frame.thread] += frame.off_cpu_ticks;
+      }
+
+      if (!frame.thread_name.empty())
+      {
+        // A thread's name rides on its first run only.
+        assert(seen.names[frame.thread].empty());
+        seen.names[frame.thread] = frame.thread_name;
+      }
+    }
+  }
+
+  std::size_t index_of(const Seen& seen, const std::string& name) noexcept
+  {
+    for (std::size_t i = 0UL; i < seen.names.size(); i++)
+    {
+      if (seen.names[i] == name)
+      {
+        return i;
+      }
+    }
+
+    return seen.names.size();
+  }
+
+  void spin(const std::atomic<int>& phase, const int until) noexcept
+  {
+    while (phase.load() < until)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Samples every thread while the target spins and a worker it started
+   * stays blocked, pausing a millisecond between scans so the target gets
+   * the CPU. Returns what arrived; worker_name is the worker's.
+   */
+  Seen sample_busy_and_blocked(const SampleMode mode, const std::size_t scans, std::string& worker_name) noexcept
+  {
+    std::atomic<int>            phase{0};
+    std::promise<std::uint32_t> worker_id;
+    std::promise<void>          finished;
+
+    Scanner scanner([&phase, &worker_id, &finished]() noexcept
+    {
+      std::promise<void> release;
+
+      std::thread worker([&worker_id, done = release.get_future()]() noexcept
+      {
+        worker_id.set_value(pace::current_thread_id());
+        done.wait();
+      });
+
+      spin(phase, 1);
+      release.set_value();
+      worker.join();
+      finished.set_value();
+    });
+
+    scanner.set_all_threads(true);
+    scanner.set_sample_mode(mode);
+
+    worker_name = "thread " + std::to_string(worker_id.get_future().get());
+
+    Seen seen;
+
+    for (std::size_t i = 0UL; i < scans; i++)
+    {
+      assert(!scanner.scan());
+      drain(scanner, seen);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Wind down, pausing between scans so the target gets the CPU to
+    // return rather than being sampled while it waits for it.
+    phase.store(1);
+    finished.get_future().wait();
+
+    while (!scanner.scan())
+    {
+      drain(scanner, seen);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    drain(scanner, seen);
+
+    return seen;
+  }
+} // namespace
+
+void test_scan_all_threads(void)
+{
+  constexpr std::size_t kScans = 256UL;
+
+  Clock::get_instance().start();
+
+  // 0: the worker runs, 1: the target joins it, 2: the target returns.
+  std::atomic<int>            phase{0};
+  std::promise<std::uint32_t> worker_id;
+  std::promise<void>          joined;
+
+  Scanner scanner([&phase, &worker_id, &joined]() noexcept
+  {
+    std::thread worker([&phase, &worker_id]() noexcept
+    {
+      worker_id.set_value(pace::current_thread_id());
+      spin(phase, 1);
+    });
+
+    spin(phase, 1);
+    worker.join();
+    joined.set_value();
+    spin(phase, 2);
+  });
+
+  scanner.set_all_threads(true);
+
+  const std::string worker_name = "thread " + std::to_string(worker_id.get_future().get());
+
+  Seen          seen;
+  std::uint64_t scans = 0UL;
+
+  for (; scans < kScans; scans++)
+  {
+    assert(!scanner.scan());
+    drain(scanner, seen);
+  }
+
+  // Round-robin: one thread per scan, and the target among them.
+  const std::size_t threads = scanner.get_threads();
+
+  assert(threads >= 2UL);
+
+  // Scans back to back can starve the worker on a single CPU: let it exit.
+  phase.store(1);
+  joined.get_future().wait();
+
+  // The worker is gone by the next refresh; its pending run is flushed
+  // then, not held until the target returns.
+  for (; scans < 3UL * kScans; scans++)
+  {
+    assert(!scanner.scan());
+    drain(scanner, seen);
+  }
+
+  const std::size_t index = index_of(seen, worker_name);
+
+  assert(index > 0UL && index < seen.samples.size());
+  assert(seen.samples[index] >= kScans / threads / 2UL);
+
+  phase.store(2);
+
+  for (bool done = false; !done; scans++)
+  {
+    done = scanner.scan();
+    drain(scanner, seen);
+  }
+
+  std::uint64_t total = 0UL;
+
+  for (const std::uint64_t samples : seen.samples)
+  {
+    total += samples;
+  }
+
+  // Every run arrived, and no scan sampled more than one thread.
+  assert(seen.names[0] == "target" && seen.samples[0] > 0UL);
+  assert(total <= scans);
+}
+
+void test_scan_wall_tags(void)
+{
+  constexpr std::size_t kScans = 64UL;
+
+  std::string worker_name;
+
+  const Seen        seen   = sample_busy_and_blocked(SampleMode::WALL, kScans, worker_name);
+  const std::size_t worker = index_of(seen, worker_name);
+
+  // Every sample is taken. The worker's are all off-CPU, its first one
+  // included, and carry the time waited; the spinning target's stay on-CPU.
+  assert(worker < seen.samples.size() && seen.samples[worker] > 1UL);
+  assert(seen.off_cpu[worker] == seen.samples[worker]);
+  assert(seen.off_cpu_ticks[worker] > 0UL);
+
+  assert(seen.samples[0] > 1UL);
+  assert(seen.off_cpu[0] * 4UL <= seen.samples[0]);
+}
+
+void test_scan_cpu_mode(void)
+{
+  constexpr std::size_t kScans = 64UL;
+
+  std::string worker_name;
+
+  const Seen        seen   = sample_busy_and_blocked(SampleMode::CPU, kScans, worker_name);
+  const std::size_t worker = index_of(seen, worker_name);
+
+  // The blocked worker earns nothing, not even on its first check; the
+  // spinning target earns about a sample per check.
+  assert(worker >= seen.samples.size() || seen.samples[worker] == 0UL);
+  assert(seen.samples[0] > 1UL);
+
+  for (const std::uint64_t off_cpu : seen.off_cpu)
+  {
+    assert(off_cpu == 0UL);
+  }
+}
+
+int main(void)
+{
+  test_scan_all_threads();
+  test_scan_wall_tags();
+  test_scan_cpu_mode();
+
+  return EXIT_SUCCESS;
+}
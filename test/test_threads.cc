@@ -0,0 +1,79 @@
+#include "threads.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+  #include <pthread.h>
+#endif
+
+namespace
+{
+  const pace::ThreadInfo* find(const std::vector<pace::ThreadInfo>& threads, const std::uint32_t id) noexcept
+  {
+    const auto it = std::find_if(threads.begin(), threads.end(), [id](const pace::ThreadInfo& info) noexcept
+    {
+      return info.id == id;
+    });
+
+    return (it != threads.end()) ? &*it : nullptr;
+  }
+} // namespace
+
+void test_list_threads(void)
+{
+  std::promise<std::uint32_t> started;
+  std::atomic<bool>           stop{false};
+
+  std::thread worker([&started, &stop]() noexcept
+  {
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+    (void)::pthread_setname_np(::pthread_self(), "pace-worker");
+#endif
+
+    started.set_value(pace::current_thread_id());
+
+    while (!stop.load())
+    {
+      std::this_thread::yield();
+    }
+  });
+
+  const std::uint32_t worker_id = started.get_future().get();
+  const std::uint32_t self_id   = pace::current_thread_id();
+
+  const std::vector<pace::ThreadInfo> threads = pace::list_threads();
+
+  stop.store(true);
+  worker.join();
+
+  assert(worker_id != self_id);
+  assert(find(threads, self_id) != nullptr);
+  assert(find(threads, worker_id) != nullptr);
+
+  // Each thread once.
+  for (const pace::ThreadInfo& info : threads)
+  {
+    assert(find(threads, info.id) == &info);
+  }
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+  assert(find(threads, worker_id)->name == "pace-worker");
+
+  // A joined thread's task is reaped with it.
+  assert(find(pace::list_threads(), worker_id) == nullptr);
+#endif
+}
+
+int main(void)
+{
+  test_list_threads();
+
+  return EXIT_SUCCESS;
+}
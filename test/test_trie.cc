@@ -1,5 +1,6 @@
 #include "trie.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <memory>
@@ -152,6 +153,48 @@ void test_trie_bucket_stress_promote(void)
   assert(trie.has_prefix("b") == false);
 }
 
+void test_trie_build(void)
+{
+  MockTrie<8UL> trie;
+
+  std::vector<std::string> keys;
+
+  for (std::uint64_t i = 0UL; i < 64UL; i++)
+  {
+    keys.push_back("a" + std::to_string(static_cast<unsigned long long>(i)));
+  }
+
+  keys.push_back("a");
+  keys.push_back("a1");  // duplicate
+  keys.push_back("b");
+
+  std::sort(keys.begin(), keys.end());
+
+  trie.build(keys);
+
+  const auto root = trie.get_root();
+
+  assert(root               != nullptr);
+  assert(root->is_bucket()  == false  );
+
+  for (const auto& key : keys)
+  {
+    assert(trie.contains(key) == true);
+  }
+
+  assert(trie.contains("a64") == false);
+  assert(trie.contains("c")   == false);
+
+  assert(trie.has_prefix("a6") == true);
+  assert(trie.has_prefix("ab") == false);
+
+  // Bulk-loaded buckets still accept regular inserts.
+  trie.insert("a7x");
+
+  assert(trie.contains("a7x") == true);
+  assert(trie.contains("a7")  == true);
+}
+
 int main(void)
 {
   test_trie_root();
@@ -159,6 +202,7 @@ int main(void)
   test_trie_has_prefix();
   test_trie_clear();
   test_trie_bucket_stress_promote();
+  test_trie_build();
 
   return EXIT_SUCCESS;
 }